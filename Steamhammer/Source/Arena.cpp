@@ -0,0 +1,59 @@
+#include "Arena.h"
+
+#include <algorithm>
+
+using namespace UAlbertaBot;
+
+// Big enough for the records and snapshots of a few games.
+const size_t BlockSize = 64 * 1024;
+
+Arena::Arena()
+	: bytesUsed(0)
+{
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+void * Arena::allocate(size_t bytes, size_t alignment)
+{
+	if (!blocks.empty())
+	{
+		Block & block = blocks.back();
+		const size_t start = (block.used + alignment - 1) & ~(alignment - 1);
+		if (start + bytes <= block.size)
+		{
+			block.used = start + bytes;
+			bytesUsed += bytes;
+			return block.data + start;
+		}
+	}
+
+	// Start a new block. An allocation too big for a normal block gets a block of its own.
+	// New memory is aligned for any type.
+	Block block;
+	block.size = std::max(BlockSize, bytes);
+	block.data = static_cast<char *>(::operator new(block.size));
+	block.used = bytes;
+	blocks.push_back(block);
+	bytesUsed += bytes;
+	return block.data;
+}
+
+void Arena::release()
+{
+	for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+	{
+		it->destroy(it->object);
+	}
+	destructors.clear();
+
+	for (const Block & block : blocks)
+	{
+		::operator delete(block.data);
+	}
+	blocks.clear();
+	bytesUsed = 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Memory for many small objects with the same lifetime, released all at once.
+
+// Allocation bumps a pointer in the current block, so objects made one after
+// another sit next to each other. Nothing is freed until release(), which runs
+// the destructors of the objects that need it, last made first, and frees the blocks.
+
+namespace UAlbertaBot
+{
+class Arena
+{
+	struct Block
+	{
+		char *		data;
+		size_t		size;
+		size_t		used;
+	};
+
+	struct Destructor
+	{
+		void		(*destroy)(void *);
+		void *		object;
+	};
+
+	std::vector<Block>		blocks;
+	std::vector<Destructor>	destructors;
+	size_t					bytesUsed;
+
+	template <class T>
+	static void destroy(void * object) { static_cast<T *>(object)->~T(); };
+
+	Arena(const Arena &) = delete;
+	Arena & operator=(const Arena &) = delete;
+
+public:
+	Arena();
+	~Arena();
+
+	void *		allocate(size_t bytes, size_t alignment);
+
+	template <class T, class... Args>
+	T * make(Args &&... args)
+	{
+		T * object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			Destructor d;
+			d.destroy = &destroy<T>;
+			d.object = object;
+			destructors.push_back(d);
+		}
+		return object;
+	};
+
+	// An array of n zeroed objects. Only for plain data, which needs no destructor.
+	template <class T>
+	T * makeArray(size_t n)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena arrays are not destroyed");
+		T * array = static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+		for (size_t i = 0; i < n; ++i)
+		{
+			new (array + i) T();
+		}
+		return array;
+	};
+
+	void		release();
+
+	size_t		getBytesUsed() const { return bytesUsed; };
+};
+}
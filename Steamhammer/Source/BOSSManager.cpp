@@ -1,9 +1,81 @@
 #include "Common.h"
 #include "BOSSManager.h"
+#include "Profiler.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
 
+static const std::string BuildOrderCacheFilename = "build_order_cache.txt";
+
+namespace
+{
+	// Conversions between BOSS action types and MacroActs, looked up instead of searched for.
+	struct ActionConversions
+	{
+		std::vector< std::vector<MacroAct> > macroActs;		// [BOSS race][BOSS action id]
+		std::vector<BOSS::ActionType> byUnitType;			// by BWAPI type id; race None if BOSS has no such action
+		std::vector<BOSS::ActionType> byTechType;
+		std::vector<BOSS::ActionType> byUpgradeType;
+	};
+}
+
+static void setAction(std::vector<BOSS::ActionType> & byType, int id, const BOSS::ActionType & action)
+{
+	if (size_t(id) >= byType.size())
+	{
+		byType.resize(id + 1, BOSS::ActionType());
+	}
+	byType[id] = action;
+}
+
+static ActionConversions makeActionConversions()
+{
+	ActionConversions conversions;
+
+	for (BOSS::RaceID race = 0; race < BOSS::Races::NUM_RACES; ++race)
+	{
+		conversions.macroActs.push_back(std::vector<MacroAct>());
+		for (const BOSS::ActionType & action : BOSS::ActionTypes::GetAllActionTypes(race))
+		{
+			MacroAct act;
+			if (action.isUnit())
+			{
+				act = MacroAct(action.getUnitType());
+				setAction(conversions.byUnitType, action.getUnitType().getID(), action);
+			}
+			else if (action.isUpgrade())
+			{
+				act = MacroAct(action.getUpgradeType());
+				setAction(conversions.byUpgradeType, action.getUpgradeType().getID(), action);
+			}
+			else if (action.isTech())
+			{
+				act = MacroAct(action.getTechType());
+				setAction(conversions.byTechType, action.getTechType().getID(), action);
+			}
+			conversions.macroActs.back().push_back(act);
+		}
+	}
+
+	return conversions;
+}
+
+// Made on first use, which comes after BOSS::init() has set up the action types.
+static const ActionConversions & actionConversions()
+{
+	static const ActionConversions conversions = makeActionConversions();
+	return conversions;
+}
+
+static const BOSS::ActionType * findAction(const std::vector<BOSS::ActionType> & byType, int id)
+{
+	if (size_t(id) < byType.size() && byType[id].getRace() != BOSS::Races::None)
+	{
+		return &byType[id];
+	}
+	return nullptr;
+}
+
 BOSSManager & BOSSManager::Instance() 
 {
 	static BOSSManager instance;
@@ -53,6 +125,22 @@ void BOSSManager::startNewSearch(const std::vector<MetaPair> & goalUnits)
 
         BOSS::GameState initialState(BWAPI::Broodwar, BWAPI::Broodwar->self(), BuildingManager::Instance().buildingsQueued());
 
+        // If we've solved this goal before from a similar state, reuse the solution.
+        if (!_buildOrderCache.isLoaded() && Config::IO::UseBuildOrderCacheFile)
+        {
+            _buildOrderCache.read(Config::IO::ReadDir + BuildOrderCacheFilename);
+        }
+        _searchKey = BuildOrderCache::Key(initialState, goal);
+        if (_buildOrderCache.find(_searchKey, initialState, goal, _previousBuildOrder))
+        {
+            _previousStatus = std::string("\x07") + "BOSS Cached Solution\n";
+            _previousSearchStartFrame = BWAPI::Broodwar->getFrameCount();
+            _previousSearchFinishFrame = BWAPI::Broodwar->getFrameCount();
+            _totalPreviousSearchTime = 0;
+            _previousGoalUnits = goalUnits;
+            return;
+        }
+
         _smartSearch = SearchPtr(new BOSS::DFBB_BuildOrderSmartSearch(initialState.getRace()));
         _smartSearch->setGoal(GetGoal(goalUnits));
         _smartSearch->setState(initialState);
@@ -80,7 +168,7 @@ void BOSSManager::drawSearchInformation(int x, int y)
 
     // draw the background
     int width = 155;
-    int height = 80;
+    int height = 90;
     BWAPI::Broodwar->drawBoxScreen(BWAPI::Position(x-5,y), BWAPI::Position(x+width, y+height), BWAPI::Colors::Black, true);
 
     x += 5; y+=3;
@@ -101,6 +189,7 @@ void BOSSManager::drawSearchInformation(int x, int y)
     BWAPI::Broodwar->drawTextScreen(BWAPI::Position(x, y+25), "Time (ms): %.3lf", _totalPreviousSearchTime);
     BWAPI::Broodwar->drawTextScreen(BWAPI::Position(x, y+35), "Nodes: %d", _savedSearchResults.nodesExpanded);
     BWAPI::Broodwar->drawTextScreen(BWAPI::Position(x, y+45), "BO Size: %d", (int)_savedSearchResults.buildOrder.size());
+    BWAPI::Broodwar->drawTextScreen(BWAPI::Position(x, y+55), "Cache: %d hit %d miss", _buildOrderCache.getHits(), _buildOrderCache.getMisses());
 }
 
 void BOSSManager::drawStateInformation(int x, int y) 
@@ -133,6 +222,7 @@ void BOSSManager::update(double timeLimit)
         {
             // call the search to continue searching
             // this will resume a search in progress or start a new search if not yet started
+			ProfileScope profile("BOSS search");
 			_smartSearch->search();
 		}
 		catch (const BOSS::BOSSException &)
@@ -179,6 +269,11 @@ void BOSSManager::update(double timeLimit)
             _savedSearchResults = _previousSearchResults;
             _previousBuildOrder = _previousSearchResults.buildOrder;
 
+            if (solved)
+            {
+                _buildOrderCache.store(_searchKey, _smartSearch->getParameters().initialState, _previousBuildOrder);
+            }
+
             if (solved && _previousBuildOrder.size() == 0)
             {
                 _previousStatus = std::string("\x07") + "BOSS Trivial Solve\n";
@@ -235,6 +330,15 @@ void BOSSManager::update(double timeLimit)
     }
 }
 
+// Called at the end of the game.
+void BOSSManager::writeBuildOrderCache()
+{
+    if (Config::IO::UseBuildOrderCacheFile && _buildOrderCache.isModified())
+    {
+        _buildOrderCache.write(Config::IO::WriteDir + BuildOrderCacheFilename);
+    }
+}
+
 void BOSSManager::logBadSearch()
 {
     std::string s = _smartSearch->getParameters().toString();
@@ -294,6 +398,7 @@ bool BOSSManager::isSearchInProgress()
 std::vector<MacroAct> BOSSManager::GetMetaVector(const BOSS::BuildOrder & buildOrder)
 {
 	std::vector<MacroAct> metaVector;
+	metaVector.reserve(buildOrder.size());
     	
 	for (size_t i(0); i<buildOrder.size(); ++i)
 	{
@@ -309,8 +414,29 @@ BuildOrder BOSSManager::getBuildOrder()
     return BuildOrder(BWAPI::Broodwar->self()->getRace(), GetMetaVector(_previousBuildOrder));
 }
 
+// Types that BOSS doesn't know are not in the tables. For them, ask BOSS,
+// which throws BOSSException just as it always has.
 BOSS::ActionType BOSSManager::GetActionType(const MacroAct & t)
 {
+	const ActionConversions & conversions = actionConversions();
+	const BOSS::ActionType * action = nullptr;
+	if (t.isUnit())
+	{
+		action = findAction(conversions.byUnitType, t.getUnitType().getID());
+	}
+	else if (t.isUpgrade())
+	{
+		action = findAction(conversions.byUpgradeType, t.getUpgradeType().getID());
+	}
+	else if (t.isTech())
+	{
+		action = findAction(conversions.byTechType, t.getTechType().getID());
+	}
+	if (action)
+	{
+		return *action;
+	}
+
 	// set the appropriate type
 	if (t.isUnit())
 	{
@@ -334,6 +460,12 @@ BOSS::ActionType BOSSManager::GetActionType(const MacroAct & t)
 
 MacroAct BOSSManager::GetMacroAct(const BOSS::ActionType & a)
 {
+	const ActionConversions & conversions = actionConversions();
+	if (a.getRace() < conversions.macroActs.size() && a.ID() < conversions.macroActs[a.getRace()].size())
+	{
+		return conversions.macroActs[a.getRace()][a.ID()];
+	}
+
 	// set the appropriate type
 	if (a.isUnit())
 	{
@@ -3,6 +3,7 @@
 #include "Common.h"
 #include "WorkerManager.h"
 #include "../../BOSS/source/BOSS.h"
+#include "BuildOrderCache.h"
 #include "StrategyManager.h"
 #include <memory>
 
@@ -27,6 +28,9 @@ class BOSSManager
     BOSS::DFBB_BuildOrderSearchResults      _savedSearchResults;
     BOSS::BuildOrder                        _previousBuildOrder;
 
+    BuildOrderCache                         _buildOrderCache;
+    std::string                             _searchKey;         // cache key of the search in progress
+
 	BOSS::GameState				            getCurrentState();
 	BOSS::GameState				            getStartState();
 	
@@ -53,6 +57,7 @@ public:
     bool                        isSearchInProgress();
 
     void                        startNewSearch(const std::vector<MetaPair> & goalUnits);
+    void                        writeBuildOrderCache();
     
 	void						drawSearchInformation(int x, int y);
     void						drawStateInformation(int x, int y);
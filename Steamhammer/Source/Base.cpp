@@ -1,6 +1,8 @@
 #include "Common.h"
 #include "Base.h"
 
+#include "GridDistances.h"
+
 using namespace UAlbertaBot;
 
 // For setting base.id on initialization.
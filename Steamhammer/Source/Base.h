@@ -1,6 +1,6 @@
 #pragma once
 
-#include "GridDistances.h"
+#include "CompactDistances.h"
 
 namespace UAlbertaBot
 {
@@ -18,7 +18,7 @@ private:
 	BWAPI::Unitset		minerals;			// the associated mineral patches
 	BWAPI::Unitset		geysers;			// the base's associated geysers
 	BWAPI::Unitset		blockers;			// destructible neutral units that may be in the way
-	GridDistances		distances;			// ground distances from tilePosition
+	CompactDistances	distances;			// ground distances from tilePosition
 
 	bool				reserved;			// if this is a planned expansion
 
@@ -43,6 +43,7 @@ public:
 
 	int getTileDistance(const BWAPI::Position & pos) const { return distances.at(pos); };
 	int getTileDistance(const BWAPI::TilePosition & pos) const { return distances.at(pos); };
+	int getDistanceMemoryBytes() const { return distances.getMemoryBytes(); };
 
 	void setOwner(BWAPI::Unit depot, BWAPI::Player player);
 
@@ -455,6 +455,15 @@ void Bases::drawBaseOwnership(int x, int y) const
 		BWAPI::Broodwar->drawTextScreen(x - 8, yy, "%c%c", white, reservedChar);
 		BWAPI::Broodwar->drawTextScreen(x, yy, "%c%d, %d%c%c", color, pos.x, pos.y, inferredChar, baseCode);
 	}
+
+	// Memory used by the bases' distance maps.
+	int bytes = 0;
+	for (const Base * base : bases)
+	{
+		bytes += base->getDistanceMemoryBytes();
+	}
+	yy += 14;
+	BWAPI::Broodwar->drawTextScreen(x, yy, "%cdistances %dKB", gray, bytes / 1024);
 }
 
 // Our "frontmost" base, the base which we most want to defend from ground attack.
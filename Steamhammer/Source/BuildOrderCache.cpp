@@ -0,0 +1,192 @@
+#include "BuildOrderCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace UAlbertaBot;
+
+static const std::string FileHeader = "Steamhammer build order cache 1";
+
+BuildOrderCache::BuildOrderCache()
+	: loaded(false)
+	, modified(false)
+	, hits(0)
+	, misses(0)
+{
+}
+
+std::string BuildOrderCache::Key(const BOSS::GameState & state, const BOSS::BuildOrderSearchGoal & goal)
+{
+	std::ostringstream key;
+
+	key << int(state.getRace());
+	for (const BOSS::ActionType & action : BOSS::ActionTypes::GetAllActionTypes(state.getRace()))
+	{
+		const int have = state.getUnitData().getNumTotal(action);
+		const int want = goal.getGoal(action);
+		const int wantMax = goal.getGoalMax(action);
+		if (have || want || wantMax)
+		{
+			key << ' ' << int(action.ID()) << ':' << have << ':' << want << ':' << wantMax;
+		}
+	}
+	// BOSS counts resources in thousandths.
+	const int step = 100 * int(BOSS::Constants::RESOURCE_SCALE);
+	key << " m" << int(state.getMinerals()) / step << " g" << int(state.getGas()) / step;
+
+	return key.str();
+}
+
+// A hit is checked by playing the build order out from the current state:
+// Every action must be legal, as in BOSS::BuildOrder::isLegalFromState(), and at the end the goal must be met.
+bool BuildOrderCache::find(const std::string & key, const BOSS::GameState & state, BOSS::BuildOrderSearchGoal goal, BOSS::BuildOrder & buildOrder)
+{
+	auto it = entries.find(key);
+	if (it == entries.end())
+	{
+		++misses;
+		return false;
+	}
+
+	try
+	{
+		BOSS::GameState after(state);
+		if (!it->second.buildOrder.doActions(after) || !goal.isAchievedBy(after))
+		{
+			++misses;
+			return false;
+		}
+	}
+	catch (const BOSS::BOSSException &)
+	{
+		++misses;
+		return false;
+	}
+
+	++hits;
+	it->second.usedThisGame = true;
+	buildOrder = it->second.buildOrder;
+	return true;
+}
+
+void BuildOrderCache::store(const std::string & key, const BOSS::GameState & state, const BOSS::BuildOrder & buildOrder)
+{
+	if (buildOrder.size() == 0)
+	{
+		return;
+	}
+
+	int finishFrames;
+	try
+	{
+		finishFrames = int(buildOrder.getCompletionTime(state)) - int(state.getCurrentFrame());
+	}
+	catch (const BOSS::BOSSException &)
+	{
+		return;
+	}
+
+	auto it = entries.find(key);
+	if (it != entries.end() && it->second.finishFrames <= finishFrames)
+	{
+		it->second.usedThisGame = true;
+		return;
+	}
+
+	Entry & entry = entries[key];
+	entry.buildOrder = buildOrder;
+	entry.finishFrames = finishFrames;
+	entry.usedThisGame = true;
+	modified = true;
+}
+
+// A missing or unreadable file leaves the cache empty.
+void BuildOrderCache::read(const std::string & filename)
+{
+	loaded = true;
+
+	std::ifstream file(filename);
+	std::string line;
+	if (!std::getline(file, line) || line != FileHeader)
+	{
+		return;
+	}
+
+	while (std::getline(file, line))
+	{
+		const size_t tab1 = line.find('\t');
+		const size_t tab2 = tab1 == std::string::npos ? std::string::npos : line.find('\t', tab1 + 1);
+		if (tab2 == std::string::npos)
+		{
+			continue;
+		}
+
+		const std::string key = line.substr(0, tab1);
+		std::istringstream rest(line.substr(tab1 + 1));
+		int race = -1;
+		std::istringstream(key) >> race;
+		if (race < 0 || race >= BOSS::Races::NUM_RACES)
+		{
+			continue;
+		}
+		const size_t nActions = BOSS::ActionTypes::GetAllActionTypes(BOSS::RaceID(race)).size();
+
+		Entry entry;
+		entry.usedThisGame = false;
+		rest >> entry.finishFrames;
+		int id;
+		bool good = bool(rest);
+		while (good && rest >> id)
+		{
+			if (id < 0 || size_t(id) >= nActions)
+			{
+				good = false;
+				break;
+			}
+			entry.buildOrder.add(BOSS::ActionTypes::GetActionType(BOSS::RaceID(race), BOSS::ActionID(id)));
+		}
+
+		if (good && entry.buildOrder.size() > 0)
+		{
+			entries[key] = entry;
+		}
+	}
+}
+
+// Keep the entries used this game first, and otherwise the ones that finish soonest.
+void BuildOrderCache::write(const std::string & filename) const
+{
+	std::vector<const std::pair<const std::string, Entry> *> kept;
+	kept.reserve(entries.size());
+	for (const auto & keyEntry : entries)
+	{
+		kept.push_back(&keyEntry);
+	}
+	if (kept.size() > MaxEntries)
+	{
+		std::nth_element(kept.begin(), kept.begin() + MaxEntries, kept.end(),
+			[](const std::pair<const std::string, Entry> * a, const std::pair<const std::string, Entry> * b)
+		{
+			if (a->second.usedThisGame != b->second.usedThisGame)
+			{
+				return a->second.usedThisGame;
+			}
+			return a->second.finishFrames < b->second.finishFrames;
+		});
+		kept.resize(MaxEntries);
+	}
+
+	std::ofstream file(filename, std::ios::trunc);
+	file << FileHeader << '\n';
+	for (const auto * keyEntry : kept)
+	{
+		const Entry & entry = keyEntry->second;
+		file << keyEntry->first << '\t' << entry.finishFrames << '\t';
+		for (size_t i = 0; i < entry.buildOrder.size(); ++i)
+		{
+			file << (i ? " " : "") << int(entry.buildOrder[i].ID());
+		}
+		file << '\n';
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "../../BOSS/source/BOSS.h"
+
+// Remember the build orders that BOSS has solved, and reuse them for the same goal
+// from a similar state, in this game and later games.
+
+// The key is the goal plus a coarse digest of the state: the count of each unit type,
+// tech and upgrade, completed or in progress, and the minerals and gas in steps of 100.
+// States with the same key are not the same, so a cached build order is used only if
+// it is legal from the current state and still achieves the goal.
+
+// The file is text, one build order per line:
+//   key <tab> frames to finish <tab> BOSS action ids
+// Action ids depend on the BOSS data. An id that is out of range drops its line.
+
+namespace UAlbertaBot
+{
+class BuildOrderCache
+{
+	static const size_t MaxEntries = 2000;		// the file keeps at most this many
+
+	struct Entry
+	{
+		BOSS::BuildOrder	buildOrder;
+		int					finishFrames;		// frames from the start state to the end of the build order
+		bool				usedThisGame;
+	};
+
+	std::unordered_map<std::string, Entry>	entries;
+	bool									loaded;
+	bool									modified;
+	int										hits;		// lookups this game that found a usable build order
+	int										misses;		// lookups this game that found none, or one that failed the check
+
+public:
+	BuildOrderCache();
+
+	static std::string Key(const BOSS::GameState & state, const BOSS::BuildOrderSearchGoal & goal);
+
+	// True if there is a usable build order for the key, which then goes into buildOrder.
+	bool find(const std::string & key, const BOSS::GameState & state, BOSS::BuildOrderSearchGoal goal, BOSS::BuildOrder & buildOrder);
+
+	// Keep a solved build order, if it is new or finishes sooner than the one we have.
+	void store(const std::string & key, const BOSS::GameState & state, const BOSS::BuildOrder & buildOrder);
+
+	bool isLoaded() const { return loaded; };
+	void read(const std::string & filename);
+	void write(const std::string & filename) const;
+	bool isModified() const { return modified; };
+
+	int getHits() const { return hits; };
+	int getMisses() const { return misses; };
+};
+}
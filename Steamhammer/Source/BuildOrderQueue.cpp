@@ -5,18 +5,161 @@ using namespace UAlbertaBot;
 
 BuildOrderQueue::BuildOrderQueue()
 	: modified(false)
+	, nDone(0)
+	, bottom(0)
+	, fixedMinerals(0)
+	, fixedGas(0)
+	, nGasSteals(0)
 {
 }
 
+static void addPosition(std::deque<int> & positions, int position, bool atTop)
+{
+	if (atTop)
+	{
+		positions.push_back(position);
+	}
+	else
+	{
+		positions.push_front(position);
+	}
+}
+
+// The positions of the queue items of the same type as the act, or null for a command.
+std::deque<int> * BuildOrderQueue::positionsFor(const MacroAct & act)
+{
+	std::vector< std::deque<int> > * byType;
+	int id;
+
+	if (act.isUnit())
+	{
+		byType = &unitPositions;
+		id = act.getUnitType().getID();
+	}
+	else if (act.isTech())
+	{
+		byType = &techPositions;
+		id = act.getTechType().getID();
+	}
+	else if (act.isUpgrade())
+	{
+		byType = &upgradePositions;
+		id = act.getUpgradeType().getID();
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	if (size_t(id) >= byType->size())
+	{
+		byType->resize(id + 1);
+	}
+	return &(*byType)[id];
+}
+
+const std::deque<int> & BuildOrderQueue::positionsOf(const std::vector< std::deque<int> > & byType, int id) const
+{
+	static const std::deque<int> none;
+
+	return size_t(id) < byType.size() ? byType[id] : none;
+}
+
+// The lowest position among the next n + 1 items, the range that anyInNextN() looks at.
+int BuildOrderQueue::nextNPosition(int n) const
+{
+	return bottom + int(queue.size()) - 1 - n;
+}
+
+// The item was just added at the top or the bottom of the queue, at the given position.
+void BuildOrderQueue::addToIndex(const BuildOrderItem & item, int position, bool atTop)
+{
+	const MacroAct & act = item.macroAct;
+
+	std::deque<int> * positions = positionsFor(act);
+	if (positions)
+	{
+		addPosition(*positions, position, atTop);
+	}
+
+	if (act.gasPrice() > 0)
+	{
+		addPosition(gasPositions, position, atTop);
+	}
+
+	if (!act.isUpgrade())
+	{
+		fixedMinerals += act.mineralPrice();
+		fixedGas += act.gasPrice();
+	}
+
+	if (item.isGasSteal)
+	{
+		++nGasSteals;
+	}
+}
+
+// The item at the top of the queue is about to be removed.
+void BuildOrderQueue::removeTopFromIndex(const BuildOrderItem & item)
+{
+	const MacroAct & act = item.macroAct;
+	const int position = bottom + int(queue.size()) - 1;
+
+	std::deque<int> * positions = positionsFor(act);
+	if (positions)
+	{
+		UAB_ASSERT(!positions->empty() && positions->back() == position, "queue index out of step");
+		positions->pop_back();
+	}
+
+	if (!gasPositions.empty() && gasPositions.back() == position)
+	{
+		gasPositions.pop_back();
+	}
+
+	if (!act.isUpgrade())
+	{
+		fixedMinerals -= act.mineralPrice();
+		fixedGas -= act.gasPrice();
+	}
+
+	if (item.isGasSteal)
+	{
+		--nGasSteals;
+	}
+}
+
+// Rebuild the indexes from scratch. The queue changed in the middle, which moves
+// the positions of the items above the change.
+void BuildOrderQueue::reindex()
+{
+	bottom = 0;
+	unitPositions.clear();
+	techPositions.clear();
+	upgradePositions.clear();
+	gasPositions.clear();
+	fixedMinerals = 0;
+	fixedGas = 0;
+	nGasSteals = 0;
+
+	for (size_t i = 0; i < queue.size(); ++i)
+	{
+		addToIndex(queue[i], int(i), true);
+	}
+}
+
 void BuildOrderQueue::clearAll() 
 {
 	queue.clear();
+	reindex();
 	modified = true;
 }
 
 // A special purpose queue modification.
 void BuildOrderQueue::dropStaticDefenses()
 {
+	bool dropped = false;
+
 	for (auto it = queue.begin(); it != queue.end(); )
 	{
 		MacroAct act = (*it).macroAct;
@@ -24,35 +167,47 @@ void BuildOrderQueue::dropStaticDefenses()
 		if (act.isBuilding() &&	UnitUtil::IsComingStaticDefense(act.getUnitType()))
 		{
 			it = queue.erase(it);
+			dropped = true;
 		}
 		else
 		{
 			++it;
 		}
 	}
+
+	if (dropped)
+	{
+		reindex();
+	}
 }
 
 void BuildOrderQueue::queueAsHighestPriority(MacroAct m, bool gasSteal)
 {
 	queue.push_back(BuildOrderItem(m, gasSteal));
+	addToIndex(queue.back(), bottom + int(queue.size()) - 1, true);
 	modified = true;
 }
 
 void BuildOrderQueue::queueAsLowestPriority(MacroAct m) 
 {
 	queue.push_front(BuildOrderItem(m));
+	--bottom;
+	addToIndex(queue.front(), bottom, false);
 	modified = true;
 }
 
 void BuildOrderQueue::removeHighestPriorityItem() 
 {
+	removeTopFromIndex(queue.back());
 	queue.pop_back();
 	modified = true;
 }
 
 void BuildOrderQueue::doneWithHighestPriorityItem()
 {
+	removeTopFromIndex(queue.back());
 	queue.pop_back();
+	++nDone;
 }
 
 void BuildOrderQueue::pullToTop(size_t i)
@@ -63,6 +218,7 @@ void BuildOrderQueue::pullToTop(size_t i)
 
 	BuildOrderItem item = queue[i];								// copy it
 	queue.erase(queue.begin() + i);
+	reindex();
 	queueAsHighestPriority(item.macroAct, item.isGasSteal);		// this sets modified = true
 }
 
@@ -107,13 +263,9 @@ BWAPI::UnitType BuildOrderQueue::getNextUnit() const
 // Look at most n items ahead in the queue.
 int BuildOrderQueue::getNextGasCost(int n) const
 {
-	for (int i = queue.size() - 1; i >= std::max(0, int(queue.size()) - n); --i)
+	if (n > 0 && !gasPositions.empty() && gasPositions.back() >= nextNPosition(n - 1))
 	{
-		int price = queue[i].macroAct.gasPrice();
-		if (price > 0)
-		{
-			return price;
-		}
+		return queue[gasPositions.back() - bottom].macroAct.gasPrice();
 	}
 
 	return 0;
@@ -121,123 +273,66 @@ int BuildOrderQueue::getNextGasCost(int n) const
 
 bool BuildOrderQueue::anyInQueue(BWAPI::UpgradeType type) const
 {
-	for (const auto & item : queue)
-	{
-		if (item.macroAct.isUpgrade() && item.macroAct.getUpgradeType() == type)
-		{
-			return true;
-		}
-	}
-	return false;
+	return !positionsOf(upgradePositions, type.getID()).empty();
 }
 
 bool BuildOrderQueue::anyInQueue(BWAPI::UnitType type) const
 {
-	for (const auto & item : queue)
-	{
-		if (item.macroAct.isUnit() && item.macroAct.getUnitType() == type)
-		{
-			return true;
-		}
-	}
-	return false;
+	return !positionsOf(unitPositions, type.getID()).empty();
 }
 
 // Are there any of these in the next N items in the queue?
 bool BuildOrderQueue::anyInNextN(BWAPI::UnitType type, int n) const
 {
-	for (int i = queue.size() - 1; i >= std::max(0, int(queue.size()) - 1 - n); --i)
-	{
-		const MacroAct & act = queue[i].macroAct;
-		if (act.isUnit() && act.getUnitType() == type)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	const std::deque<int> & positions = positionsOf(unitPositions, type.getID());
+	return !positions.empty() && positions.back() >= nextNPosition(n);
 }
 
 // Are there any of these in the next N items in the queue?
 bool BuildOrderQueue::anyInNextN(BWAPI::UpgradeType type, int n) const
 {
-	for (int i = queue.size() - 1; i >= std::max(0, int(queue.size()) - 1 - n); --i)
-	{
-		const MacroAct & act = queue[i].macroAct;
-		if (act.isUpgrade() && act.getUpgradeType() == type)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	const std::deque<int> & positions = positionsOf(upgradePositions, type.getID());
+	return !positions.empty() && positions.back() >= nextNPosition(n);
 }
 
 // Are there any of these in the next N items in the queue?
 bool BuildOrderQueue::anyInNextN(BWAPI::TechType type, int n) const
 {
-	for (int i = queue.size() - 1; i >= std::max(0, int(queue.size()) - 1 - n); --i)
-	{
-		const MacroAct & act = queue[i].macroAct;
-		if (act.isTech() && act.getTechType() == type)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	const std::deque<int> & positions = positionsOf(techPositions, type.getID());
+	return !positions.empty() && positions.back() >= nextNPosition(n);
 }
 
 size_t BuildOrderQueue::numInQueue(BWAPI::UnitType type) const
 {
-	size_t count = 0;
-	for (const auto & item : queue)
-	{
-		if (item.macroAct.isUnit() && item.macroAct.getUnitType() == type)
-		{
-			++count;
-		}
-	}
-	return count;
+	return positionsOf(unitPositions, type.getID()).size();
 }
 
 size_t BuildOrderQueue::numInNextN(BWAPI::UnitType type, int n) const
 {
-	size_t count = 0;
-
-	for (int i = queue.size() - 1; i >= std::max(0, int(queue.size()) - 1 - n); --i)
-	{
-		const MacroAct & act = queue[i].macroAct;
-		if (act.isUnit() && act.getUnitType() == type)
-		{
-			++count;
-		}
-	}
-
-	return count;
+	const std::deque<int> & positions = positionsOf(unitPositions, type.getID());
+	return size_t(positions.end() - std::lower_bound(positions.begin(), positions.end(), nextNPosition(n)));
 }
 
+// Upgrades are priced at the current upgrade level, so their cost is figured now.
+// All queued upgrades of the same type cost the same.
 void BuildOrderQueue::totalCosts(int & minerals, int & gas) const
 {
-	minerals = 0;
-	gas = 0;
-	for (const auto & item : queue)
+	minerals = fixedMinerals;
+	gas = fixedGas;
+	for (const std::deque<int> & positions : upgradePositions)
 	{
-		minerals += item.macroAct.mineralPrice();
-		gas += item.macroAct.gasPrice();
+		if (!positions.empty())
+		{
+			const MacroAct & act = queue[positions.back() - bottom].macroAct;
+			minerals += int(positions.size()) * act.mineralPrice();
+			gas += int(positions.size()) * act.gasPrice();
+		}
 	}
 }
 
 bool BuildOrderQueue::isGasStealInQueue() const
 {
-	for (const auto & item : queue)
-	{
-		if (item.isGasSteal)
-		{
-			return true;
-		}
-	}
-	return false;
+	return nGasSteals > 0;
 }
 
 void BuildOrderQueue::drawQueueInformation(int x, int y, bool outOfBook) 
@@ -311,3 +406,8 @@ BuildOrderItem BuildOrderQueue::operator [] (int i)
 {
 	return queue[i];
 }
+
+const BuildOrderItem & BuildOrderQueue::operator [] (int i) const
+{
+	return queue[i];
+}
@@ -22,6 +22,27 @@ class BuildOrderQueue
 {
     std::deque< BuildOrderItem > queue;		// highest priority item is in the back
 	bool modified;							// so ProductionManager can detect changes made behind its back
+	int nDone;								// items made, counted by doneWithHighestPriorityItem()
+
+	// Indexes for the planning queries, kept up to date as the queue changes.
+	// An item's position is its index in the queue plus bottom. Adding an item at the
+	// front lowers bottom, so the positions of the other items stay the same.
+	// Each list of positions is in increasing order, so the last is nearest the top.
+	int bottom;
+	std::vector< std::deque<int> > unitPositions;		// by unit type id
+	std::vector< std::deque<int> > techPositions;		// by tech type id
+	std::vector< std::deque<int> > upgradePositions;	// by upgrade type id
+	std::deque<int> gasPositions;						// items that cost gas
+	int fixedMinerals;									// total cost of the items other than upgrades,
+	int fixedGas;										// whose price goes up with the upgrade level
+	int nGasSteals;
+
+	std::deque<int> * positionsFor(const MacroAct & act);
+	const std::deque<int> & positionsOf(const std::vector< std::deque<int> > & byType, int id) const;
+	int nextNPosition(int n) const;
+	void addToIndex(const BuildOrderItem & item, int position, bool atTop);
+	void removeTopFromIndex(const BuildOrderItem & item);
+	void reindex();
 
 public:
 
@@ -29,6 +50,7 @@ public:
 
 	bool isModified() const { return modified; };
 	void resetModified() { modified = false; };
+	int getDoneCount() const { return nDone; };
 
     void clearAll();											// clear the entire build order queue
 	void dropStaticDefenses();									// delete any static defense buildings
@@ -62,5 +84,6 @@ public:
 	// queue[queue.size()-1] is the next item
 	// queue[0] is the last item
     BuildOrderItem operator [] (int i);
+	const BuildOrderItem & operator [] (int i) const;
 };
 }
\ No newline at end of file
@@ -4,14 +4,20 @@
 #include "Common.h"
 #include "InformationManager.h"
 #include "MapTools.h"
+#include "Profiler.h"
 
 using namespace UAlbertaBot;
 
 BuildingPlacer::BuildingPlacer()
+	: _reserveSums(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight())
+	, _occupiedSums(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight())
+	, _baseSums(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight())
 {
     _reserveMap = std::vector< std::vector<bool> >(BWAPI::Broodwar->mapWidth(),std::vector<bool>(BWAPI::Broodwar->mapHeight(),false));
 
 	reserveSpaceNearResources();
+	initializeBaseSums();
+	initializeOccupied();
 }
 
 void BuildingPlacer::reserveSpaceNearResources()
@@ -69,6 +75,98 @@ void BuildingPlacer::reserveSpaceNearResources()
 	}
 }
 
+// Mark the tiles where a building would overlap a base location, as tileOverlapsBaseLocation() defines it.
+// A building at tile (x,y) with width w overlaps if x <= right edge of the base and x + w >= left edge,
+// so each base marks its footprint plus one extra row and column.
+void BuildingPlacer::initializeBaseSums()
+{
+	const int centerWidth = BWAPI::Broodwar->self()->getRace().getCenter().tileWidth();
+	const int centerHeight = BWAPI::Broodwar->self()->getRace().getCenter().tileHeight();
+
+	for (BWTA::BaseLocation * base : BWTA::getBaseLocations())
+	{
+		BWAPI::TilePosition tile = base->getTilePosition();
+		for (int x = tile.x; x <= tile.x + centerWidth && x < BWAPI::Broodwar->mapWidth(); ++x)
+		{
+			for (int y = tile.y; y <= tile.y + centerHeight && y < BWAPI::Broodwar->mapHeight(); ++y)
+			{
+				_baseSums.add(x, y, 1);
+			}
+		}
+	}
+}
+
+// Count any buildings that are already visible.
+// After this, the unit event handlers keep the counts up to date.
+void BuildingPlacer::initializeOccupied()
+{
+	for (const auto unit : BWAPI::Broodwar->getAllUnits())
+	{
+		updateOccupied(unit, true);
+	}
+}
+
+// The tiles that a visible building blocks for placement purposes.
+// Terran buildings which can take an addon also block their addon spot, as in tileBlocksAddon().
+Rect BuildingPlacer::occupiedRect(BWAPI::Unit unit) const
+{
+	Rect rect;
+	rect.x = unit->getTilePosition().x;
+	rect.y = unit->getTilePosition().y;
+	rect.width = unit->getType().tileWidth();
+	rect.height = unit->getType().tileHeight();
+
+	if (BWAPI::Broodwar->self()->getRace() == BWAPI::Races::Terran &&
+		(unit->getType() == BWAPI::UnitTypes::Terran_Command_Center ||
+		unit->getType() == BWAPI::UnitTypes::Terran_Factory ||
+		unit->getType() == BWAPI::UnitTypes::Terran_Starport ||
+		unit->getType() == BWAPI::UnitTypes::Terran_Science_Facility))
+	{
+		rect.width += 2;
+	}
+
+	return rect;
+}
+
+void BuildingPlacer::addOccupied(const Rect & rect, int delta)
+{
+	for (int x = std::max(rect.x, 0); x < std::min(rect.x + rect.width, BWAPI::Broodwar->mapWidth()); ++x)
+	{
+		for (int y = std::max(rect.y, 0); y < std::min(rect.y + rect.height, BWAPI::Broodwar->mapHeight()); ++y)
+		{
+			_occupiedSums.add(x, y, delta);
+		}
+	}
+}
+
+// A unit event happened. Forget where the unit was, and if it is (still) a visible
+// building on the ground, count it where it is now.
+// present = false means the unit is gone or out of sight.
+// NOTE There is no event when a terran building lifts off or lands. A lifted building
+// stays counted where it was until some other event, which can make placement too cautious
+// there. canBuildHere() still asks BWAPI, so a building is never placed on top of another.
+void BuildingPlacer::updateOccupied(BWAPI::Unit unit, bool present)
+{
+	auto it = _occupied.find(unit);
+	if (it != _occupied.end())
+	{
+		addOccupied(it->second, -1);
+		_occupied.erase(it);
+	}
+
+	if (present &&
+		unit->exists() &&
+		unit->isVisible() &&
+		unit->getType().isBuilding() &&
+		!unit->isLifted() &&
+		unit->getTilePosition().isValid())
+	{
+		Rect rect = occupiedRect(unit);
+		addOccupied(rect, 1);
+		_occupied[unit] = rect;
+	}
+}
+
 BuildingPlacer & BuildingPlacer::Instance()
 {
     static BuildingPlacer instance;
@@ -78,25 +176,20 @@ BuildingPlacer & BuildingPlacer::Instance()
 // makes final checks to see if a building can be built at a certain location
 bool BuildingPlacer::canBuildHere(BWAPI::TilePosition position, const Building & b) const
 {
-    if (!BWAPI::Broodwar->canBuildHere(position,b.type,b.builderUnit))
+    // check the reserve map
+    if (_reserveSums.any(position.x, position.y, position.x + b.type.tileWidth(), position.y + b.type.tileHeight()))
     {
         return false;
     }
 
-    // check the reserve map
-    for (int x = position.x; x < position.x + b.type.tileWidth(); x++)
+    // if it overlaps a base location return false
+    if (tileOverlapsBaseLocation(position,b.type))
     {
-        for (int y = position.y; y < position.y + b.type.tileHeight(); y++)
-        {
-            if (_reserveMap[x][y])
-            {
-                return false;
-            }
-        }
+        return false;
     }
 
-    // if it overlaps a base location return false
-    if (tileOverlapsBaseLocation(position,b.type))
+    // The BWAPI check is the most expensive, so do it last.
+    if (!BWAPI::Broodwar->canBuildHere(position,b.type,b.builderUnit))
     {
         return false;
     }
@@ -125,14 +218,11 @@ bool BuildingPlacer::tileBlocksAddon(BWAPI::TilePosition position) const
 
 // Can we build this building here with the specified amount of space around it?
 // Space value is buildDist. horizontalOnly means only horizontal spacing.
+// Checks the whole box in constant time with the summed-area tables, plus one BWAPI call
+// to look for units in the way. That's the same as calling buildable() on each tile,
+// except that tiles under static resources are always unbuildable, even if out of sight.
 bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const Building & b, int buildDist) const
 {
-    //if we can't build here, we of course can't build here with space
-    if (!canBuildHere(position,b))
-    {
-        return false;
-    }
-
     // height and width of the building
     int width(b.type.tileWidth());
     int height(b.type.tileHeight());
@@ -163,7 +253,7 @@ bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const B
         endx = position.x + width + buildDist;
         endy = position.y + height + buildDist;
     }
-\
+
     // if this rectangle doesn't fit on the map we can't build here
     if (startx < 0 || starty < 0 || endx > BWAPI::Broodwar->mapWidth() || endy > BWAPI::Broodwar->mapHeight())
     {
@@ -171,13 +261,21 @@ bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const B
     }
 
     // if space is reserved, or it's in the resource box, we can't build here
-    for (int x = startx; x < endx; x++)
+    if (!b.type.isRefinery())
     {
-        for (int y = starty; y < endy; y++)
+        if (!MapTools::Instance().isAllBuildable(BWAPI::TilePosition(startx, starty), endx - startx, endy - starty) ||
+            _occupiedSums.any(startx, starty, endx, endy) ||
+            _reserveSums.any(startx, starty, endx, endy))
         {
-            if (!b.type.isRefinery())
+            return false;
+        }
+
+        // getUnitsInRectangle() only returns visible units.
+        if (b.builderUnit != nullptr)
+        {
+            for (const auto unit : BWAPI::Broodwar->getUnitsInRectangle(startx * 32, starty * 32, endx * 32 - 1, endy * 32 - 1))
             {
-                if (!buildable(b,x,y) || _reserveMap[x][y])
+                if (unit != b.builderUnit)
                 {
                     return false;
                 }
@@ -185,11 +283,14 @@ bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const B
         }
     }
 
-    return true;
+    //if we can't build here, we of course can't build here with space
+    return canBuildHere(position, b);
 }
 
 BWAPI::TilePosition BuildingPlacer::getBuildLocationNear(const Building & b, int buildDist) const
 {
+	ProfileScope profile("Building placement");
+
 	// BWAPI::Broodwar->printf("Building Placer seeks position near %d, %d", b.desiredPosition.x, b.desiredPosition.y);
 
 	// get the precomputed vector of tile positions which are sorted closest to this location
@@ -215,33 +316,9 @@ bool BuildingPlacer::tileOverlapsBaseLocation(BWAPI::TilePosition tile, BWAPI::U
         return false;
     }
 
-    // dimensions of the proposed location
-    int tx1 = tile.x;
-    int ty1 = tile.y;
-    int tx2 = tx1 + type.tileWidth();
-    int ty2 = ty1 + type.tileHeight();
-
-    // for each base location
-    for (BWTA::BaseLocation * base : BWTA::getBaseLocations())
-    {
-        // dimensions of the base location
-        int bx1 = base->getTilePosition().x;
-        int by1 = base->getTilePosition().y;
-        int bx2 = bx1 + BWAPI::Broodwar->self()->getRace().getCenter().tileWidth();
-        int by2 = by1 + BWAPI::Broodwar->self()->getRace().getCenter().tileHeight();
-
-        // conditions for non-overlap are easy
-        bool noOverlap = (tx2 < bx1) || (tx1 > bx2) || (ty2 < by1) || (ty1 > by2);
-
-        // if the reverse is true, return true
-        if (!noOverlap)
-        {
-            return true;
-        }
-    }
-
-    // otherwise there is no overlap
-    return false;
+    // The base locations are marked with an extra row and column, so including
+    // the edges of the proposed location gives the same answer as a box overlap test.
+    return _baseSums.any(tile.x, tile.y, tile.x + type.tileWidth() + 1, tile.y + type.tileHeight() + 1);
 }
 
 bool BuildingPlacer::buildable(const Building & b,int x,int y) const
@@ -286,6 +363,7 @@ void BuildingPlacer::reserveTiles(BWAPI::TilePosition position, int width, int h
         for (int y = std::max(position.y, 0); y < std::min(position.y + height, rheight); y++)
         {
             _reserveMap[x][y] = true;
+            _reserveSums.set(x, y, 1);
         }
     }
 }
@@ -322,11 +400,12 @@ void BuildingPlacer::freeTiles(BWAPI::TilePosition position, int width, int heig
     int rwidth = _reserveMap.size();
     int rheight = _reserveMap[0].size();
 
-    for (int x = position.x; x < position.x + width && x < rwidth; x++)
+    for (int x = std::max(position.x, 0); x < position.x + width && x < rwidth; x++)
     {
-        for (int y = position.y; y < position.y + height && y < rheight; y++)
+        for (int y = std::max(position.y, 0); y < position.y + height && y < rheight; y++)
         {
             _reserveMap[x][y] = false;
+            _reserveSums.set(x, y, 0);
         }
     }
 }
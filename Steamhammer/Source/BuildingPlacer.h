@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BuildingData.h"
+#include "GridSums.h"
 
 namespace UAlbertaBot
 {
@@ -11,7 +12,21 @@ class BuildingPlacer
 
     std::vector< std::vector<bool> > _reserveMap;
 
+	// Summed-area tables, so that checking a box of tiles is 4 lookups instead of a loop.
+	GridSums			_reserveSums;		// 1 for each reserved tile
+	GridSums			_occupiedSums;		// count of visible buildings covering each tile
+	GridSums			_baseSums;			// nonzero if a building on this tile would overlap a base location
+
+	// The tiles each visible building is counted on in _occupiedSums.
+	std::map<BWAPI::Unit, Rect> _occupied;
+
 	void				reserveSpaceNearResources();
+	void				initializeBaseSums();
+	void				initializeOccupied();
+
+	Rect				occupiedRect(BWAPI::Unit unit) const;
+	void				addOccupied(const Rect & rect, int delta);
+	void				updateOccupied(BWAPI::Unit unit, bool present);
 
 	// determines whether we can build at a given location
 	bool				canBuildHere(BWAPI::TilePosition position, const Building & b) const;
@@ -35,6 +50,13 @@ public:
 
     void				drawReservedTiles();
 
+	// Keep the visible building footprints up to date.
+	void				onUnitShow(BWAPI::Unit unit)		{ updateOccupied(unit, true); };
+	void				onUnitHide(BWAPI::Unit unit)		{ updateOccupied(unit, false); };
+	void				onUnitCreate(BWAPI::Unit unit)		{ updateOccupied(unit, true); };
+	void				onUnitMorph(BWAPI::Unit unit)		{ updateOccupied(unit, true); };
+	void				onUnitDestroy(BWAPI::Unit unit)		{ updateOccupied(unit, false); };
+
     BWAPI::TilePosition	getRefineryPosition();
 
 };
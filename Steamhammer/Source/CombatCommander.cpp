@@ -94,17 +94,12 @@ void CombatCommander::update(const BWAPI::Unitset & combatUnits)
 
     _combatUnits = combatUnits;
 
+	// Squad assignments must come before the squads act on them, so they are not a scheduled task.
 	int frame8 = BWAPI::Broodwar->getFrameCount() % 8;
 
 	if (frame8 == 1)
 	{
-		updateIdleSquad();
-		updateOverlordSquad();
-		updateDropSquads();
-		updateScoutDefenseSquad();
-		updateBaseDefenseSquads();
-		updateReconSquad();
-		updateAttackSquads();
+		updateSquadAssignments();
 	}
 	else if (frame8 % 4 == 2)
 	{
@@ -118,6 +113,18 @@ void CombatCommander::update(const BWAPI::Unitset & combatUnits)
 	cancelDyingItems();
 }
 
+// Assign units to squads and give the squads their orders. Every 8 frames.
+void CombatCommander::updateSquadAssignments()
+{
+	updateIdleSquad();
+	updateOverlordSquad();
+	updateDropSquads();
+	updateScoutDefenseSquad();
+	updateBaseDefenseSquads();
+	updateReconSquad();
+	updateAttackSquads();
+}
+
 void CombatCommander::updateIdleSquad()
 {
     Squad & idleSquad = _squadData.getSquad("Idle");
@@ -23,6 +23,7 @@ class CombatCommander
 
 	bool            wantSquadDetectors() const;
 
+	void            updateSquadAssignments();
 	void            updateIdleSquad();
 	void            updateOverlordSquad();
 	void            updateAttackSquads();
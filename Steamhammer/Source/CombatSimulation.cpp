@@ -1,5 +1,6 @@
 #include "CombatSimulation.h"
 #include "FAP.h"
+#include "Profiler.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
@@ -12,6 +13,8 @@ CombatSimulation::CombatSimulation()
 // this center will most likely be the position of the forwardmost combat unit we control
 void CombatSimulation::setCombatUnits(const BWAPI::Position & center, int radius, bool visibleOnly)
 {
+	ProfileScope profile("Combat sim units");
+
 	fap.clearState();
 
 	if (Config::Debug::DrawCombatSimulationInfo)
@@ -31,7 +34,7 @@ void CombatSimulation::setCombatUnits(const BWAPI::Position & center, int radius
 	if (visibleOnly)
 	{
 		// Only units that we can see right now.
-		BWAPI::Unitset enemyCombatUnits;
+		std::vector<BWAPI::Unit> enemyCombatUnits;
 		MapGrid::Instance().getUnits(enemyCombatUnits, center, radius, false, true);
 		for (const auto unit : enemyCombatUnits)
 		{
@@ -91,7 +94,7 @@ void CombatSimulation::setCombatUnits(const BWAPI::Position & center, int radius
 	}
 
 	// Add our units.
-	BWAPI::Unitset ourCombatUnits;
+	std::vector<BWAPI::Unit> ourCombatUnits;
 	MapGrid::Instance().getUnits(ourCombatUnits, center, radius, true, false);
 	for (const auto unit : ourCombatUnits)
 	{
@@ -113,6 +116,8 @@ void CombatSimulation::setCombatUnits(const BWAPI::Position & center, int radius
 
 double CombatSimulation::simulateCombat()
 {
+	ProfileScope profile("Combat sim");
+
 	fap.simulate();
 	std::pair<int, int> scores = fap.playerScores();
 
@@ -0,0 +1,70 @@
+#include "CompactDistances.h"
+
+#include "GridDistances.h"
+#include "UABAssert.h"
+
+using namespace UAlbertaBot;
+
+// Create an empty map. Every tile is unreachable.
+CompactDistances::CompactDistances()
+	: width(0)
+	, height(0)
+{
+}
+
+// Compute the full distance map, then keep only the reachable span of each column.
+CompactDistances::CompactDistances(const BWAPI::TilePosition & start)
+	: width(BWAPI::Broodwar->mapWidth())
+	, height(BWAPI::Broodwar->mapHeight())
+	, columnOffset(width, 0)
+	, columnStart(width, 0)
+	, columnLength(width, 0)
+{
+	GridDistances distances(start);
+
+	for (int x = 0; x < width; ++x)
+	{
+		int first = 0;
+		while (first < height && distances.at(x, first) < 0)
+		{
+			++first;
+		}
+		int last = height - 1;
+		while (last >= first && distances.at(x, last) < 0)
+		{
+			--last;
+		}
+
+		columnOffset[x] = int(values.size());
+		columnStart[x] = (unsigned short)(first);
+		columnLength[x] = (unsigned short)(last - first + 1);
+		for (int y = first; y <= last; ++y)
+		{
+			values.push_back(short(distances.at(x, y)));
+		}
+	}
+
+	values.shrink_to_fit();
+}
+
+int CompactDistances::at(int x, int y) const
+{
+	UAB_ASSERT(x >= 0 && y >= 0 && x < width && y < height, "bad tile %d,%d", x, y);
+
+	const int i = y - columnStart[x];
+	if (i < 0 || i >= columnLength[x])
+	{
+		return -1;
+	}
+	return values[columnOffset[x] + i];
+}
+
+int CompactDistances::getMemoryBytes() const
+{
+	return int(
+		sizeof(CompactDistances) +
+		columnOffset.capacity() * sizeof(int) +
+		columnStart.capacity() * sizeof(unsigned short) +
+		columnLength.capacity() * sizeof(unsigned short) +
+		values.capacity() * sizeof(short));
+}
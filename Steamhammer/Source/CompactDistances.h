@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "BWAPI.h"
+
+// Ground distances from one tile, stored compactly, for long-lived maps like each Base's.
+
+// A GridDistances keeps a short for every tile of the map, plus a list of every reachable
+// tile in distance order (8 bytes per tile), up to about 640KB on a 256x256 map. Here we keep
+// only the distances, and in each column only the span from the first reachable tile
+// to the last. Tiles outside the span are unreachable. Unwalkable borders, other
+// islands, and the lists cost nothing. Lookup is still O(1).
+
+namespace UAlbertaBot
+{
+class CompactDistances
+{
+	int width;
+	int height;
+
+	std::vector<int> columnOffset;				// per column, index of its span in values
+	std::vector<unsigned short> columnStart;	// per column, y of the first stored tile
+	std::vector<unsigned short> columnLength;	// per column, number of stored tiles
+	std::vector<short> values;					// the spans, one after another
+
+public:
+	CompactDistances();
+	CompactDistances(const BWAPI::TilePosition & start);
+
+	// Ground distance in tiles, -1 if unreachable.
+	int at(int x, int y) const;
+	int at(const BWAPI::TilePosition & pos) const { return at(pos.x, pos.y); };
+	int at(const BWAPI::Position & pos) const { return at(BWAPI::TilePosition(pos)); };
+
+	int getMemoryBytes() const;
+};
+}
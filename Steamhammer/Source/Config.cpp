@@ -24,7 +24,10 @@ namespace Config
 		std::string WriteDir				= "bwapi-data/write/";
 		int MaxGameRecords					= 0;
 		bool ReadOpponentModel				= false;
+		int ReadOpponentModelLimitMs		= 1000;		// how long the opening decision waits for the file
 		bool WriteOpponentModel				= false;
+		bool UseBuildOrderCacheFile			= false;	// keep solved BOSS build orders between games
+		bool WriteProfile					= false;
 	}
 
 	namespace Strategy
@@ -60,6 +63,7 @@ namespace Config
     namespace Tournament						
     {
         int GameEndFrame                    = 86400;	
+        int FrameBudgetMs                   = 35;       // aim to stay well under the 55ms limit
     }
     
     namespace Debug								
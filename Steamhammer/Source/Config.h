@@ -28,7 +28,10 @@ namespace Config
 		extern std::string WriteDir;
 		extern int MaxGameRecords;
 		extern bool ReadOpponentModel;
+		extern int ReadOpponentModelLimitMs;
 		extern bool WriteOpponentModel;
+		extern bool UseBuildOrderCacheFile;
+		extern bool WriteProfile;
 	}
 
 	namespace Strategy
@@ -54,6 +57,7 @@ namespace Config
     namespace Tournament
     {
         extern int GameEndFrame;	
+        extern int FrameBudgetMs;
     }
 
     namespace Debug
@@ -0,0 +1,229 @@
+#include "FlowField.h"
+
+#include "Config.h"
+#include "UABAssert.h"
+
+using namespace UAlbertaBot;
+
+// Neighbors: 4 orthogonal, then 4 diagonal.
+const int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int stepY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+// Keep at most this many fields.
+const size_t MaxFields = 12;
+
+FlowField::FlowField(const BWAPI::TilePosition & tile)
+	: target(tile)
+	, distances(tile)
+{
+	computeDirections();
+}
+
+// For each tile, step to the neighbor with the smallest distance.
+// Diagonal steps are allowed only when both orthogonal tiles are reachable,
+// so that we don't try to cut corners between unwalkable tiles.
+// Ties go to the first neighbor in order, which makes the steps a tree.
+void FlowField::computeDirections()
+{
+	const int width = BWAPI::Broodwar->mapWidth();
+	const int height = BWAPI::Broodwar->mapHeight();
+
+	direction.assign(width * height, -1);
+
+	for (int x = 0; x < width; ++x)
+	{
+		for (int y = 0; y < height; ++y)
+		{
+			int bestDist = distances.at(x, y);
+			if (bestDist <= 0)
+			{
+				continue;
+			}
+
+			for (int i = 0; i < 8; ++i)
+			{
+				const int nx = x + stepX[i];
+				const int ny = y + stepY[i];
+				if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+				{
+					continue;
+				}
+				if (i >= 4 && (distances.at(nx, y) < 0 || distances.at(x, ny) < 0))
+				{
+					continue;
+				}
+				const int d = distances.at(nx, ny);
+				if (d >= 0 && d < bestDist)
+				{
+					bestDist = d;
+					direction[tileIndex(x, y)] = char(i);
+				}
+			}
+		}
+	}
+}
+
+int FlowField::getTileDistance(const BWAPI::TilePosition & tile) const
+{
+	if (!tile.isValid())
+	{
+		return -1;
+	}
+	return distances.at(tile);
+}
+
+int FlowField::getTileDistance(const BWAPI::Position & pos) const
+{
+	return getTileDistance(BWAPI::TilePosition(pos));
+}
+
+BWAPI::TilePosition FlowField::nextTile(const BWAPI::TilePosition & tile) const
+{
+	if (!tile.isValid())
+	{
+		return tile;
+	}
+
+	const int i = direction[tileIndex(tile.x, tile.y)];
+	if (i < 0)
+	{
+		return tile;
+	}
+	return BWAPI::TilePosition(tile.x + stepX[i], tile.y + stepY[i]);
+}
+
+// Walk down the field to the first tile whose distance is at or below the next
+// multiple of stride. The goal distance is fixed while the unit moves within one band,
+// so the waypoint stays put until the unit reaches it.
+BWAPI::Position FlowField::getWaypoint(const BWAPI::Position & from, int stride) const
+{
+	UAB_ASSERT(stride > 0, "bad stride");
+
+	BWAPI::TilePosition tile(from);
+	int dist = getTileDistance(tile);
+	if (dist <= stride)
+	{
+		return BWAPI::Positions::None;
+	}
+
+	const int goal = stride * ((dist - 1) / stride);
+	while (dist > goal)
+	{
+		BWAPI::TilePosition next = nextTile(tile);
+		if (next == tile)
+		{
+			return BWAPI::Positions::None;
+		}
+		tile = next;
+		dist = getTileDistance(tile);
+	}
+
+	return BWAPI::Position(tile) + BWAPI::Position(16, 16);
+}
+
+void FlowField::draw() const
+{
+	for (int x = 0; x < BWAPI::Broodwar->mapWidth(); ++x)
+	{
+		for (int y = 0; y < BWAPI::Broodwar->mapHeight(); ++y)
+		{
+			BWAPI::TilePosition tile(x, y);
+			BWAPI::TilePosition next = nextTile(tile);
+			if (next != tile && BWAPI::Broodwar->isVisible(tile))
+			{
+				BWAPI::Broodwar->drawLineMap(
+					BWAPI::Position(tile) + BWAPI::Position(16, 16),
+					BWAPI::Position(next) + BWAPI::Position(16, 16),
+					BWAPI::Colors::Grey);
+			}
+		}
+	}
+	BWAPI::Broodwar->drawCircleMap(BWAPI::Position(target) + BWAPI::Position(16, 16), 12, BWAPI::Colors::Orange);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+FlowFields::FlowFields()
+	: lastComputeFrame(-1)
+{
+}
+
+// Forget fields that no order holds any more. They have already been freed.
+void FlowFields::expire()
+{
+	for (auto it = fields.begin(); it != fields.end(); )
+	{
+		if (it->field.expired())
+		{
+			it = fields.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+std::shared_ptr<const FlowField> FlowFields::get(const BWAPI::TilePosition & target)
+{
+	if (!target.isValid())
+	{
+		return nullptr;
+	}
+
+	const int now = BWAPI::Broodwar->getFrameCount();
+
+	for (const Entry & entry : fields)
+	{
+		if (entry.target == target)
+		{
+			std::shared_ptr<const FlowField> field = entry.field.lock();
+			if (field)
+			{
+				return field;
+			}
+		}
+	}
+
+	// Not found. Compute it, if we haven't already computed one this frame.
+	if (lastComputeFrame == now)
+	{
+		return nullptr;
+	}
+
+	expire();
+	if (fields.size() >= MaxFields)
+	{
+		return nullptr;
+	}
+
+	lastComputeFrame = now;
+	std::shared_ptr<const FlowField> field = std::make_shared<FlowField>(target);
+	Entry entry;
+	entry.target = target;
+	entry.field = field;
+	fields.push_back(entry);
+	return field;
+}
+
+std::shared_ptr<const FlowField> FlowFields::get(const BWAPI::Position & target)
+{
+	return get(BWAPI::TilePosition(target));
+}
+
+void FlowFields::draw() const
+{
+	if (!Config::Debug::DrawMapDistances)
+	{
+		return;
+	}
+
+	for (const Entry & entry : fields)
+	{
+		std::shared_ptr<const FlowField> field = entry.field.lock();
+		if (field)
+		{
+			field->draw();
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "BWAPI.h"
+#include "GridDistances.h"
+
+// Shared ground movement toward a target tile.
+
+// A flow field is a ground distance map to one target, plus for each tile the neighbor
+// tile that is one step closer. Following the steps from any tile leads to the target.
+// Every squad unit moving to the same order position can share one field: Distances
+// are a lookup, and waypoints are a short walk along the field.
+
+// The steps form a tree rooted at the target, so a unit which follows its waypoint
+// stays on the same branch and keeps getting the same waypoint until it passes it.
+// That keeps us from spamming changed move commands.
+
+namespace UAlbertaBot
+{
+class FlowField
+{
+	BWAPI::TilePosition target;
+	GridDistances distances;
+	std::vector<char> direction;		// per tile, index of the next step, or -1 at the target or if unreachable
+
+	int tileIndex(int x, int y) const { return x * BWAPI::Broodwar->mapHeight() + y; };
+
+	void computeDirections();
+
+public:
+	FlowField(const BWAPI::TilePosition & tile);
+
+	const BWAPI::TilePosition & getTarget() const { return target; };
+
+	// Ground distance in tiles to the target, -1 if unreachable.
+	int getTileDistance(const BWAPI::TilePosition & tile) const;
+	int getTileDistance(const BWAPI::Position & pos) const;
+
+	// The next tile toward the target. The same tile at the target or if unreachable.
+	BWAPI::TilePosition nextTile(const BWAPI::TilePosition & tile) const;
+
+	// A point on the way to the target, roughly stride tiles ahead.
+	// None if the target is close or can't be reached; then move directly.
+	BWAPI::Position getWaypoint(const BWAPI::Position & from, int stride) const;
+
+	void draw() const;
+};
+
+// The shared fields, one per target tile.
+// A field is computed when first asked for. The squad orders to its target hold it,
+// see SquadOrder::getFlowField(), and it is freed when the last of them lets go.
+// We only keep track of it so that other orders to the same target can find it.
+class FlowFields
+{
+	struct Entry
+	{
+		BWAPI::TilePosition target;
+		std::weak_ptr<const FlowField> field;
+	};
+
+	std::vector<Entry> fields;
+	int lastComputeFrame;
+
+	void expire();
+
+public:
+	FlowFields();
+
+	// The field for the target tile, or null if it is not available yet.
+	// To spread the load, at most one new field is computed per frame.
+	std::shared_ptr<const FlowField> get(const BWAPI::TilePosition & target);
+	std::shared_ptr<const FlowField> get(const BWAPI::Position & target);
+
+	void draw() const;
+};
+}
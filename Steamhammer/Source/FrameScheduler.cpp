@@ -0,0 +1,137 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include "Common.h"
+#include "Profiler.h"
+#include "UABAssert.h"
+#include "../../BOSS/source/Timer.hpp"
+
+using namespace UAlbertaBot;
+
+// How fast the estimated cost follows the measured cost. 1.0 would keep only the latest run.
+const double CostLearningRate = 0.2;
+
+FrameScheduler::FrameScheduler()
+	: lastFrameMs(0.0)
+{
+}
+
+// A task that has waited a whole extra period runs no matter what.
+bool FrameScheduler::mustRun(const Task & task, int now) const
+{
+	return now - task.lastRunFrame >= 2 * task.period;
+}
+
+void FrameScheduler::add(const std::string & name, int period, Priority priority, double estimatedMs, const std::function<void()> & run)
+{
+	UAB_ASSERT(period > 0, "bad period");
+
+	Task task;
+	task.name = name;
+	task.run = run;
+	task.period = period;
+	task.priority = priority;
+	task.estimatedMs = estimatedMs;
+	task.maxMs = 0.0;
+	task.deferrals = 0;
+
+	// Stagger the first runs: task n is first due on frame (3 * n) % period.
+	task.lastRunFrame = BWAPI::Broodwar->getFrameCount() + (3 * int(tasks.size())) % period - period;
+
+	tasks.push_back(task);
+}
+
+double FrameScheduler::getDueMs() const
+{
+	const int now = BWAPI::Broodwar->getFrameCount();
+
+	double ms = 0.0;
+	for (const Task & task : tasks)
+	{
+		if (now - task.lastRunFrame >= task.period)
+		{
+			ms += task.estimatedMs;
+		}
+	}
+	return ms;
+}
+
+void FrameScheduler::update(double elapsedMs, double budgetMs)
+{
+	const int now = BWAPI::Broodwar->getFrameCount();
+
+	// The tasks that are due, in the order to consider them.
+	std::vector<size_t> due;
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		if (now - tasks[i].lastRunFrame >= tasks[i].period)
+		{
+			due.push_back(i);
+		}
+	}
+	std::stable_sort(due.begin(), due.end(), [&](size_t a, size_t b)
+	{
+		const Task & ta = tasks[a];
+		const Task & tb = tasks[b];
+		if (mustRun(ta, now) != mustRun(tb, now))
+		{
+			return mustRun(ta, now);
+		}
+		if (ta.priority != tb.priority)
+		{
+			return ta.priority > tb.priority;
+		}
+		// The one that is later relative to its period goes first.
+		return (now - ta.lastRunFrame) * tb.period > (now - tb.lastRunFrame) * ta.period;
+	});
+
+	BOSS::Timer frameTimer;
+	frameTimer.start();
+
+	for (const size_t i : due)
+	{
+		Task & task = tasks[i];
+
+		if (!mustRun(task, now) &&
+			elapsedMs + frameTimer.getElapsedTimeInMilliSec() + task.estimatedMs > budgetMs)
+		{
+			++task.deferrals;
+			continue;
+		}
+
+		BOSS::Timer taskTimer;
+		taskTimer.start();
+		{
+			ProfileScope profile(task.name.c_str());
+			task.run();
+		}
+		taskTimer.stop();
+
+		const double ms = taskTimer.getElapsedTimeInMilliSec();
+		task.estimatedMs += CostLearningRate * (ms - task.estimatedMs);
+		task.maxMs = std::max(task.maxMs, ms);
+		task.lastRunFrame = now;
+	}
+
+	frameTimer.stop();
+	lastFrameMs = frameTimer.getElapsedTimeInMilliSec();
+}
+
+void FrameScheduler::draw(int x, int y) const
+{
+	if (!Config::Debug::DrawModuleTimers)
+	{
+		return;
+	}
+
+	BWAPI::Broodwar->drawTextScreen(x, y, "%cTask          est ms   max ms  defer", white);
+	y += 10;
+	for (const Task & task : tasks)
+	{
+		BWAPI::Broodwar->drawTextScreen(x, y, "%c%s", yellow, task.name.c_str());
+		BWAPI::Broodwar->drawTextScreen(x + 70, y, "%c%.3f", cyan, task.estimatedMs);
+		BWAPI::Broodwar->drawTextScreen(x + 110, y, "%c%.3f", cyan, task.maxMs);
+		BWAPI::Broodwar->drawTextScreen(x + 150, y, "%c%d", task.deferrals > 0 ? orange : cyan, task.deferrals);
+		y += 10;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Run periodic work within a per-frame time budget.
+
+// A task is work that has to happen about every so many frames, but not on any
+// particular frame. Each frame, the scheduler runs the tasks that are due, highest
+// priority first, as long as the frame stays within its budget. A task that doesn't
+// fit waits for a later frame, but not for longer than another full period; then it
+// runs regardless. The cost of each task is learned from timing its past runs.
+
+// That keeps periodic work from all landing on the same frame and causing a spike.
+
+namespace UAlbertaBot
+{
+class FrameScheduler
+{
+public:
+	enum Priority { Low, Normal, High };
+
+private:
+	struct Task
+	{
+		std::string				name;
+		std::function<void()>	run;
+		int						period;			// frames between runs
+		Priority				priority;
+		double					estimatedMs;	// learned from past runs
+		double					maxMs;			// longest run so far
+		int						lastRunFrame;
+		int						deferrals;		// times it was due but did not fit
+	};
+
+	std::vector<Task>			tasks;
+	double						lastFrameMs;	// time spent in tasks on the latest frame
+
+	bool mustRun(const Task & task, int now) const;
+
+public:
+	FrameScheduler();
+
+	// The estimated cost is only a starting point. The first run happens within
+	// one period, at an offset to spread the tasks out.
+	void add(const std::string & name, int period, Priority priority, double estimatedMs, const std::function<void()> & run);
+
+	// elapsedMs is the time already used this frame, budgetMs the target for the whole frame.
+	void update(double elapsedMs, double budgetMs);
+
+	// The estimated cost of the tasks due this frame, to set time aside for them.
+	double getDueMs() const;
+
+	double getLastFrameMs() const { return lastFrameMs; };
+
+	void draw(int x, int y) const;
+};
+}
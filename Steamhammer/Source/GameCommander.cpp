@@ -2,12 +2,14 @@
 #include "GameCommander.h"
 #include "MapTools.h"
 #include "OpponentModel.h"
+#include "The.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
 
 GameCommander::GameCommander() 
-	: _combatCommander(CombatCommander::Instance())
+	: the(The::Root())
+	, _combatCommander(CombatCommander::Instance())
 	, _initialScoutTime(0)
 	, _surrenderTime(0)
 {
@@ -44,8 +46,9 @@ void GameCommander::update()
 	MapGrid::Instance().update();
 	_timerManager.stopTimer(TimerManager::MapGrid);
 
+	// The search gets the time left over, after setting aside time for the scheduled tasks due this frame.
 	_timerManager.startTimer(TimerManager::Search);
-	BOSSManager::Instance().update(35 - _timerManager.getMilliseconds());
+	BOSSManager::Instance().update(Config::Tournament::FrameBudgetMs - _timerManager.getMilliseconds() - the.scheduler.getDueMs());
 	_timerManager.stopTimer(TimerManager::Search);
 
 	_timerManager.startTimer(TimerManager::Worker);
@@ -72,6 +75,11 @@ void GameCommander::update()
 	OpponentModel::Instance().update();
 	_timerManager.stopTimer(TimerManager::OpponentModel);
 
+	// Periodic work registered by the managers, as far as the time budget allows.
+	_timerManager.startTimer(TimerManager::Scheduled);
+	the.scheduler.update(_timerManager.getMilliseconds(), Config::Tournament::FrameBudgetMs);
+	_timerManager.stopTimer(TimerManager::Scheduled);
+
 	_timerManager.stopTimer(TimerManager::Total);
 
 	drawDebugInterface();
@@ -89,9 +97,11 @@ void GameCommander::drawDebugInterface()
 	BOSSManager::Instance().drawSearchInformation(490, 100);
     BOSSManager::Instance().drawStateInformation(250, 0);
 	MapTools::Instance().drawHomeDistances();
+	the.flowFields.draw();
     
 	_combatCommander.drawSquadInformation(200, 70);
     _timerManager.displayTimers(490, 225);
+	the.scheduler.draw(490, 345);
     drawGameInformation(4, 1);
 
 	drawUnitOrders();
@@ -312,16 +322,19 @@ void GameCommander::onUnitShow(BWAPI::Unit unit)
 { 
 	InformationManager::Instance().onUnitShow(unit); 
 	WorkerManager::Instance().onUnitShow(unit);
+	BuildingPlacer::Instance().onUnitShow(unit);
 }
 
 void GameCommander::onUnitHide(BWAPI::Unit unit)			
 { 
 	InformationManager::Instance().onUnitHide(unit); 
+	BuildingPlacer::Instance().onUnitHide(unit);
 }
 
 void GameCommander::onUnitCreate(BWAPI::Unit unit)		
 { 
 	InformationManager::Instance().onUnitCreate(unit); 
+	BuildingPlacer::Instance().onUnitCreate(unit);
 }
 
 void GameCommander::onUnitComplete(BWAPI::Unit unit)
@@ -339,12 +352,14 @@ void GameCommander::onUnitDestroy(BWAPI::Unit unit)
 	ProductionManager::Instance().onUnitDestroy(unit);
 	WorkerManager::Instance().onUnitDestroy(unit);
 	InformationManager::Instance().onUnitDestroy(unit); 
+	BuildingPlacer::Instance().onUnitDestroy(unit);
 }
 
 void GameCommander::onUnitMorph(BWAPI::Unit unit)		
 { 
 	InformationManager::Instance().onUnitMorph(unit);
 	WorkerManager::Instance().onUnitMorph(unit);
+	BuildingPlacer::Instance().onUnitMorph(unit);
 }
 
 // Used only to choose a worker to scout.
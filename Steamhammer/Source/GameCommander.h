@@ -32,6 +32,7 @@ public:
 
 class GameCommander 
 {
+	The &					the;
 	CombatCommander &		_combatCommander;
 	TimerManager		    _timerManager;
 
@@ -8,286 +8,39 @@
 
 using namespace UAlbertaBot;
 
-// Take a digest snapshot of the game situation.
-void GameRecord::takeSnapshot()
-{
-	snapshots.push_back(new GameSnapshot(PlayerSnapshot (BWAPI::Broodwar->self()), PlayerSnapshot (BWAPI::Broodwar->enemy())));
-}
-
-BWAPI::Race GameRecord::charRace(char ch)
-{
-	if (ch == 'Z')
-	{
-		return BWAPI::Races::Zerg;
-	}
-	if (ch == 'P')
-	{
-		return BWAPI::Races::Protoss;
-	}
-	if (ch == 'T')
-	{
-		return BWAPI::Races::Terran;
-	}
-	return BWAPI::Races::Unknown;
-}
-
-// Read a number that is on a line by itself.
-// The number must be an integer >= 0.
-int GameRecord::readNumber(std::istream & input)
-{
-	std::string line;
-	int n = -1;
-
-	if (std::getline(input, line))
-	{
-		n = readNumber(line);
-	}
-
-	if (n >= 0)
-	{
-		return n;
-	}
-
-	throw game_record_read_error();
-}
-
-// Read a number from a string.
-int GameRecord::readNumber(std::string & s)
-{
-	std::istringstream lineStream(s);
-	int n;
-	if (lineStream >> n)
-	{
-		return n;
-	}
-
-	// BWAPI::Broodwar->printf("read bad number");
-	throw game_record_read_error();
-}
-
-void GameRecord::parseMatchup(const std::string & s)
-{
-	if (s.length() == 3)        // "ZvT"
-	{
-		if (s[1] != 'v')
-		{
-			throw game_record_read_error();
-		}
-		ourRace = charRace(s[0]);
-		enemyRace = charRace(s[2]);
-		enemyIsRandom = false;
-	}
-	else if (s.length() == 4)   // "ZvRT"
-	{
-		if (s[1] != 'v' || s[2] != 'R')
-		{
-			throw game_record_read_error();
-		}
-		ourRace = charRace(s[0]);
-		enemyRace = charRace(s[3]);
-		enemyIsRandom = true;
-	}
-	else
-	{
-		throw game_record_read_error();
-	}
-
-	// Validity check. We should know our own race.
-	if (ourRace == BWAPI::Races::Unknown)
-	{
-		throw game_record_read_error();
-	}
-}
-
-OpeningPlan GameRecord::readOpeningPlan(std::istream & input)
-{
-	std::string line;
-
-	if (std::getline(input, line))
-	{
-		return OpeningPlanFromString(line);
-	}
-
-	// BWAPI::Broodwar->printf("read bad opening plan");
-	throw game_record_read_error();
-}
-
-// Return true if the snapshot is valid and we should continue reading, otherwise false or throw.
-bool GameRecord::readPlayerSnapshot(std::istream & input, PlayerSnapshot & snap)
-{
-	std::string line;
-
-	if (std::getline(input, line))
-	{
-		if (line == gameEndMark)
-		{
-			return false;
-		}
-
-		std::istringstream lineStream(line);
-		int bases, id, n;
-		
-		if (lineStream >> bases)
-		{
-			snap.numBases = bases;
-		}
-		else
-		{
-			throw game_record_read_error();
-		}
-		while (lineStream >> id >> n)
-		{
-			snap.unitCounts[BWAPI::UnitType(id)] = n;
-		}
-		return true;
-	}
-	throw game_record_read_error();
-}
+// The parts of GameRecord that follow the game in progress.
+// Reading, writing, and comparing records are in GameRecordFile.cpp.
 
-// Allocate and return the next snapshot, or null if none.
-GameSnapshot * GameRecord::readGameSnapshot(std::istream & input)
+// Store one side of a snapshot of the current game.
+static void storeSide(Arena & arena, SnapshotSide & side, const PlayerSnapshot & snap, BWAPI::Race race)
 {
-	int t;
-	PlayerSnapshot me;
-	PlayerSnapshot you;
-
-	std::string line;
-
-	if (std::getline(input, line))
-	{
-		if (line == gameEndMark)
-		{
-			return nullptr;
-		}
-		t = readNumber(line);
-	}
-
-	if (valid && readPlayerSnapshot(input, me) && valid && readPlayerSnapshot(input, you) && valid)
+	std::vector< std::pair<int, int> > unitCounts;
+	for (const std::pair<BWAPI::UnitType, int> & unitCount : snap.unitCounts)
 	{
-		return new GameSnapshot(t, me, you);
+		unitCounts.push_back(std::pair<int, int>(unitCount.first.getID(), unitCount.second));
 	}
-
-	return nullptr;
+	side.store(arena, snap.numBases, race, unitCounts);
 }
 
-// Reading a game record, we hit an error before the end of the record.
-// Mark it invalid and skip to the end of game mark so we don't break the rest of the records.
-void GameRecord::skipToEnd(std::istream & input)
+void SnapshotSide::fill(PlayerSnapshot & snap) const
 {
-	std::string line;
-	while (std::getline(input, line))
+	snap.numBases = numBases;
+	snap.unitCounts.clear();
+	for (int i = 0; i < nTypes; ++i)
 	{
-		if (line == gameEndMark)
-		{
-			break;
-		}
+		snap.unitCounts[BWAPI::UnitType(types[i])] = counts[i];
 	}
 }
 
-// Read the game record from the given stream.
-// NOTE Reading is line-oriented. We read each line with getline() before parsing it.
-// In case of error, we try to read ahead to the end-of-game mark so that the next record
-// will be read correctly. But there is not much error checking.
-void GameRecord::read(std::istream & input)
-{
-	try
-	{
-		std::string formatStr;
-		if (!std::getline(input, formatStr) || formatStr != fileFormatVersion)
-		{
-			throw game_record_read_error();
-		}
-
-		std::string matchupStr;
-		if (std::getline(input, matchupStr))
-		{
-			parseMatchup(matchupStr);
-		}
-		else
-		{
-			throw game_record_read_error();
-		}
-		
-		if (!std::getline(input, mapName))     { throw game_record_read_error(); }
-		if (!std::getline(input, openingName)) { throw game_record_read_error(); }
-		expectedEnemyPlan = readOpeningPlan(input);
-		enemyPlan = readOpeningPlan(input);
-		win = readNumber(input) != 0;
-		frameScoutSentForGasSteal = readNumber(input);
-		gasStealHappened = readNumber(input) != 0;
-		frameEnemyScoutsOurBase = readNumber(input);
-		frameEnemyGetsCombatUnits = readNumber(input);
-		frameEnemyGetsAirUnits = readNumber(input);
-		frameEnemyGetsStaticAntiAir = readNumber(input);
-		frameEnemyGetsMobileAntiAir = readNumber(input);
-		frameEnemyGetsCloakedUnits = readNumber(input);
-		frameEnemyGetsStaticDetection = readNumber(input);
-		frameEnemyGetsMobileDetection = readNumber(input);
-		frameGameEnds = readNumber(input);
-
-		GameSnapshot * snap;
-		while (snap = readGameSnapshot(input))
-		{
-			snapshots.push_back(snap);
-		}
-	}
-	catch (const game_record_read_error &)
-	{
-		skipToEnd(input);      // end of the game record
-		valid = false;
-	}
-}
-
-void GameRecord::writePlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap)
-{
-	output << snap.numBases;
-	for (auto unitCount : snap.unitCounts)
-	{
-		output << ' ' << unitCount.first.getID() << ' ' << unitCount.second;
-	}
-	output << '\n';
-}
-
-void GameRecord::writeGameSnapshot(std::ostream & output, const GameSnapshot * snap)
-{
-	output << snap->frame << '\n';
-	writePlayerSnapshot(output, snap->us);
-	writePlayerSnapshot(output, snap->them);
-}
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
-// Calculate a similarity distance between 2 snapshots.
-// This version is a simple first try. Some unit types should matter more than others.
-// 12 vs. 10 zerglings should count less than 2 vs. 0 lurkers.
-// Buildings and mobile units are hard to compare. Probably should weight by cost in some way.
-// Part of distance().
-int GameRecord::snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const
+// Take a digest snapshot of the game situation.
+void GameRecord::takeSnapshot()
 {
-	int distance = 0;
-
-	// From a to b, count all differences.
-	for (std::pair<BWAPI::UnitType, int> unitCountA : a.unitCounts)
-	{
-		auto unitCountBIt = b.unitCounts.find(unitCountA.first);
-		if (unitCountBIt == b.unitCounts.end())
-		{
-			distance += unitCountA.second;
-		}
-		else
-		{
-			distance += abs(unitCountA.second - (*unitCountBIt).second);
-		}
-	}
-
-	// From b to a, count differences where a is missing the type.
-	for (std::pair<BWAPI::UnitType, int> unitCountB : b.unitCounts)
-	{
-		if (a.unitCounts.find(unitCountB.first) == a.unitCounts.end())
-		{
-			distance += unitCountB.second;
-		}
-	}
-
-	return distance;
+	GameSnapshot & snap = addSnapshot();
+	snap.frame = BWAPI::Broodwar->getFrameCount();
+	storeSide(arena, snap.us, PlayerSnapshot(BWAPI::Broodwar->self()), BWAPI::Broodwar->self()->getRace());
+	storeSide(arena, snap.them, PlayerSnapshot(BWAPI::Broodwar->enemy()), BWAPI::Broodwar->enemy()->getRace());
 }
 
 // Figure out whether the enemy has seen our base yet.
@@ -295,25 +48,18 @@ bool GameRecord::enemyScoutedUs() const
 {
 	BWTA::BaseLocation * base = InformationManager::Instance().getMyMainBaseLocation();
 
-	for (const auto & kv : InformationManager::Instance().getUnitData(BWAPI::Broodwar->enemy()).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
+	// If a unit was last spotted close to us, assume we've been seen.
+	std::vector<BWAPI::Unit> nearby;
+	InformationManager::Instance().getUnitData(BWAPI::Broodwar->enemy()).getUnitsInRadius(nearby, base->getPosition(), 800);
 
-		// If a unit was last spotted close to us, assume we've been seen.
-		if (ui.lastPosition.getDistance(base->getPosition()) < 800)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return !nearby.empty();
 }
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 // Constructor for the record of the current game.
 // When this object is initialized, the opening and some other items are not yet known.
-GameRecord::GameRecord()
+GameRecord::GameRecord(Arena & a)
 	: valid(true)                  // never invalid, since it is recorded live
 	, savedRecord(false)
 	, ourRace(BWAPI::Broodwar->self()->getRace())
@@ -334,34 +80,16 @@ GameRecord::GameRecord()
 	, frameEnemyGetsStaticDetection(0)
 	, frameEnemyGetsMobileDetection(0)
 	, frameGameEnds(0)
+	, arena(a)
+	, snapshots(nullptr)
+	, nSnapshots(0)
+	, snapshotCapacity(0)
+	, encodedSnapshots(nullptr)
+	, encodedSnapshotsSize(0)
+	, nEncodedSnapshots(0)
 {
 }
 
-// Constructor for the record of a past game.
-GameRecord::GameRecord(std::istream & input)
-	: valid(true)                  // until proven otherwise
-	, savedRecord(true)
-	, ourRace(BWAPI::Races::Unknown)
-	, enemyRace(BWAPI::Races::Unknown)
-	, enemyIsRandom(false)
-	, expectedEnemyPlan(OpeningPlan::Unknown)
-	, enemyPlan(OpeningPlan::Unknown)
-	, win(false)                   // until proven otherwise
-	, frameScoutSentForGasSteal(0)
-	, gasStealHappened(false)
-	, frameEnemyScoutsOurBase(0)
-	, frameEnemyGetsCombatUnits(0)
-	, frameEnemyGetsAirUnits(0)
-	, frameEnemyGetsStaticAntiAir(0)
-	, frameEnemyGetsMobileAntiAir(0)
-	, frameEnemyGetsCloakedUnits(0)
-	, frameEnemyGetsStaticDetection(0)
-	, frameEnemyGetsMobileDetection(0)
-	, frameGameEnds(0)
-{
-	read(input);
-}
-
 // Called when the game is over.
 void GameRecord::setWin(bool isWinner)
 {
@@ -369,69 +97,6 @@ void GameRecord::setWin(bool isWinner)
 	frameGameEnds = BWAPI::Broodwar->getFrameCount();
 }
 
-// Write the game record to the given stream. File format:
-
-// 1.4 = file format version number
-// matchup (e.g. ZvP, ZvRP)
-// map
-// opening
-// expected enemy opening plan
-// actual enemy opening plan
-// result (1 or 0)
-// frame we dispatched a scout to steal gas (0 if no attempt)
-// gas steal happened (1 or 0)
-// frame enemy first scouts our base
-// frame enemy first gets combat units
-// frame enemy first gets air units
-// frame enemy first gets static anti-air
-// frame enemy first gets mobile anti-air
-// frame enemy first gets cloaked units
-// frame enemy first gets static detection
-// frame enemy first gets mobile detection
-// game duration in frames (0 if the game is not over yet)
-// snapshots
-// END GAME
-
-void GameRecord::write(std::ostream & output)
-{
-	// We only now notice that there was an expected enemy opening plan.
-	// Can't initialize this right off, and there is no point in tracking it during the game.
-	if (!savedRecord)
-	{
-		expectedEnemyPlan = OpponentModel::Instance().getInitialExpectedEnemyPlan();
-	}
-
-	output << fileFormatVersion << '\n';
-	output <<
-		RaceChar(ourRace) <<
-		'v' <<
-		(enemyIsRandom ? "R" : "") << RaceChar(enemyRace) << '\n';
-	output << mapName << '\n';
-	output << openingName << '\n';
-	output << OpeningPlanString(expectedEnemyPlan) << '\n';
-	output << OpeningPlanString(enemyPlan) << '\n';
-	output << (win ? '1' : '0') << '\n';
-	output << frameScoutSentForGasSteal << '\n';
-	output << (gasStealHappened ? '1' : '0') << '\n';
-	output << frameEnemyScoutsOurBase << '\n';
-	output << frameEnemyGetsCombatUnits << '\n';
-	output << frameEnemyGetsAirUnits << '\n';
-	output << frameEnemyGetsStaticAntiAir << '\n';
-	output << frameEnemyGetsMobileAntiAir << '\n';
-	output << frameEnemyGetsCloakedUnits << '\n';
-	output << frameEnemyGetsStaticDetection << '\n';
-	output << frameEnemyGetsMobileDetection << '\n';
-	output << frameGameEnds << '\n';
-
-	// TODO skip the snapshots for now
-	// for (const auto & snap : snapshots)
-	// {
-	// 	writeGameSnapshot(output, snap);
-	// }
-
-	output << gameEndMark << '\n';
-}
-
 void GameRecord::update()
 {
 	int now = BWAPI::Broodwar->getFrameCount();
@@ -510,7 +175,8 @@ int GameRecord::distance(const GameRecord & record) const
 	}
 
 	// Also return -1 for any record which has no snapshots. It conveys no info.
-	if (record.snapshots.size() == 0)
+	const SnapshotSpan theirs = record.getSnapshots();
+	if (theirs.empty())
 	{
 		return -1;
 	}
@@ -528,14 +194,15 @@ int GameRecord::distance(const GameRecord & record) const
 	}
 
 	// Differences in enemy play count 5 times more than differences in our play.
-	auto here = snapshots.begin();
-	auto there = record.snapshots.begin();
+	const SnapshotSpan ours = getSnapshots();
+	auto here = ours.begin();
+	auto there = theirs.begin();
 	int latest = 0;
-	while (here != snapshots.end() && there != record.snapshots.end())     // until one record runs out
+	while (here != ours.end() && there != theirs.end())     // until one record runs out
 	{
-		distance +=     snapDistance((*here)->us,   (*there)->us);
-		distance += 5 * snapDistance((*here)->them, (*there)->them);
-		latest = (*there)->frame;
+		distance +=     SnapshotSide::Distance(here->us,   there->us);
+		distance += 5 * SnapshotSide::Distance(here->them, there->them);
+		latest = there->frame;
 
 		++here;
 		++there;
@@ -552,18 +219,17 @@ int GameRecord::distance(const GameRecord & record) const
 }
 
 // Find the enemy snapshot closest in time to time t.
-// The caller promises that there is one, but we check anyway.
+// Return false if there is none; the game may have ended before time t.
 bool GameRecord::findClosestSnapshot(int t, PlayerSnapshot & snap) const
 {
-	for (const auto & ourSnap : snapshots)
+	for (const GameSnapshot & ourSnap : getSnapshots())
 	{
-		if (abs(ourSnap->frame - t) < snapshotInterval)
+		if (abs(ourSnap.frame - t) < snapshotInterval)
 		{
-			snap = ourSnap->them;
+			ourSnap.them.fill(snap);
 			return true;
 		}
 	}
-	UAB_ASSERT(false, "opponent model - no snapshot @ t");
 	return false;
 }
 
@@ -585,31 +251,17 @@ void GameRecord::debugLog()
 		<< "vessels " << frameEnemyGetsMobileDetection << '\n'
 		<< "end of game " << frameGameEnds << '\n';
 
-	for (auto snap : snapshots)
+	for (const GameSnapshot & snap : getSnapshots())
 	{
-		msg << snap->frame << '\n'
-			<< snap->us.debugString()
-			<< snap->them.debugString();
+		PlayerSnapshot us;
+		PlayerSnapshot them;
+		snap.us.fill(us);
+		snap.them.fill(them);
+		msg << snap.frame << '\n'
+			<< us.debugString()
+			<< them.debugString();
 	}
 	msg  << '\n';
 
 	Logger::LogAppendToFile(Config::IO::ErrorLogFilename, msg.str());
 }
-
-// The game records have the same matchup, as best we can tell so far.
-// For checks at the start of the game, when the enemy's race may be unknown, allow
-// a special case for random enemies.
-bool GameRecord::sameMatchup(const GameRecord & record) const
-{
-	return ourRace == record.ourRace &&
-		(enemyRace == record.enemyRace ||
-			enemyIsRandom && record.enemyIsRandom &&
-			(enemyRace == BWAPI::Races::Unknown || record.enemyRace == BWAPI::Races::Unknown)
-		);
-}
-
-GameRecord & GameRecord::Instance()
-{
-	static GameRecord instance;
-	return instance;
-}
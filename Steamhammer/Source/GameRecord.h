@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "Arena.h"
 #include "OpponentPlan.h"
 #include "PlayerSnapshot.h"
 
@@ -13,34 +14,55 @@ class game_record_read_error : public std::exception {};
 
 namespace UAlbertaBot
 {
+// One player's unit counts in a stored snapshot. The arrays are in the arena of the game record.
+struct SnapshotSide
+{
+	int numBases;
+	BWAPI::Race race;
+	int nTypes;
+	const short * types;		// unit type ids, in increasing order
+	const short * counts;		// parallel to types
+	const short * dense;		// counts by dense slot for the race; null if some type has no slot
+	int denseSize;
+
+	void makeDense(Arena & arena);
+	void store(Arena & arena, int bases, BWAPI::Race r, const std::vector< std::pair<int, int> > & unitCounts);
+	void fill(PlayerSnapshot & snap) const;
+
+	// Dense count vectors have a fixed slot for each unit type of a race, so that
+	// snapshots of the same race can be compared quickly.
+	static int DenseSize(BWAPI::Race race);							// 0 if the race has no slots
+	static int DenseSlot(BWAPI::Race race, BWAPI::UnitType type);		// -1 if the type has no slot
+	static int DenseDistance(const short * a, const short * b, int n);
+
+	static int Distance(const SnapshotSide & a, const SnapshotSide & b);
+};
+
 struct GameSnapshot
 {
-	const int frame;
-	const PlayerSnapshot us;
-	const PlayerSnapshot them;
-
-	// For reading a snapshot from a file.
-	GameSnapshot(int t, const PlayerSnapshot & me, const PlayerSnapshot & you)
-		: frame(t)
-		, us(me)
-		, them(you)
-	{
-	}
-
-	// For taking a snapshot during the game.
-	GameSnapshot(const PlayerSnapshot & me, const PlayerSnapshot & you)
-		: frame(BWAPI::Broodwar->getFrameCount())
-		, us(me)
-		, them(you)
-	{
-	}
+	int frame;
+	SnapshotSide us;
+	SnapshotSide them;
+};
+
+// The snapshots of a game record, which lie next to each other in the arena.
+struct SnapshotSpan
+{
+	const GameSnapshot * first;
+	int n;
+
+	const GameSnapshot * begin() const { return first; };
+	const GameSnapshot * end() const { return first + n; };
+	int size() const { return n; };
+	bool empty() const { return n == 0; };
+	const GameSnapshot & operator[](int i) const { return first[i]; };
 };
 
 class GameRecord
 {
 private:
-	const int firstSnapshotTime = 2 * 60 * 24;
-	const int snapshotInterval = 30 * 24;
+	static const int firstSnapshotTime = 2 * 60 * 24;
+	static const int snapshotInterval = 30 * 24;
 
 	// Each game record is labeled with a version number, to allow some backward compatibility
 	// file format changes.
@@ -78,8 +100,17 @@ private:
 	int frameEnemyGetsMobileDetection;
 	int frameGameEnds;
 
-	// We allocate the snapshots and never release them.
-	std::vector<GameSnapshot *> snapshots;
+	// The record and its snapshots belong to the arena and are released with it.
+	// A record read from a binary file keeps its snapshots encoded until they are needed.
+	Arena & arena;
+	mutable GameSnapshot * snapshots;
+	mutable int nSnapshots;
+	mutable int snapshotCapacity;
+	mutable const unsigned char * encodedSnapshots;    // null if none are waiting to be decoded
+	size_t encodedSnapshotsSize;
+	int nEncodedSnapshots;
+
+	GameSnapshot & addSnapshot() const;
 
 	void takeSnapshot();
 
@@ -92,27 +123,32 @@ private:
 
 	OpeningPlan readOpeningPlan(std::istream & input);
 
-	bool readPlayerSnapshot(std::istream & input, PlayerSnapshot & snap);
-	GameSnapshot * readGameSnapshot(std::istream & input);
+	bool readPlayerSnapshot(std::istream & input, SnapshotSide & side, BWAPI::Race race);
+	bool readGameSnapshot(std::istream & input);
 	void skipToEnd(std::istream & input);
 	void read(std::istream & input);
+	void readBinary(const unsigned char * data, size_t size);
+	void decodeSnapshots() const;
 
-	void writePlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap);
-	void writeGameSnapshot(std::ostream & output, const GameSnapshot * snap);
-
-	int snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const;
+	void writePlayerSnapshot(std::ostream & output, const SnapshotSide & side);
+	void writeGameSnapshot(std::ostream & output, const GameSnapshot & snap);
 
 	bool enemyScoutedUs() const;
 
 public:
-	GameRecord();
-	GameRecord(std::istream & input);
+	GameRecord(Arena & a);
+	GameRecord(Arena & a, std::istream & input);
+	GameRecord(Arena & a, const unsigned char * data, size_t size);
 
-	bool isValid() { return valid; };
+	bool isValid() const { return valid; };
 	void setOpening(const std::string & opening) { openingName = opening; };
 	void setWin(bool isWinner);
 
+	// The expected enemy plan is decided at the start of the game and recorded at the end.
+	void setExpectedEnemyPlan(OpeningPlan plan) { expectedEnemyPlan = plan; };
+
 	void write(std::ostream & output);
+	void writeBinary(std::string & output);
 
 	void update();
 
@@ -120,6 +156,14 @@ public:
 
 	bool findClosestSnapshot(int t, PlayerSnapshot & snap) const;
 
+	// Snapshots are taken at regular times. Which one is this, counting from 0?
+	static int SnapshotBucket(int frame);
+	SnapshotSpan getSnapshots() const;
+	void clearSnapshots();
+
+	BWAPI::Race getOurRace() const { return ourRace; };
+	BWAPI::Race getEnemyRace() const { return enemyRace; };
+
 	bool getEnemyIsRandom() const { return enemyIsRandom; };
 	bool sameMatchup(const GameRecord & record) const;
 	const std::string & getMapName() const { return mapName; };
@@ -129,9 +173,17 @@ public:
 	bool getWin() const { return win; };
 	int getFrameScoutSentForGasSteal() const { return frameScoutSentForGasSteal; };
 	bool getGasStealHappened() const { return gasStealHappened; };
+	int getFrameEnemyScoutsOurBase() const { return frameEnemyScoutsOurBase; };
+	int getFrameEnemyGetsCombatUnits() const { return frameEnemyGetsCombatUnits; };
+	int getFrameEnemyGetsAirUnits() const { return frameEnemyGetsAirUnits; };
+	int getFrameEnemyGetsStaticAntiAir() const { return frameEnemyGetsStaticAntiAir; };
+	int getFrameEnemyGetsMobileAntiAir() const { return frameEnemyGetsMobileAntiAir; };
+	int getFrameEnemyGetsCloakedUnits() const { return frameEnemyGetsCloakedUnits; };
+	int getFrameEnemyGetsStaticDetection() const { return frameEnemyGetsStaticDetection; };
+	int getFrameEnemyGetsMobileDetection() const { return frameEnemyGetsMobileDetection; };
+	int getFrameGameEnds() const { return frameGameEnds; };
 
 	void debugLog();
-	static GameRecord & Instance();
 };
 
 }
\ No newline at end of file
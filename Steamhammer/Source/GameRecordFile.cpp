@@ -0,0 +1,788 @@
+#include "GameRecord.h"
+
+#include "OpponentModelFile.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2
+	#include <emmintrin.h>
+	#define SNAPSHOT_SSE2
+#endif
+
+using namespace UAlbertaBot;
+
+// Reading, writing, and comparing game records.
+// Nothing in this file looks at the game in progress, so tools that work
+// on opponent model files outside of a game can use it too.
+
+namespace
+{
+	// The dense slots of one race.
+	struct DenseLayout
+	{
+		BWAPI::Race race;
+		std::vector<short> slot;		// by unit type id; -1 if the type has no slot
+		size_t size;					// padded to a multiple of 8 for the SSE2 kernel
+	};
+}
+
+// Every unit type of the race has a slot, except heroes. Snapshots never count
+// a few of the types, like interceptors, but empty slots cost little.
+static std::vector<DenseLayout> makeDenseLayouts()
+{
+	int maxID = 0;
+	for (const BWAPI::UnitType type : BWAPI::UnitTypes::allUnitTypes())
+	{
+		maxID = std::max(maxID, type.getID());
+	}
+
+	std::vector<DenseLayout> layouts;
+	for (const BWAPI::Race race : { BWAPI::Races::Zerg, BWAPI::Races::Protoss, BWAPI::Races::Terran })
+	{
+		DenseLayout layout;
+		layout.race = race;
+		layout.slot.assign(maxID + 1, -1);
+		layout.size = 0;
+		for (const BWAPI::UnitType type : BWAPI::UnitTypes::allUnitTypes())
+		{
+			if (type.getRace() == race && !type.isHero())
+			{
+				layout.slot[type.getID()] = short(layout.size++);
+			}
+		}
+		layout.size = (layout.size + 7) & ~size_t(7);
+		layouts.push_back(layout);
+	}
+	return layouts;
+}
+
+// The layout for the race, or null if the race has none.
+// Records may be read on more than one thread. The layouts are made once, on first use.
+static const DenseLayout * denseLayout(BWAPI::Race race)
+{
+	static const std::vector<DenseLayout> layouts = makeDenseLayouts();
+
+	for (const DenseLayout & layout : layouts)
+	{
+		if (layout.race == race)
+		{
+			return &layout;
+		}
+	}
+	return nullptr;
+}
+
+int SnapshotSide::DenseSize(BWAPI::Race race)
+{
+	const DenseLayout * layout = denseLayout(race);
+	return layout ? int(layout->size) : 0;
+}
+
+int SnapshotSide::DenseSlot(BWAPI::Race race, BWAPI::UnitType type)
+{
+	const DenseLayout * layout = denseLayout(race);
+	const size_t id = size_t(type.getID());
+	return layout && id < layout->slot.size() ? layout->slot[id] : -1;
+}
+
+// Sum of absolute differences of two dense count vectors. n is a multiple of 8.
+// Counts are never negative, so max - min is the absolute difference and cannot overflow.
+int SnapshotSide::DenseDistance(const short * a, const short * b, int n)
+{
+#ifdef SNAPSHOT_SSE2
+	const __m128i ones = _mm_set1_epi16(1);
+	__m128i sum = _mm_setzero_si128();
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		const __m128i diff = _mm_sub_epi16(_mm_max_epi16(x, y), _mm_min_epi16(x, y));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(diff, ones));		// pairwise sums as 32 bits
+	}
+	int parts[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(parts), sum);
+	return parts[0] + parts[1] + parts[2] + parts[3];
+#else
+	int sum = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		sum += abs(a[i] - b[i]);
+	}
+	return sum;
+#endif
+}
+
+// Fill in the dense counts of a side whose unit types and counts are known.
+void SnapshotSide::makeDense(Arena & arena)
+{
+	dense = nullptr;
+	denseSize = DenseSize(race);
+	if (denseSize == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < nTypes; ++i)
+	{
+		if (DenseSlot(race, BWAPI::UnitType(types[i])) < 0)
+		{
+			denseSize = 0;
+			return;
+		}
+	}
+
+	short * d = arena.makeArray<short>(denseSize);
+	for (int i = 0; i < nTypes; ++i)
+	{
+		d[DenseSlot(race, BWAPI::UnitType(types[i]))] = counts[i];
+	}
+	dense = d;
+}
+
+// The unit counts are pairs (unit type id, count), in increasing order of id.
+void SnapshotSide::store(Arena & arena, int bases, BWAPI::Race r, const std::vector< std::pair<int, int> > & unitCounts)
+{
+	numBases = bases;
+	race = r;
+	nTypes = int(unitCounts.size());
+
+	short * t = arena.makeArray<short>(nTypes);
+	short * c = arena.makeArray<short>(nTypes);
+	for (int i = 0; i < nTypes; ++i)
+	{
+		t[i] = short(unitCounts[i].first);
+		c[i] = short(std::min(unitCounts[i].second, 32767));
+	}
+	types = t;
+	counts = c;
+
+	makeDense(arena);
+}
+
+// Calculate a similarity distance between 2 snapshots: The total of the differences in unit counts.
+// This version is a simple first try. Some unit types should matter more than others.
+// 12 vs. 10 zerglings should count less than 2 vs. 0 lurkers.
+// Buildings and mobile units are hard to compare. Probably should weight by cost in some way.
+int SnapshotSide::Distance(const SnapshotSide & a, const SnapshotSide & b)
+{
+	if (a.dense && b.dense && a.race == b.race)
+	{
+		return DenseDistance(a.dense, b.dense, a.denseSize);
+	}
+
+	// Otherwise walk the two lists of unit types together.
+	int distance = 0;
+	int i = 0;
+	int j = 0;
+	while (i < a.nTypes || j < b.nTypes)
+	{
+		if (j == b.nTypes || i < a.nTypes && a.types[i] < b.types[j])
+		{
+			distance += a.counts[i++];
+		}
+		else if (i == a.nTypes || b.types[j] < a.types[i])
+		{
+			distance += b.counts[j++];
+		}
+		else
+		{
+			distance += abs(a.counts[i++] - b.counts[j++]);
+		}
+	}
+	return distance;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Make room for one more snapshot at the end and return it.
+// The snapshots stay next to each other; when they outgrow their space, they move.
+GameSnapshot & GameRecord::addSnapshot() const
+{
+	if (nSnapshots == snapshotCapacity)
+	{
+		snapshotCapacity = std::max(8, 2 * snapshotCapacity);
+		GameSnapshot * moved = arena.makeArray<GameSnapshot>(snapshotCapacity);
+		std::copy(snapshots, snapshots + nSnapshots, moved);
+		snapshots = moved;
+	}
+	return snapshots[nSnapshots++];
+}
+
+BWAPI::Race GameRecord::charRace(char ch)
+{
+	if (ch == 'Z')
+	{
+		return BWAPI::Races::Zerg;
+	}
+	if (ch == 'P')
+	{
+		return BWAPI::Races::Protoss;
+	}
+	if (ch == 'T')
+	{
+		return BWAPI::Races::Terran;
+	}
+	return BWAPI::Races::Unknown;
+}
+
+// Read a number that is on a line by itself.
+// The number must be an integer >= 0.
+int GameRecord::readNumber(std::istream & input)
+{
+	std::string line;
+	int n = -1;
+
+	if (std::getline(input, line))
+	{
+		n = readNumber(line);
+	}
+
+	if (n >= 0)
+	{
+		return n;
+	}
+
+	throw game_record_read_error();
+}
+
+// Read a number from a string.
+int GameRecord::readNumber(std::string & s)
+{
+	std::istringstream lineStream(s);
+	int n;
+	if (lineStream >> n)
+	{
+		return n;
+	}
+
+	// BWAPI::Broodwar->printf("read bad number");
+	throw game_record_read_error();
+}
+
+void GameRecord::parseMatchup(const std::string & s)
+{
+	if (s.length() == 3)        // "ZvT"
+	{
+		if (s[1] != 'v')
+		{
+			throw game_record_read_error();
+		}
+		ourRace = charRace(s[0]);
+		enemyRace = charRace(s[2]);
+		enemyIsRandom = false;
+	}
+	else if (s.length() == 4)   // "ZvRT"
+	{
+		if (s[1] != 'v' || s[2] != 'R')
+		{
+			throw game_record_read_error();
+		}
+		ourRace = charRace(s[0]);
+		enemyRace = charRace(s[3]);
+		enemyIsRandom = true;
+	}
+	else
+	{
+		throw game_record_read_error();
+	}
+
+	// Validity check. We should know our own race.
+	if (ourRace == BWAPI::Races::Unknown)
+	{
+		throw game_record_read_error();
+	}
+}
+
+OpeningPlan GameRecord::readOpeningPlan(std::istream & input)
+{
+	std::string line;
+
+	if (std::getline(input, line))
+	{
+		return OpeningPlanFromString(line);
+	}
+
+	// BWAPI::Broodwar->printf("read bad opening plan");
+	throw game_record_read_error();
+}
+
+// Return true if the snapshot is valid and we should continue reading, otherwise false or throw.
+bool GameRecord::readPlayerSnapshot(std::istream & input, SnapshotSide & side, BWAPI::Race race)
+{
+	std::string line;
+
+	if (std::getline(input, line))
+	{
+		if (line == gameEndMark)
+		{
+			return false;
+		}
+
+		std::istringstream lineStream(line);
+		int bases, id, n;
+		std::vector< std::pair<int, int> > unitCounts;
+
+		if (!(lineStream >> bases))
+		{
+			throw game_record_read_error();
+		}
+		while (lineStream >> id >> n)
+		{
+			if (id < 0 || id > 0x7FFF)
+			{
+				throw game_record_read_error();
+			}
+			unitCounts.push_back(std::pair<int, int>(id, n));
+		}
+		std::sort(unitCounts.begin(), unitCounts.end());
+		side.store(arena, bases, race, unitCounts);
+		return true;
+	}
+	throw game_record_read_error();
+}
+
+// Read the next snapshot. Return false if there is none.
+bool GameRecord::readGameSnapshot(std::istream & input)
+{
+	int t;
+	GameSnapshot snap;
+
+	std::string line;
+
+	if (std::getline(input, line))
+	{
+		if (line == gameEndMark)
+		{
+			return false;
+		}
+		t = readNumber(line);
+	}
+
+	if (valid && readPlayerSnapshot(input, snap.us, ourRace) && valid && readPlayerSnapshot(input, snap.them, enemyRace) && valid)
+	{
+		snap.frame = t;
+		addSnapshot() = snap;
+		return true;
+	}
+
+	return false;
+}
+
+// Reading a game record, we hit an error before the end of the record.
+// Mark it invalid and skip to the end of game mark so we don't break the rest of the records.
+void GameRecord::skipToEnd(std::istream & input)
+{
+	std::string line;
+	while (std::getline(input, line))
+	{
+		if (line == gameEndMark)
+		{
+			break;
+		}
+	}
+}
+
+// Read the game record from the given stream.
+// NOTE Reading is line-oriented. We read each line with getline() before parsing it.
+// In case of error, we try to read ahead to the end-of-game mark so that the next record
+// will be read correctly. But there is not much error checking.
+void GameRecord::read(std::istream & input)
+{
+	try
+	{
+		std::string formatStr;
+		if (!std::getline(input, formatStr) || formatStr != fileFormatVersion)
+		{
+			throw game_record_read_error();
+		}
+
+		std::string matchupStr;
+		if (std::getline(input, matchupStr))
+		{
+			parseMatchup(matchupStr);
+		}
+		else
+		{
+			throw game_record_read_error();
+		}
+		
+		if (!std::getline(input, mapName))     { throw game_record_read_error(); }
+		if (!std::getline(input, openingName)) { throw game_record_read_error(); }
+		expectedEnemyPlan = readOpeningPlan(input);
+		enemyPlan = readOpeningPlan(input);
+		win = readNumber(input) != 0;
+		frameScoutSentForGasSteal = readNumber(input);
+		gasStealHappened = readNumber(input) != 0;
+		frameEnemyScoutsOurBase = readNumber(input);
+		frameEnemyGetsCombatUnits = readNumber(input);
+		frameEnemyGetsAirUnits = readNumber(input);
+		frameEnemyGetsStaticAntiAir = readNumber(input);
+		frameEnemyGetsMobileAntiAir = readNumber(input);
+		frameEnemyGetsCloakedUnits = readNumber(input);
+		frameEnemyGetsStaticDetection = readNumber(input);
+		frameEnemyGetsMobileDetection = readNumber(input);
+		frameGameEnds = readNumber(input);
+
+		while (readGameSnapshot(input))
+		{
+		}
+	}
+	catch (const game_record_read_error &)
+	{
+		skipToEnd(input);      // end of the game record
+		valid = false;
+	}
+}
+
+// Read the fixed part of a record from a binary file. Leave the snapshots encoded.
+// Binary file format: See writeBinary().
+void GameRecord::readBinary(const unsigned char * data, size_t size)
+{
+	try
+	{
+		OpponentModelFile::Reader input(data, size);
+
+		ourRace = charRace(char(input.varint()));
+		enemyRace = charRace(char(input.varint()));
+		enemyIsRandom = input.varint() != 0;
+		if (ourRace == BWAPI::Races::Unknown)
+		{
+			throw game_record_read_error();
+		}
+
+		mapName = input.string();
+		openingName = input.string();
+		expectedEnemyPlan = OpeningPlanFromString(input.string());
+		enemyPlan = OpeningPlanFromString(input.string());
+		win = input.varint() != 0;
+		frameScoutSentForGasSteal = input.number();
+		gasStealHappened = input.varint() != 0;
+		frameEnemyScoutsOurBase = input.number();
+		frameEnemyGetsCombatUnits = input.number();
+		frameEnemyGetsAirUnits = input.number();
+		frameEnemyGetsStaticAntiAir = input.number();
+		frameEnemyGetsMobileAntiAir = input.number();
+		frameEnemyGetsCloakedUnits = input.number();
+		frameEnemyGetsStaticDetection = input.number();
+		frameEnemyGetsMobileDetection = input.number();
+		frameGameEnds = input.number();
+
+		nEncodedSnapshots = input.number();
+		encodedSnapshots = input.here();
+		encodedSnapshotsSize = input.remaining();
+	}
+	catch (const game_record_read_error &)
+	{
+		valid = false;
+	}
+}
+
+// Decode straight into the arena.
+static void readBinarySide(OpponentModelFile::Reader & input, Arena & arena, SnapshotSide & side, BWAPI::Race race)
+{
+	side.numBases = input.number();
+	side.race = race;
+	side.nTypes = input.number();
+
+	// Each unit type takes at least 2 bytes. Don't allocate much for a bad count.
+	if (size_t(side.nTypes) > input.remaining() / 2)
+	{
+		throw game_record_read_error();
+	}
+
+	short * types = arena.makeArray<short>(side.nTypes);
+	short * counts = arena.makeArray<short>(side.nTypes);
+	int id = 0;
+	for (int i = 0; i < side.nTypes; ++i)
+	{
+		id += input.number();
+		if (id > 0x7FFF)
+		{
+			throw game_record_read_error();
+		}
+		types[i] = short(id);
+		counts[i] = short(std::min(input.number(), 32767));
+	}
+	side.types = types;
+	side.counts = counts;
+
+	side.makeDense(arena);
+}
+
+// Decode the snapshots of a record read from a binary file, if not done yet.
+// If the data turns out to be bad, keep the snapshots read so far.
+void GameRecord::decodeSnapshots() const
+{
+	if (!encodedSnapshots)
+	{
+		return;
+	}
+
+	try
+	{
+		OpponentModelFile::Reader input(encodedSnapshots, encodedSnapshotsSize);
+
+		// All the snapshots in one piece, unless the count is bad. Each takes at least 5 bytes.
+		if (size_t(nEncodedSnapshots) <= input.remaining() / 5)
+		{
+			snapshotCapacity = nEncodedSnapshots;
+			snapshots = arena.makeArray<GameSnapshot>(snapshotCapacity);
+		}
+
+		int t = 0;
+		for (int i = 0; i < nEncodedSnapshots; ++i)
+		{
+			GameSnapshot snap;
+			t += input.number();
+			snap.frame = t;
+			readBinarySide(input, arena, snap.us, ourRace);
+			readBinarySide(input, arena, snap.them, enemyRace);
+			addSnapshot() = snap;
+		}
+	}
+	catch (const game_record_read_error &)
+	{
+	}
+
+	encodedSnapshots = nullptr;
+}
+
+void GameRecord::writePlayerSnapshot(std::ostream & output, const SnapshotSide & side)
+{
+	output << side.numBases;
+	for (int i = 0; i < side.nTypes; ++i)
+	{
+		output << ' ' << side.types[i] << ' ' << side.counts[i];
+	}
+	output << '\n';
+}
+
+void GameRecord::writeGameSnapshot(std::ostream & output, const GameSnapshot & snap)
+{
+	output << snap.frame << '\n';
+	writePlayerSnapshot(output, snap.us);
+	writePlayerSnapshot(output, snap.them);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Constructor for the record of a past game.
+GameRecord::GameRecord(Arena & a, std::istream & input)
+	: valid(true)                  // until proven otherwise
+	, savedRecord(true)
+	, ourRace(BWAPI::Races::Unknown)
+	, enemyRace(BWAPI::Races::Unknown)
+	, enemyIsRandom(false)
+	, expectedEnemyPlan(OpeningPlan::Unknown)
+	, enemyPlan(OpeningPlan::Unknown)
+	, win(false)                   // until proven otherwise
+	, frameScoutSentForGasSteal(0)
+	, gasStealHappened(false)
+	, frameEnemyScoutsOurBase(0)
+	, frameEnemyGetsCombatUnits(0)
+	, frameEnemyGetsAirUnits(0)
+	, frameEnemyGetsStaticAntiAir(0)
+	, frameEnemyGetsMobileAntiAir(0)
+	, frameEnemyGetsCloakedUnits(0)
+	, frameEnemyGetsStaticDetection(0)
+	, frameEnemyGetsMobileDetection(0)
+	, frameGameEnds(0)
+	, arena(a)
+	, snapshots(nullptr)
+	, nSnapshots(0)
+	, snapshotCapacity(0)
+	, encodedSnapshots(nullptr)
+	, encodedSnapshotsSize(0)
+	, nEncodedSnapshots(0)
+{
+	read(input);
+}
+
+// Constructor for the record of a past game, from a binary file.
+// The data must stay in place until the snapshots are decoded.
+GameRecord::GameRecord(Arena & a, const unsigned char * data, size_t size)
+	: valid(true)                  // until proven otherwise
+	, savedRecord(true)
+	, ourRace(BWAPI::Races::Unknown)
+	, enemyRace(BWAPI::Races::Unknown)
+	, enemyIsRandom(false)
+	, expectedEnemyPlan(OpeningPlan::Unknown)
+	, enemyPlan(OpeningPlan::Unknown)
+	, win(false)                   // until proven otherwise
+	, frameScoutSentForGasSteal(0)
+	, gasStealHappened(false)
+	, frameEnemyScoutsOurBase(0)
+	, frameEnemyGetsCombatUnits(0)
+	, frameEnemyGetsAirUnits(0)
+	, frameEnemyGetsStaticAntiAir(0)
+	, frameEnemyGetsMobileAntiAir(0)
+	, frameEnemyGetsCloakedUnits(0)
+	, frameEnemyGetsStaticDetection(0)
+	, frameEnemyGetsMobileDetection(0)
+	, frameGameEnds(0)
+	, arena(a)
+	, snapshots(nullptr)
+	, nSnapshots(0)
+	, snapshotCapacity(0)
+	, encodedSnapshots(nullptr)
+	, encodedSnapshotsSize(0)
+	, nEncodedSnapshots(0)
+{
+	readBinary(data, size);
+}
+
+// Write the game record to the given stream. File format:
+
+// 1.4 = file format version number
+// matchup (e.g. ZvP, ZvRP)
+// map
+// opening
+// expected enemy opening plan
+// actual enemy opening plan
+// result (1 or 0)
+// frame we dispatched a scout to steal gas (0 if no attempt)
+// gas steal happened (1 or 0)
+// frame enemy first scouts our base
+// frame enemy first gets combat units
+// frame enemy first gets air units
+// frame enemy first gets static anti-air
+// frame enemy first gets mobile anti-air
+// frame enemy first gets cloaked units
+// frame enemy first gets static detection
+// frame enemy first gets mobile detection
+// game duration in frames (0 if the game is not over yet)
+// snapshots
+// END GAME
+
+void GameRecord::write(std::ostream & output)
+{
+	output << fileFormatVersion << '\n';
+	output <<
+		RaceChar(ourRace) <<
+		'v' <<
+		(enemyIsRandom ? "R" : "") << RaceChar(enemyRace) << '\n';
+	output << mapName << '\n';
+	output << openingName << '\n';
+	output << OpeningPlanString(expectedEnemyPlan) << '\n';
+	output << OpeningPlanString(enemyPlan) << '\n';
+	output << (win ? '1' : '0') << '\n';
+	output << frameScoutSentForGasSteal << '\n';
+	output << (gasStealHappened ? '1' : '0') << '\n';
+	output << frameEnemyScoutsOurBase << '\n';
+	output << frameEnemyGetsCombatUnits << '\n';
+	output << frameEnemyGetsAirUnits << '\n';
+	output << frameEnemyGetsStaticAntiAir << '\n';
+	output << frameEnemyGetsMobileAntiAir << '\n';
+	output << frameEnemyGetsCloakedUnits << '\n';
+	output << frameEnemyGetsStaticDetection << '\n';
+	output << frameEnemyGetsMobileDetection << '\n';
+	output << frameGameEnds << '\n';
+
+	// TODO skip the snapshots for now
+	// for (const auto & snap : snapshots)
+	// {
+	// 	writeGameSnapshot(output, snap);
+	// }
+
+	output << gameEndMark << '\n';
+}
+
+// Encode the game record for the binary file. The fields are the same as in
+// the text format, in the same order, except that there is no version number
+// (the file has one) and the snapshots are included. Numbers are varints.
+
+// our race, enemy race (as race characters), enemy is random (1 or 0)
+// map, opening, expected and actual enemy opening plans (as strings)
+// result, gas steal frame, gas steal happened, the 8 enemy frames, game duration
+// number of snapshots, then for each snapshot:
+//   frames since the previous snapshot (or since the start)
+//   for us, then for the enemy:
+//     number of bases, number of unit types, then for each unit type
+//     in order: id minus the previous id, count
+
+static void writeBinarySide(std::string & output, const SnapshotSide & side)
+{
+	OpponentModelFile::PutNumber(output, side.numBases);
+	OpponentModelFile::PutNumber(output, side.nTypes);
+	int id = 0;
+	for (int i = 0; i < side.nTypes; ++i)
+	{
+		OpponentModelFile::PutNumber(output, side.types[i] - id);
+		OpponentModelFile::PutNumber(output, side.counts[i]);
+		id = side.types[i];
+	}
+}
+
+void GameRecord::writeBinary(std::string & output)
+{
+	OpponentModelFile::PutVarint(output, RaceChar(ourRace));
+	OpponentModelFile::PutVarint(output, RaceChar(enemyRace));
+	OpponentModelFile::PutVarint(output, enemyIsRandom ? 1 : 0);
+	OpponentModelFile::PutString(output, mapName);
+	OpponentModelFile::PutString(output, openingName);
+	OpponentModelFile::PutString(output, OpeningPlanString(expectedEnemyPlan));
+	OpponentModelFile::PutString(output, OpeningPlanString(enemyPlan));
+	OpponentModelFile::PutVarint(output, win ? 1 : 0);
+	OpponentModelFile::PutNumber(output, frameScoutSentForGasSteal);
+	OpponentModelFile::PutVarint(output, gasStealHappened ? 1 : 0);
+	OpponentModelFile::PutNumber(output, frameEnemyScoutsOurBase);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsCombatUnits);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsAirUnits);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsStaticAntiAir);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsMobileAntiAir);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsCloakedUnits);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsStaticDetection);
+	OpponentModelFile::PutNumber(output, frameEnemyGetsMobileDetection);
+	OpponentModelFile::PutNumber(output, frameGameEnds);
+
+	// Snapshots that were never decoded are copied as they are.
+	if (encodedSnapshots)
+	{
+		OpponentModelFile::PutNumber(output, nEncodedSnapshots);
+		output.append(reinterpret_cast<const char *>(encodedSnapshots), encodedSnapshotsSize);
+		return;
+	}
+
+	OpponentModelFile::PutNumber(output, nSnapshots);
+	int t = 0;
+	for (const GameSnapshot & snap : getSnapshots())
+	{
+		OpponentModelFile::PutNumber(output, snap.frame - t);
+		writeBinarySide(output, snap.us);
+		writeBinarySide(output, snap.them);
+		t = snap.frame;
+	}
+}
+
+int GameRecord::SnapshotBucket(int frame)
+{
+	return (frame - firstSnapshotTime + snapshotInterval / 2) / snapshotInterval;
+}
+
+SnapshotSpan GameRecord::getSnapshots() const
+{
+	decodeSnapshots();
+	SnapshotSpan span;
+	span.first = snapshots;
+	span.n = nSnapshots;
+	return span;
+}
+
+// The arena is about to be released. Forget the snapshots that are in it.
+void GameRecord::clearSnapshots()
+{
+	snapshots = nullptr;
+	nSnapshots = 0;
+	snapshotCapacity = 0;
+	encodedSnapshots = nullptr;
+}
+
+// The game records have the same matchup, as best we can tell so far.
+// For checks at the start of the game, when the enemy's race may be unknown, allow
+// a special case for random enemies.
+bool GameRecord::sameMatchup(const GameRecord & record) const
+{
+	return ourRace == record.ourRace &&
+		(enemyRace == record.enemyRace ||
+			enemyIsRandom && record.enemyIsRandom &&
+			(enemyRace == BWAPI::Races::Unknown || record.enemyRace == BWAPI::Races::Unknown)
+		);
+}
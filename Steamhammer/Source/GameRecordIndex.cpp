@@ -0,0 +1,163 @@
+#include "GameRecordIndex.h"
+
+using namespace UAlbertaBot;
+
+GameRecordIndex::GameRecordIndex(size_t nBest)
+	: k(nBest)
+{
+}
+
+GameRecordIndex::Matchup * GameRecordIndex::findMatchup(BWAPI::Race ourRace, BWAPI::Race enemyRace)
+{
+	for (Matchup & matchup : matchups)
+	{
+		if (matchup.ourRace == ourRace && matchup.enemyRace == enemyRace)
+		{
+			return &matchup;
+		}
+	}
+	return nullptr;
+}
+
+// Decode the snapshots of a few more of the matchup's records and put them into buckets.
+// Return true when all the records are done.
+bool GameRecordIndex::buildSome(Matchup & matchup)
+{
+	const size_t end = std::min(matchup.records.size(), matchup.nBuilt + BuildStep);
+	for (; matchup.nBuilt < end; ++matchup.nBuilt)
+	{
+		const GameRecord * record = matchup.records[matchup.nBuilt];
+		const SnapshotSpan snapshots = record->getSnapshots();
+
+		// A record with no snapshots conveys no info.
+		if (snapshots.empty())
+		{
+			continue;
+		}
+
+		const size_t c = matchup.candidates.size();
+		Candidate candidate;
+		candidate.record = record;
+		candidate.distance = 0;
+		candidate.ended = false;
+		matchup.candidates.push_back(candidate);
+
+		for (const GameSnapshot & snap : snapshots)
+		{
+			const int bucket = GameRecord::SnapshotBucket(snap.frame);
+			if (bucket < 0)
+			{
+				continue;
+			}
+			if (size_t(bucket) >= matchup.byBucket.size())
+			{
+				matchup.byBucket.resize(bucket + 1);
+			}
+			matchup.byBucket[bucket].resize(c + 1, nullptr);
+			matchup.byBucket[bucket][c] = &snap;
+		}
+	}
+
+	// Make every bucket a full row.
+	for (std::vector<const GameSnapshot *> & row : matchup.byBucket)
+	{
+		row.resize(matchup.candidates.size(), nullptr);
+	}
+
+	return matchup.nBuilt == matchup.records.size();
+}
+
+// Compare a new snapshot of the current game with the past snapshots from the same time.
+// Differences in enemy play count 5 times more than differences in our play, as in GameRecord::distance().
+void GameRecordIndex::compare(Matchup & matchup, const GameSnapshot & snap)
+{
+	const int bucket = GameRecord::SnapshotBucket(snap.frame);
+	static const std::vector<const GameSnapshot *> none;
+	const std::vector<const GameSnapshot *> & row =
+		bucket >= 0 && size_t(bucket) < matchup.byBucket.size() ? matchup.byBucket[bucket] : none;
+
+	for (size_t c = 0; c < matchup.candidates.size(); ++c)
+	{
+		Candidate & candidate = matchup.candidates[c];
+		if (candidate.ended)
+		{
+			continue;
+		}
+
+		const GameSnapshot * there = c < row.size() ? row[c] : nullptr;
+		if (!there)
+		{
+			candidate.ended = true;
+			continue;
+		}
+
+		candidate.distance +=     SnapshotSide::Distance(snap.us,   there->us);
+		candidate.distance += 5 * SnapshotSide::Distance(snap.them, there->them);
+	}
+}
+
+void GameRecordIndex::clear()
+{
+	matchups.clear();
+	best.clear();
+}
+
+void GameRecordIndex::add(const GameRecord * record)
+{
+	Matchup * matchup = findMatchup(record->getOurRace(), record->getEnemyRace());
+	if (!matchup)
+	{
+		Matchup m;
+		m.ourRace = record->getOurRace();
+		m.enemyRace = record->getEnemyRace();
+		m.nBuilt = 0;
+		m.compared = 0;
+		matchups.push_back(m);
+		matchup = &matchups.back();
+	}
+	matchup->records.push_back(record);
+}
+
+// The enemy race may become known partway through the game. The matchup that it
+// selects then catches up with all the snapshots so far.
+void GameRecordIndex::update(const GameRecord & game)
+{
+	best.clear();
+
+	Matchup * matchup = findMatchup(game.getOurRace(), game.getEnemyRace());
+	const SnapshotSpan snapshots = game.getSnapshots();
+	if (!matchup || snapshots.empty())
+	{
+		return;
+	}
+
+	if (matchup->nBuilt < matchup->records.size() && !buildSome(*matchup))
+	{
+		return;
+	}
+	for (; matchup->compared < snapshots.size(); ++matchup->compared)
+	{
+		compare(*matchup, snapshots[matchup->compared]);
+	}
+
+	// The map and opening count the same as in GameRecord::distance().
+	for (const Candidate & candidate : matchup->candidates)
+	{
+		if (!candidate.ended)
+		{
+			Match match;
+			match.record = candidate.record;
+			match.distance = candidate.distance +
+				(candidate.record->getMapName() != game.getMapName() ? 20 : 0) +
+				(candidate.record->getOpeningName() != game.getOpeningName() ? 200 : 0);
+			best.push_back(match);
+		}
+	}
+
+	const size_t n = std::min(k, best.size());
+	std::partial_sort(best.begin(), best.begin() + n, best.end(), [](const Match & a, const Match & b)
+	{
+		return a.distance < b.distance;
+	});
+	best.resize(n);
+}
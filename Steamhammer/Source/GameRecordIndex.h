@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include "GameRecord.h"
+
+// Find the past games that best match the current game so far.
+
+// Past game records are grouped by matchup. Within a matchup, the snapshots are
+// indexed by time bucket, so that each new snapshot of the current game is compared
+// only with the past snapshots taken at the same time. Each past game keeps a running
+// distance, so the work per snapshot is one comparison per past game in the matchup.
+// A past game that ended before the current game drops out.
+
+// Decoding the snapshots is the slow part. A matchup's records are decoded when the
+// matchup first comes up, a few records per update() so that no one frame does it all.
+// Until they are all done, update() finds no matches.
+// The index points into the records; clear() it before they are released.
+
+namespace UAlbertaBot
+{
+class GameRecordIndex
+{
+public:
+	struct Match
+	{
+		const GameRecord *	record;
+		int					distance;
+	};
+
+private:
+	struct Candidate
+	{
+		const GameRecord *	record;
+		int					distance;		// snapshot distance summed over the buckets compared
+		bool				ended;			// it has no snapshot for some bucket compared
+	};
+
+	struct Matchup
+	{
+		BWAPI::Race								ourRace;
+		BWAPI::Race								enemyRace;
+		std::vector<const GameRecord *>			records;
+		size_t									nBuilt;			// records decoded so far
+		std::vector<Candidate>					candidates;
+		std::vector< std::vector<const GameSnapshot *> > byBucket;	// [bucket][candidate], null if none
+		int										compared;		// snapshots of the current game compared so far
+	};
+
+	static const size_t BuildStep = 4;		// records to decode per update()
+
+	size_t					k;
+	std::vector<Matchup>	matchups;
+	std::vector<Match>		best;
+
+	Matchup *	findMatchup(BWAPI::Race ourRace, BWAPI::Race enemyRace);
+	bool		buildSome(Matchup & matchup);
+	void		compare(Matchup & matchup, const GameSnapshot & snap);
+
+public:
+	GameRecordIndex(size_t nBest);
+
+	void add(const GameRecord * record);
+	void clear();
+
+	// Catch up with any new snapshots of the current game, and rank the past games.
+	void update(const GameRecord & game);
+
+	// The best matches, best first. At most k of them.
+	const std::vector<Match> & getBestMatches() const { return best; };
+	const GameRecord * getBestMatch() const { return best.empty() ? nullptr : best.front().record; };
+};
+}
@@ -8,7 +8,7 @@
 
 using namespace UAlbertaBot;
 
-void Gridattacks::computeAir(const std::map<BWAPI::Unit, UnitInfo> & unitsInfo)
+void Gridattacks::computeAir(const UIMap & unitsInfo)
 {
 	for (const auto & kv : unitsInfo)
 	{
@@ -35,7 +35,7 @@ void Gridattacks::computeAir(const std::map<BWAPI::Unit, UnitInfo> & unitsInfo)
 	}
 }
 
-void Gridattacks::computeGround(const std::map<BWAPI::Unit, UnitInfo> & unitsInfo)
+void Gridattacks::computeGround(const UIMap & unitsInfo)
 {
 	for (const auto & kv : unitsInfo)
 	{
@@ -71,7 +71,7 @@ Gridattacks::Gridattacks()
 Gridattacks::Gridattacks(BWAPI::Player player, bool air)
 	: Grid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), 0)
 {
-	const std::map<BWAPI::Unit, UnitInfo> & unitsInfo = InformationManager::Instance().getUnitData(player).getUnits();
+	const UIMap & unitsInfo = InformationManager::Instance().getUnitData(player).getUnits();
 	if (air)
 	{
 		computeAir(unitsInfo);
@@ -12,8 +12,8 @@ namespace UAlbertaBot
 {
 class Gridattacks : public Grid
 {
-	void computeAir(const std::map<BWAPI::Unit, UnitInfo> & unitsInfo);
-	void computeGround(const std::map<BWAPI::Unit, UnitInfo> & unitsInfo);
+	void computeAir(const UIMap & unitsInfo);
+	void computeGround(const UIMap & unitsInfo);
 
 public:
 	Gridattacks();
@@ -1,6 +1,7 @@
 #include "GridDistances.h"
 
 #include "MapTools.h"
+#include "Profiler.h"
 
 using namespace UAlbertaBot;
 
@@ -51,6 +52,8 @@ const std::vector<BWAPI::TilePosition> & GridDistances::getSortedTiles() const
 // Uses BFS, since the map is quite large and DFS may cause a stack overflow
 void GridDistances::compute(const BWAPI::TilePosition & start, int limit, bool neutralBlocks)
 {
+	ProfileScope profile("Grid distances");
+
 	const size_t LegalActions = 4;
 	const int actionX[LegalActions] = { 1, -1, 0, 0 };
 	const int actionY[LegalActions] = { 0, 0, 1, -1 };
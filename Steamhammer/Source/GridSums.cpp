@@ -0,0 +1,108 @@
+#include "GridSums.h"
+
+#include <algorithm>
+#include "UABAssert.h"
+
+using namespace UAlbertaBot;
+
+// Create an empty grid.
+// Necessary if the owner is created before BWAPI is initialized.
+GridSums::GridSums()
+	: width(0)
+	, height(0)
+	, dirtyX(0)
+	, dirtyY(0)
+{
+}
+
+// Create a grid of the given size with all values 0.
+GridSums::GridSums(int w, int h)
+	: width(w)
+	, height(h)
+	, values(w * h, 0)
+	, sums((w + 1) * (h + 1), 0)
+	, dirtyX(w)
+	, dirtyY(h)
+{
+}
+
+void GridSums::markDirty(int x, int y)
+{
+	dirtyX = std::min(dirtyX, x);
+	dirtyY = std::min(dirtyY, y);
+}
+
+// Recompute the stale sums, and only those.
+// Sums outside the stale rectangle are still correct and are used as the base.
+void GridSums::refresh() const
+{
+	if (dirtyX >= width || dirtyY >= height)
+	{
+		dirtyX = width;
+		dirtyY = height;
+		return;
+	}
+
+	for (int x = dirtyX + 1; x <= width; ++x)
+	{
+		for (int y = dirtyY + 1; y <= height; ++y)
+		{
+			sums[sumIndex(x, y)] =
+				values[valueIndex(x - 1, y - 1)] +
+				sums[sumIndex(x - 1, y)] +
+				sums[sumIndex(x, y - 1)] -
+				sums[sumIndex(x - 1, y - 1)];
+		}
+	}
+
+	dirtyX = width;
+	dirtyY = height;
+}
+
+int GridSums::at(int x, int y) const
+{
+	UAB_ASSERT(x >= 0 && y >= 0 && x < width && y < height, "bad tile %d,%d", x, y);
+	return values[valueIndex(x, y)];
+}
+
+void GridSums::set(int x, int y, int value)
+{
+	UAB_ASSERT(x >= 0 && y >= 0 && x < width && y < height, "bad tile %d,%d", x, y);
+	int & v = values[valueIndex(x, y)];
+	if (v != value)
+	{
+		v = value;
+		markDirty(x, y);
+	}
+}
+
+void GridSums::add(int x, int y, int delta)
+{
+	UAB_ASSERT(x >= 0 && y >= 0 && x < width && y < height, "bad tile %d,%d", x, y);
+	if (delta != 0)
+	{
+		values[valueIndex(x, y)] += delta;
+		markDirty(x, y);
+	}
+}
+
+int GridSums::sum(int left, int top, int right, int bottom) const
+{
+	left = std::max(left, 0);
+	top = std::max(top, 0);
+	right = std::min(right, width);
+	bottom = std::min(bottom, height);
+
+	if (left >= right || top >= bottom)
+	{
+		return 0;
+	}
+
+	refresh();
+
+	return
+		sums[sumIndex(right, bottom)] -
+		sums[sumIndex(left, bottom)] -
+		sums[sumIndex(right, top)] +
+		sums[sumIndex(left, top)];
+}
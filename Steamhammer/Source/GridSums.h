@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+// A summed-area table (integral image) over the tiles of a grid.
+// Store a small integer per tile, then ask for the sum over any rectangle of tiles
+// in constant time: 4 lookups. Used for questions like "is any tile in this box
+// unbuildable or reserved?"
+
+// Changing a tile value makes the sums stale below and to the right of the tile.
+// The stale part is recomputed lazily, once, on the next query. Many changes
+// in a row (reserving a whole building footprint) cost one partial recomputation.
+
+namespace UAlbertaBot
+{
+class GridSums
+{
+	int width;
+	int height;
+
+	std::vector<int> values;			// width x height, the value of each tile
+	mutable std::vector<int> sums;		// (width+1) x (height+1), sums[x][y] = sum of values left of x and above y
+
+	// The sums are stale for x > dirtyX and y > dirtyY.
+	// dirtyX == width means the sums are all up to date.
+	mutable int dirtyX;
+	mutable int dirtyY;
+
+	int valueIndex(int x, int y) const { return x * height + y; };
+	int sumIndex(int x, int y) const { return x * (height + 1) + y; };
+
+	void markDirty(int x, int y);
+	void refresh() const;
+
+public:
+	GridSums();
+	GridSums(int w, int h);
+
+	int at(int x, int y) const;
+	void set(int x, int y, int value);
+	void add(int x, int y, int delta);
+
+	// Sum over the tiles left <= x < right, top <= y < bottom.
+	// The rectangle is clipped to the grid.
+	int sum(int left, int top, int right, int bottom) const;
+	bool any(int left, int top, int right, int bottom) const { return sum(left, top, right, bottom) != 0; };
+};
+}
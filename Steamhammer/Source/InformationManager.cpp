@@ -4,29 +4,31 @@
 #include "MapTools.h"
 #include "ProductionManager.h"
 #include "Random.h"
+#include "The.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
 
 InformationManager::InformationManager()
-    : _self(BWAPI::Broodwar->self())
+    : the(The::Root())
+    , _self(BWAPI::Broodwar->self())
     , _enemy(BWAPI::Broodwar->enemy())
 	, _enemyProxy(false)
 	
 	, _weHaveCombatUnits(false)
-	, _enemyHasCombatUnits(false)
-	, _enemyHasStaticAntiAir(false)
-	, _enemyHasAntiAir(false)
-	, _enemyHasAirTech(false)
-	, _enemyHasCloakTech(false)
-	, _enemyCloakedUnitsSeen(false)
-	, _enemyHasMobileCloakTech(false)
-	, _enemyHasOverlordHunters(false)
-	, _enemyHasStaticDetection(false)
-	, _enemyHasMobileDetection(_enemy->getRace() == BWAPI::Races::Zerg)
+	, _enemyCapabilities(0)
+	, _nextCapabilityToken(1)
 {
+	if (_enemy->getRace() == BWAPI::Races::Zerg)
+	{
+		setEnemyCapability(EnemyMobileDetection);
+	}
+
 	initializeTheBases();
 	initializeRegionInformation();
+
+	// We don't need to check often. See updateGoneFromLastPosition().
+	the.scheduler.add("Gone units", 32, FrameScheduler::Low, 0.1, [this]() { updateGoneFromLastPosition(); });
 }
 
 // This fills in _theBases with neutral bases. An event will place our resourceDepot.
@@ -205,7 +207,6 @@ void InformationManager::update()
 	updateUnitInfo();
 	updateBaseLocationInfo();
 	updateTheBases();
-	updateGoneFromLastPosition();
 }
 
 void InformationManager::updateUnitInfo() 
@@ -471,11 +472,8 @@ void InformationManager::updateGoneFromLastPosition()
 	// 1. The game supposedly only resets visible tiles when frame % 100 == 99.
 	// 2. If the unit has only been gone from its location for a short time, it probably
 	//    didn't go far (it might have been recalled or gone through a nydus).
-	// So we check less than once per second.
-	if (BWAPI::Broodwar->getFrameCount() % 32 == 5)
-	{
-		_unitData[_enemy].updateGoneFromLastPosition();
-	}
+	// So we check less than once per second. It runs as a scheduled task.
+	_unitData[_enemy].updateGoneFromLastPosition();
 }
 
 bool InformationManager::isEnemyBuildingInRegion(BWTA::Region * region) 
@@ -533,11 +531,12 @@ int InformationManager::getAir2GroundSupply(BWAPI::Player player) const
 {
 	int supply = 0;
 
-	for (const auto & kv : getUnitData(player).getUnits())
+	const UnitData & unitData = getUnitData(player);
+	for (const BWAPI::Unit unit : unitData.getUnits(UnitData::FlyerCategory))
 	{
-		const UnitInfo & ui(kv.second);
+		const UnitInfo & ui(*unitData.getUnitInfo(unit));
 
-		if (ui.type.isFlyer() && UnitUtil::TypeCanAttackGround(ui.type))
+		if (UnitUtil::TypeCanAttackGround(ui.type))
 		{
 			supply += ui.type.supplyRequired();
 		}
@@ -769,6 +768,11 @@ void InformationManager::updateUnit(BWAPI::Unit unit)
     {
 		_unitData[unit->getPlayer()].updateUnit(unit);
 	}
+
+	if (unit->getPlayer() == _enemy)
+	{
+		updateEnemyCapabilities(unit);
+	}
 }
 
 void InformationManager::onUnitDestroy(BWAPI::Unit unit) 
@@ -799,14 +803,17 @@ void InformationManager::onUnitDestroy(BWAPI::Unit unit)
 // Only returns units believed to be completed.
 void InformationManager::getNearbyForce(std::vector<UnitInfo> & unitInfo, BWAPI::Position p, BWAPI::Player player, int radius) 
 {
-	// for each unit we know about for that player
-	for (const auto & kv : getUnitData(player).getUnits())
+	const UnitData & unitData = getUnitData(player);
+
+	// for each combat unit we know about for that player which might be in range
+	std::vector<BWAPI::Unit> candidates;
+	unitData.getUnitsInRadius(candidates, p, radius + std::max(64, unitData.getMaxCombatSimRange() + 32), UnitData::CombatSimCategory);
+	for (const BWAPI::Unit unit : candidates)
 	{
-		const UnitInfo & ui(kv.second);
+		const UnitInfo & ui(*unitData.getUnitInfo(unit));
 
-		// if it's a combat unit we care about
-		// and it's finished! 
-		if (UnitUtil::IsCombatSimUnit(ui.type) && ui.completed && !ui.goneFromLastPosition)
+		// if it's finished! 
+		if (ui.completed && !ui.goneFromLastPosition)
 		{
 			if (ui.type == BWAPI::UnitTypes::Terran_Medic)
 			{
@@ -903,104 +910,211 @@ bool InformationManager::weHaveCombatUnits()
 	return false;
 }
 
-// Enemy has complated combat units (excluding workers).
-bool InformationManager::enemyHasCombatUnits()
+// Latch an enemy capability, and tell the subscribers if it is news.
+void InformationManager::setEnemyCapability(EnemyCapability capability)
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasCombatUnits)
+	if (hasEnemyCapability(capability))
 	{
-		return true;
+		return;
 	}
 
-	for (const auto & kv : getUnitData(_enemy).getUnits())
+	_enemyCapabilities |= 1 << capability;
+
+	// A subscriber may unsubscribe from its callback, so call from a copy of the list.
+	const std::vector< std::pair<int, CapabilityCallback> > subscribers(_capabilitySubscribers);
+	for (const std::pair<int, CapabilityCallback> & subscriber : subscribers)
 	{
-		const UnitInfo & ui(kv.second);
+		subscriber.second(capability);
+	}
+}
+
+int InformationManager::subscribeEnemyCapability(const CapabilityCallback & callback)
+{
+	const int token = _nextCapabilityToken++;
+	_capabilitySubscribers.push_back(std::make_pair(token, callback));
+	return token;
+}
 
-		if (!ui.type.isWorker() &&
-			!ui.type.isBuilding() &&
-			ui.completed &&
-			ui.type != BWAPI::UnitTypes::Zerg_Larva &&
-			ui.type != BWAPI::UnitTypes::Zerg_Overlord)
+void InformationManager::unsubscribeEnemyCapability(int token)
+{
+	for (auto it = _capabilitySubscribers.begin(); it != _capabilitySubscribers.end(); ++it)
+	{
+		if (it->first == token)
 		{
-			_enemyHasCombatUnits = true;
-			return true;
+			_capabilitySubscribers.erase(it);
+			return;
 		}
 	}
-
-	return false;
 }
 
-// Enemy has spore colonies, photon cannons, or turrets.
-bool InformationManager::enemyHasStaticAntiAir()
+// An enemy unit was seen, created, morphed, completed, or is still in view.
+// Latch whatever it tells us about the enemy's capabilities.
+// This is the only place the capabilities are worked out, so the queries below are cheap.
+void InformationManager::updateEnemyCapabilities(BWAPI::Unit unit)
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasStaticAntiAir)
+	const BWAPI::UnitType type = unit->getType();
+
+	// Enemy has completed combat units (excluding workers).
+	if (!type.isWorker() &&
+		!type.isBuilding() &&
+		unit->isCompleted() &&
+		type != BWAPI::UnitTypes::Zerg_Larva &&
+		type != BWAPI::UnitTypes::Zerg_Overlord)
 	{
-		return true;
+		setEnemyCapability(EnemyCombatUnits);
 	}
 
-	for (const auto & kv : getUnitData(_enemy).getUnits())
+	// Enemy has spore colonies, photon cannons, or turrets.
+	// They also detect.
+	if (type == BWAPI::UnitTypes::Terran_Missile_Turret ||
+		type == BWAPI::UnitTypes::Protoss_Photon_Cannon ||
+		type == BWAPI::UnitTypes::Zerg_Spore_Colony)
 	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type == BWAPI::UnitTypes::Terran_Missile_Turret ||
-			ui.type == BWAPI::UnitTypes::Protoss_Photon_Cannon ||
-			ui.type == BWAPI::UnitTypes::Zerg_Spore_Colony)
-		{
-			_enemyHasStaticAntiAir = true;
-			return true;
-		}
+		setEnemyCapability(EnemyStaticAntiAir);
+		setEnemyCapability(EnemyStaticDetection);
 	}
 
-	return false;
-}
+	// Enemy has mobile units that can shoot up, or the tech to produce them.
+	if (
+		// For terran, anything other than SCV, command center, depot is a hit.
+		// Surely nobody makes ebay before barracks!
+		(type.getRace() == BWAPI::Races::Terran &&
+		type != BWAPI::UnitTypes::Terran_SCV &&
+		type != BWAPI::UnitTypes::Terran_Command_Center &&
+		type != BWAPI::UnitTypes::Terran_Supply_Depot)
+
+		||
+
+		// Otherwise, any mobile unit that has an air weapon.
+		(!type.isBuilding() && UnitUtil::TypeCanAttackAir(type))
+
+		||
+
+		// Or a building for making such a unit.
+		// The cyber core only counts once it is finished, other buildings earlier.
+		type == BWAPI::UnitTypes::Protoss_Cybernetics_Core && unit->isCompleted() ||
+		type == BWAPI::UnitTypes::Protoss_Stargate ||
+		type == BWAPI::UnitTypes::Protoss_Fleet_Beacon ||
+		type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
+		type == BWAPI::UnitTypes::Zerg_Hydralisk_Den ||
+		type == BWAPI::UnitTypes::Zerg_Spire ||
+		type == BWAPI::UnitTypes::Zerg_Greater_Spire
+
+		)
+	{
+		setEnemyCapability(EnemyAntiAir);
+	}
 
-// Enemy has mobile units that can shoot up, or the tech to produce them.
-bool InformationManager::enemyHasAntiAir()
-{
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasAntiAir)
+	// Enemy has air units or air-producing tech.
+	if ((type.isFlyer() && type != BWAPI::UnitTypes::Zerg_Overlord) ||
+		type == BWAPI::UnitTypes::Terran_Starport ||
+		type == BWAPI::UnitTypes::Terran_Control_Tower ||
+		type == BWAPI::UnitTypes::Terran_Science_Facility ||
+		type == BWAPI::UnitTypes::Terran_Covert_Ops ||
+		type == BWAPI::UnitTypes::Terran_Physics_Lab ||
+		type == BWAPI::UnitTypes::Protoss_Stargate ||
+		type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
+		type == BWAPI::UnitTypes::Protoss_Fleet_Beacon ||
+		type == BWAPI::UnitTypes::Protoss_Robotics_Facility ||
+		type == BWAPI::UnitTypes::Protoss_Robotics_Support_Bay ||
+		type == BWAPI::UnitTypes::Protoss_Observatory ||
+		type == BWAPI::UnitTypes::Zerg_Spire ||
+		type == BWAPI::UnitTypes::Zerg_Greater_Spire)
 	{
-		return true;
+		setEnemyCapability(EnemyAirTech);
 	}
 
-	for (const auto & kv : getUnitData(_enemy).getUnits())
+	// Cloaked units actually spotted. Set all the cloak flags.
+	if (unit->isVisible() && !unit->isDetected())
 	{
-		const UnitInfo & ui(kv.second);
+		setEnemyCapability(EnemyCloakTech);
+		setEnemyCapability(EnemyCloakedUnitsSeen);
+		setEnemyCapability(EnemyMobileCloakTech);
+	}
 
-		if (
-			// For terran, anything other than SCV, command center, depot is a hit.
-			// Surely nobody makes ebay before barracks!
-			(_enemy->getRace() == BWAPI::Races::Terran &&
-			ui.type != BWAPI::UnitTypes::Terran_SCV &&
-			ui.type != BWAPI::UnitTypes::Terran_Command_Center &&
-			ui.type != BWAPI::UnitTypes::Terran_Supply_Depot)
+	// Cloaked units, or units that can cloak. Set all the cloak flags.
+	if (type.isCloakable() ||                                    // wraith, ghost
+		type == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine ||
+		type == BWAPI::UnitTypes::Protoss_Arbiter ||
+		type == BWAPI::UnitTypes::Zerg_Lurker ||
+		type == BWAPI::UnitTypes::Zerg_Lurker_Egg ||
+		unit->isBurrowed())
+	{
+		setEnemyCapability(EnemyCloakTech);
+		setEnemyCapability(EnemyCloakedUnitsSeen);
+		setEnemyCapability(EnemyMobileCloakTech);
+	}
 
-			||
+	// Mobile cloak tech, which we need detection to live with.
+	if (type == BWAPI::UnitTypes::Protoss_Dark_Templar ||
+		type == BWAPI::UnitTypes::Protoss_Citadel_of_Adun ||    // assume DT
+		type == BWAPI::UnitTypes::Protoss_Templar_Archives ||   // assume DT
+		type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal)
+	{
+		setEnemyCapability(EnemyCloakTech);
+		setEnemyCapability(EnemyMobileCloakTech);
+	}
 
-			// Otherwise, any mobile unit that has an air weapon.
-			(!ui.type.isBuilding() && UnitUtil::TypeCanAttackAir(ui.type))
+	// Other cloak tech.
+	if (type.hasPermanentCloak() ||                             // DT, observer
+		type == BWAPI::UnitTypes::Protoss_Observatory)
+	{
+		setEnemyCapability(EnemyCloakTech);
+	}
 
-			||
+	// Enemy has air units good for hunting down overlords.
+	// A stargate counts, but not a fleet beacon or arbiter tribunal.
+	// A starport does not count; it may well be for something else.
+	if (type == BWAPI::UnitTypes::Terran_Wraith ||
+		type == BWAPI::UnitTypes::Terran_Valkyrie ||
+		type == BWAPI::UnitTypes::Terran_Battlecruiser ||
+		type == BWAPI::UnitTypes::Protoss_Corsair ||
+		type == BWAPI::UnitTypes::Protoss_Scout ||
+		type == BWAPI::UnitTypes::Protoss_Carrier ||
+		type == BWAPI::UnitTypes::Protoss_Stargate ||
+		type == BWAPI::UnitTypes::Zerg_Spire ||
+		type == BWAPI::UnitTypes::Zerg_Greater_Spire ||
+		type == BWAPI::UnitTypes::Zerg_Mutalisk ||
+		type == BWAPI::UnitTypes::Zerg_Scourge)
+	{
+		setEnemyCapability(EnemyOverlordHunters);
+		setEnemyCapability(EnemyAirTech);
+	}
 
-			// Or a building for making such a unit.
-            // The cyber core only counts once it is finished, other buildings earlier.
-			ui.type == BWAPI::UnitTypes::Protoss_Cybernetics_Core && ui.completed ||
-			ui.type == BWAPI::UnitTypes::Protoss_Stargate ||
-			ui.type == BWAPI::UnitTypes::Protoss_Fleet_Beacon ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
-			ui.type == BWAPI::UnitTypes::Zerg_Hydralisk_Den ||
-			ui.type == BWAPI::UnitTypes::Zerg_Spire ||
-			ui.type == BWAPI::UnitTypes::Zerg_Greater_Spire
+	// Spider mines are static detection too.
+	if (type == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine)
+	{
+		setEnemyCapability(EnemyStaticDetection);
+	}
 
-			)
-		{
-			_enemyHasAntiAir = true;
-			return true;
-		}
+	// Enemy has overlords, observers, comsat, or science vessels.
+	if (type.getRace() == BWAPI::Races::Zerg ||
+		type == BWAPI::UnitTypes::Terran_Comsat_Station ||
+		type == BWAPI::UnitTypes::Terran_Science_Facility ||
+		type == BWAPI::UnitTypes::Terran_Science_Vessel ||
+		type == BWAPI::UnitTypes::Protoss_Observatory ||
+		type == BWAPI::UnitTypes::Protoss_Observer)
+	{
+		setEnemyCapability(EnemyMobileDetection);
 	}
+}
 
-	return false;
+// Enemy has complated combat units (excluding workers).
+bool InformationManager::enemyHasCombatUnits()
+{
+	return hasEnemyCapability(EnemyCombatUnits);
+}
+
+// Enemy has spore colonies, photon cannons, or turrets.
+bool InformationManager::enemyHasStaticAntiAir()
+{
+	return hasEnemyCapability(EnemyStaticAntiAir);
+}
+
+// Enemy has mobile units that can shoot up, or the tech to produce them.
+bool InformationManager::enemyHasAntiAir()
+{
+	return hasEnemyCapability(EnemyAntiAir);
 }
 
 // Enemy has air units or air-producing tech.
@@ -1010,216 +1124,41 @@ bool InformationManager::enemyHasAntiAir()
 // Protoss robo fac and terran starport are taken to imply air units.
 bool InformationManager::enemyHasAirTech()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasAirTech)
-	{
-		return true;
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if ((ui.type.isFlyer() && ui.type != BWAPI::UnitTypes::Zerg_Overlord) ||
-			ui.type == BWAPI::UnitTypes::Terran_Starport ||
-			ui.type == BWAPI::UnitTypes::Terran_Control_Tower ||
-			ui.type == BWAPI::UnitTypes::Terran_Science_Facility ||
-			ui.type == BWAPI::UnitTypes::Terran_Covert_Ops ||
-			ui.type == BWAPI::UnitTypes::Terran_Physics_Lab ||
-			ui.type == BWAPI::UnitTypes::Protoss_Stargate ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
-			ui.type == BWAPI::UnitTypes::Protoss_Fleet_Beacon ||
-			ui.type == BWAPI::UnitTypes::Protoss_Robotics_Facility ||
-			ui.type == BWAPI::UnitTypes::Protoss_Robotics_Support_Bay ||
-			ui.type == BWAPI::UnitTypes::Protoss_Observatory ||
-			ui.type == BWAPI::UnitTypes::Zerg_Spire ||
-			ui.type == BWAPI::UnitTypes::Zerg_Greater_Spire)
-		{
-			_enemyHasAirTech = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyAirTech);
 }
 
 // This test is good for "can I benefit from detection?"
-// NOTE The enemySeenBurrowing() call also sets _enemyHasCloakTech .
+// NOTE The enemySeenBurrowing() call also sets EnemyCloakTech.
 bool InformationManager::enemyHasCloakTech()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasCloakTech)
-	{
-		return true;
-	}
-
-	for (BWAPI::Unit unit : BWAPI::Broodwar->enemy()->getUnits())
-	{
-		if (unit->isVisible() && !unit->isDetected())
-		{
-			// NOTE Cloaked units were actually spotted. Set all the flags.
-			_enemyHasCloakTech = true;
-			_enemyCloakedUnitsSeen = true;
-			_enemyHasMobileCloakTech = true;
-			return true;
-		}
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type.hasPermanentCloak() ||                             // DT, observer
-			ui.type.isCloakable() ||                                   // wraith, ghost
-			ui.type == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine ||
-			ui.type == BWAPI::UnitTypes::Protoss_Citadel_of_Adun ||    // assume DT
-			ui.type == BWAPI::UnitTypes::Protoss_Templar_Archives ||   // assume DT
-			ui.type == BWAPI::UnitTypes::Protoss_Observatory ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker_Egg ||
-			ui.unit->isBurrowed())
-		{
-			_enemyHasCloakTech = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyCloakTech);
 }
 
 // This test means more "can I be SURE that I will benefit from detection?"
 // It only counts actual cloaked units, not merely the tech for them.
-// NOTE The enemySeenBurrowing() call also sets _enemyCloakedUnitsSeen.
-// NOTE If they have cloaked units, they have cloak tech. Set all appropriate flags.
+// NOTE The enemySeenBurrowing() call also sets EnemyCloakedUnitsSeen.
 bool InformationManager::enemyCloakedUnitsSeen()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyCloakedUnitsSeen)
-	{
-		return true;
-	}
-
-	// NOTE This notices observers, which we might not want to notice here.
-	for (BWAPI::Unit unit : BWAPI::Broodwar->enemy()->getUnits())
-	{
-		if (unit->isVisible() && !unit->isDetected())
-		{
-			// NOTE Cloaked units were actually spotted. Set all the flags.
-			_enemyHasCloakTech = true;
-			_enemyCloakedUnitsSeen = true;
-			_enemyHasMobileCloakTech = true;
-			return true;
-		}
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type.isCloakable() ||                                    // wraith, ghost
-			ui.type == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker_Egg ||
-			ui.unit->isBurrowed())
-		{
-			_enemyHasCloakTech = true;
-			_enemyCloakedUnitsSeen = true;
-			_enemyHasMobileCloakTech = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyCloakedUnitsSeen);
 }
 
 // This test is better for "do I need detection to live?"
 // It doesn't worry about spider mines, observers, or burrowed units except lurkers.
-// NOTE If they have cloaked units, they have cloak tech. Set all appropriate flags.
 bool InformationManager::enemyHasMobileCloakTech()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasMobileCloakTech)
-	{
-		return true;
-	}
-
-	for (BWAPI::Unit unit : BWAPI::Broodwar->enemy()->getUnits())
-	{
-		if (unit->isVisible() && !unit->isDetected())
-		{
-			// NOTE Cloaked units were actually spotted. Set all the flags.
-			_enemyHasCloakTech = true;
-			_enemyCloakedUnitsSeen = true;
-			_enemyHasMobileCloakTech = true;
-			return true;
-		}
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type.isCloakable() ||                                   // wraith, ghost
-			ui.type == BWAPI::UnitTypes::Protoss_Dark_Templar ||
-			ui.type == BWAPI::UnitTypes::Protoss_Citadel_of_Adun ||    // assume DT
-			ui.type == BWAPI::UnitTypes::Protoss_Templar_Archives ||   // assume DT
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter_Tribunal ||
-			ui.type == BWAPI::UnitTypes::Protoss_Arbiter ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker ||
-			ui.type == BWAPI::UnitTypes::Zerg_Lurker_Egg)
-		{
-			_enemyHasCloakTech = true;
-			_enemyHasMobileCloakTech = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyMobileCloakTech);
 }
 
 // Enemy has air units good for hunting down overlords.
-// A stargate counts, but not a fleet beacon or arbiter tribunal.
-// A starport does not count; it may well be for something else.
 bool InformationManager::enemyHasOverlordHunters()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasOverlordHunters)
-	{
-		return true;
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type == BWAPI::UnitTypes::Terran_Wraith ||
-			ui.type == BWAPI::UnitTypes::Terran_Valkyrie ||
-			ui.type == BWAPI::UnitTypes::Terran_Battlecruiser ||
-			ui.type == BWAPI::UnitTypes::Protoss_Corsair ||
-			ui.type == BWAPI::UnitTypes::Protoss_Scout ||
-			ui.type == BWAPI::UnitTypes::Protoss_Carrier ||
-			ui.type == BWAPI::UnitTypes::Protoss_Stargate ||
-			ui.type == BWAPI::UnitTypes::Zerg_Spire ||
-			ui.type == BWAPI::UnitTypes::Zerg_Greater_Spire ||
-			ui.type == BWAPI::UnitTypes::Zerg_Mutalisk ||
-			ui.type == BWAPI::UnitTypes::Zerg_Scourge)
-		{
-			_enemyHasOverlordHunters = true;
-			_enemyHasAirTech = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyOverlordHunters);
 }
 
 void InformationManager::enemySeenBurrowing()
 {
-	_enemyHasCloakTech = true;
-	_enemyCloakedUnitsSeen = true;
+	setEnemyCapability(EnemyCloakTech);
+	setEnemyCapability(EnemyCloakedUnitsSeen);
 }
 
 // Enemy has spore colonies, photon cannons, turrets, or spider mines.
@@ -1227,65 +1166,20 @@ void InformationManager::enemySeenBurrowing()
 // Spider mines only catch cloaked ground units, so this routine is not for countering wraiths.
 bool InformationManager::enemyHasStaticDetection()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasStaticDetection)
-	{
-		return true;
-	}
-
-	if (enemyHasStaticAntiAir())
-	{
-		_enemyHasStaticDetection = true;
-		return true;
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine)
-		{
-			_enemyHasStaticDetection = true;
-			return true;
-		}
-	}
-
-	return false;
+	return hasEnemyCapability(EnemyStaticDetection);
 }
 
 // Enemy has overlords, observers, comsat, or science vessels.
 bool InformationManager::enemyHasMobileDetection()
 {
-	// Latch: Once they're known to have the tech, they always have it.
-	if (_enemyHasMobileDetection)
-	{
-		return true;
-	}
-
 	// If the enemy is zerg, they have overlords.
 	// If they went random, we may not have known until now.
 	if (_enemy->getRace() == BWAPI::Races::Zerg)
 	{
-		_enemyHasMobileDetection = true;
-		return true;
-	}
-
-	for (const auto & kv : getUnitData(_enemy).getUnits())
-	{
-		const UnitInfo & ui(kv.second);
-
-		if (ui.type == BWAPI::UnitTypes::Terran_Comsat_Station ||
-			ui.type == BWAPI::UnitTypes::Terran_Science_Facility ||
-			ui.type == BWAPI::UnitTypes::Terran_Science_Vessel ||
-			ui.type == BWAPI::UnitTypes::Protoss_Observatory ||
-			ui.type == BWAPI::UnitTypes::Protoss_Observer)
-		{
-			_enemyHasMobileDetection = true;
-			return true;
-		}
+		setEnemyCapability(EnemyMobileDetection);
 	}
 
-	return false;
+	return hasEnemyCapability(EnemyMobileDetection);
 }
 
 // Our nearest shield battery, by air distance.
@@ -1322,13 +1216,13 @@ int InformationManager::nScourgeNeeded()
 {
 	int count = 0;
 
-	for (const auto & kv : getUnitData(_enemy).getUnits())
+	const UnitData & enemyData = getUnitData(_enemy);
+	for (const BWAPI::Unit unit : enemyData.getUnits(UnitData::FlyerCategory))
 	{
-		const UnitInfo & ui(kv.second);
+		const UnitInfo & ui(*enemyData.getUnitInfo(unit));
 
 		// A few unit types should not usually be scourged. Skip them.
-		if (ui.type.isFlyer() &&
-			ui.type != BWAPI::UnitTypes::Zerg_Overlord &&
+		if (ui.type != BWAPI::UnitTypes::Zerg_Overlord &&
 			ui.type != BWAPI::UnitTypes::Zerg_Scourge &&
 			ui.type != BWAPI::UnitTypes::Protoss_Interceptor)
 		{
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include "Common.h"
 #include "BWTA.h"
 
@@ -8,24 +9,45 @@
 
 namespace UAlbertaBot
 {
+class The;
+
 class InformationManager
 {
+public:
+	// Facts about the enemy which, once true, stay true.
+	enum EnemyCapability
+	{
+		EnemyCombatUnits,
+		EnemyStaticAntiAir,
+		EnemyAntiAir,
+		EnemyAirTech,
+		EnemyCloakTech,
+		EnemyCloakedUnitsSeen,
+		EnemyMobileCloakTech,
+		EnemyOverlordHunters,
+		EnemyStaticDetection,
+		EnemyMobileDetection,
+		NumEnemyCapabilities
+	};
+
+	// Called when an enemy capability first becomes known.
+	typedef std::function<void(EnemyCapability)> CapabilityCallback;
+
+private:
+	The &			the;
 	BWAPI::Player	_self;
 	BWAPI::Player	_enemy;
 
 	bool			_enemyProxy;
 
 	bool			_weHaveCombatUnits;
-	bool			_enemyHasCombatUnits;
-	bool			_enemyHasStaticAntiAir;
-	bool			_enemyHasAntiAir;
-	bool			_enemyHasAirTech;
-	bool			_enemyHasCloakTech;
-	bool            _enemyCloakedUnitsSeen;
-	bool			_enemyHasMobileCloakTech;
-	bool			_enemyHasOverlordHunters;
-	bool			_enemyHasStaticDetection;
-	bool			_enemyHasMobileDetection;
+
+	// Enemy capabilities are latched as enemy units are seen, so queries are a bit test.
+	unsigned int	_enemyCapabilities;		// bit set of EnemyCapability
+
+	// Subscribers to new enemy capabilities, with the tokens to unsubscribe them by.
+	std::vector< std::pair<int, CapabilityCallback> >	_capabilitySubscribers;
+	int													_nextCapabilityToken;
 
 	std::map<BWAPI::Player, UnitData>                   _unitData;
 	std::map<BWAPI::Player, BWTA::BaseLocation *>       _mainBaseLocations;
@@ -52,6 +74,9 @@ class InformationManager
 
 	void					maybeAddStaticDefense(BWAPI::Unit unit);
 
+	void					setEnemyCapability(EnemyCapability capability);
+	void					updateEnemyCapabilities(BWAPI::Unit unit);
+
 	void                    updateUnit(BWAPI::Unit unit);
 	void                    updateUnitInfo();
 	void                    updateBaseLocationInfo();
@@ -112,6 +137,14 @@ public:
 
 	void					enemySeenBurrowing();
 
+	bool					hasEnemyCapability(EnemyCapability capability) const { return (_enemyCapabilities & (1 << capability)) != 0; };
+
+	// Subscribe to be told when an enemy capability first becomes known, so as to react
+	// right away instead of polling. Unsubscribe with the returned token before the
+	// subscriber goes away.
+	int						subscribeEnemyCapability(const CapabilityCallback & callback);
+	void					unsubscribeEnemyCapability(int token);
+
 	// BWAPI::Unit				nearestGroundStaticDefense(BWAPI::Position pos) const;
 	// BWAPI::Unit				nearestAirStaticDefense(BWAPI::Position pos) const;
 	BWAPI::Unit				nearestShieldBattery(BWAPI::Position pos) const;
@@ -3,41 +3,305 @@
 #include <stdarg.h>
 #include <cstdio>
 #include <sstream>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace UAlbertaBot;
 
+namespace
+{
+	// Unwritten messages may take up to this much memory. Beyond that, they are dropped.
+	const size_t MaxBufferedBytes = 4 * 1024 * 1024;
+
+	// The writer wakes up at least this often, so messages don't wait long to be written.
+	const int WriteIntervalMs = 100;
+
+	// Messages are appended to a pending batch under a lock, which is all the game
+	// thread does. The writer thread swaps out the pending batch and writes it.
+	class AsyncLog
+	{
+		struct Entry
+		{
+			int		file;			// index into fileNames
+			bool	overwrite;		// start the file over
+			size_t	offset;			// into text
+			size_t	length;
+		};
+
+		struct Batch
+		{
+			std::vector<Entry>	entries;
+			std::string			text;
+
+			void clear() { entries.clear(); text.clear(); };
+		};
+
+		std::mutex						mutex;
+		std::condition_variable			wake;				// the writer has work
+		std::condition_variable			written;			// the writer finished a batch
+		std::thread						writer;
+
+		// Protected by the mutex.
+		std::map<std::string, int>		fileIndex;
+		std::vector<std::string>		fileNames;
+		std::vector<int>				droppedByFile;		// since the last note in the file
+		Batch							pending;
+		int								dropped;			// in total
+		int								flushRequested;		// sequence numbers
+		int								flushCompleted;
+		bool							stopping;			// the writer should write what it has and exit
+
+		// Used only by the writer thread.
+		Batch										writing;
+		std::vector<std::unique_ptr<std::ofstream>>	streams;	// indexed like fileNames
+
+		void run();
+		void startWriter();
+		void write(const std::vector<std::string> & names, const std::vector<int> & drops);
+		std::ofstream & stream(const std::string & name, int file, bool overwrite);
+
+	public:
+		AsyncLog();
+
+		void add(const std::string & logFile, const char * msg, size_t length, bool overwrite);
+		void flush();
+		void stop();
+		int getDropped();
+	};
+
+	AsyncLog::AsyncLog()
+		: dropped(0)
+		, flushRequested(0)
+		, flushCompleted(0)
+		, stopping(false)
+	{
+	}
+
+	// Start the writer if it is not running, on first use or after stop(). Call with the lock held.
+	void AsyncLog::startWriter()
+	{
+		if (!writer.joinable() && !stopping)
+		{
+			writer = std::thread(&AsyncLog::run, this);
+		}
+	}
+
+	void AsyncLog::add(const std::string & logFile, const char * msg, size_t length, bool overwrite)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		startWriter();
+
+		auto it = fileIndex.find(logFile);
+		int file;
+		if (it == fileIndex.end())
+		{
+			file = int(fileNames.size());
+			fileIndex[logFile] = file;
+			fileNames.push_back(logFile);
+			droppedByFile.push_back(0);
+		}
+		else
+		{
+			file = it->second;
+		}
+
+		if (pending.text.size() + length > MaxBufferedBytes)
+		{
+			++dropped;
+			++droppedByFile[file];
+			return;
+		}
+
+		Entry entry;
+		entry.file = file;
+		entry.overwrite = overwrite;
+		entry.offset = pending.text.size();
+		entry.length = length;
+		pending.entries.push_back(entry);
+		pending.text.append(msg, length);
+
+		// Don't wait for the timer if the buffer is filling up.
+		if (pending.text.size() > MaxBufferedBytes / 2)
+		{
+			wake.notify_one();
+		}
+	}
+
+	// Block until everything added before the call has been written and flushed.
+	void AsyncLog::flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		startWriter();
+		const int target = ++flushRequested;
+		wake.notify_one();
+		written.wait(lock, [&]{ return flushCompleted >= target; });
+	}
+
+	// Write everything and end the writer thread. Call it at the end of the game, before
+	// BWAPI unloads the module; a thread left running would run code that is no longer there.
+	// Other threads should be done logging. Logging again afterward starts a new writer.
+	void AsyncLog::stop()
+	{
+		std::thread finished;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!writer.joinable() || stopping)
+			{
+				return;
+			}
+			stopping = true;
+			wake.notify_one();
+			std::swap(finished, writer);
+		}
+		finished.join();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = false;
+	}
+
+	int AsyncLog::getDropped()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return dropped;
+	}
+
+	// The writer thread. It runs until stop().
+	void AsyncLog::run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			wake.wait_for(lock, std::chrono::milliseconds(WriteIntervalMs), [&]
+			{
+				return stopping || flushRequested > flushCompleted || pending.text.size() > MaxBufferedBytes / 2;
+			});
+			const bool stop = stopping;
+
+			const int flushing = flushRequested;
+			std::swap(pending, writing);
+			const std::vector<std::string> names = fileNames;
+			std::vector<int> drops = droppedByFile;
+			std::fill(droppedByFile.begin(), droppedByFile.end(), 0);
+
+			lock.unlock();
+			write(names, drops);
+			writing.clear();
+			lock.lock();
+
+			flushCompleted = flushing;
+			written.notify_all();
+
+			if (stop)
+			{
+				streams.clear();
+				return;
+			}
+		}
+	}
+
+	// The open stream for the file. Overwriting starts the file over.
+	std::ofstream & AsyncLog::stream(const std::string & name, int file, bool overwrite)
+	{
+		if (size_t(file) >= streams.size())
+		{
+			streams.resize(file + 1);
+		}
+		std::unique_ptr<std::ofstream> & s = streams[file];
+		if (!s || overwrite)
+		{
+			s.reset(new std::ofstream(name.c_str(), overwrite ? std::ofstream::trunc : std::ofstream::app));
+		}
+		return *s;
+	}
+
+	void AsyncLog::write(const std::vector<std::string> & names, const std::vector<int> & drops)
+	{
+		for (size_t file = 0; file < drops.size(); ++file)
+		{
+			if (drops[file] > 0)
+			{
+				stream(names[file], file, false) << "[log: " << drops[file] << " messages dropped]\n";
+			}
+		}
+
+		for (const Entry & entry : writing.entries)
+		{
+			stream(names[entry.file], entry.file, entry.overwrite).write(writing.text.data() + entry.offset, entry.length);
+		}
+
+		for (const auto & s : streams)
+		{
+			if (s)
+			{
+				s->flush();
+			}
+		}
+	}
+
+	// Created on first use and never destroyed. Joining a thread while the DLL is
+	// being unloaded can deadlock, so Logger::Stop() ends the writer at the end of the game.
+	AsyncLog & TheLog()
+	{
+		static AsyncLog * log = new AsyncLog();
+		return *log;
+	}
+}
+
 void Logger::LogAppendToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream;
-    logStream.open(logFile.c_str(), std::ofstream::app);
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+	TheLog().add(logFile, msg.data(), msg.size(), false);
 }
 
 void Logger::LogAppendToFile(const std::string & logFile, const char *fmt, ...)
 {
 	va_list arg;
-		
+
+	// Most messages fit in the stack buffer. If not, format again into a big enough one.
+	char buff[1024];
+	va_start(arg, fmt);
+	const int length = vsnprintf(buff, sizeof(buff), fmt, arg);
+	va_end(arg);
+
+	if (length < 0)
+	{
+		return;
+	}
+	if (size_t(length) < sizeof(buff))
+	{
+		TheLog().add(logFile, buff, length, false);
+		return;
+	}
+
+	std::vector<char> big(length + 1);
 	va_start(arg, fmt);
-	//vfprintf(log_file, fmt, arg);
-	char buff[256];
-	vsnprintf_s(buff, 256, fmt, arg);
+	vsnprintf(big.data(), big.size(), fmt, arg);
 	va_end(arg);
-		
-	std::ofstream logStream;
-	logStream.open(logFile.c_str(), std::ofstream::app);
-	logStream << buff;
-	logStream.flush();
-	logStream.close();
+	TheLog().add(logFile, big.data(), length, false);
 }
 
 void Logger::LogOverwriteToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream(logFile.c_str());
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+	TheLog().add(logFile, msg.data(), msg.size(), true);
+}
+
+void Logger::Flush()
+{
+	TheLog().flush();
+}
+
+void Logger::Stop()
+{
+	TheLog().stop();
+}
+
+int Logger::GetDroppedCount()
+{
+	return TheLog().getDropped();
 }
 
 std::string FileUtils::ReadFile(const std::string & filename)
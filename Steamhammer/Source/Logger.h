@@ -6,11 +6,21 @@
 
 namespace UAlbertaBot
 {
+// The log calls only copy the message into a buffer. A background thread writes
+// the buffer out in batches, keeping each log file open. If the buffer fills up,
+// messages are dropped and counted, and a note goes into the file.
 namespace Logger 
 {
     void LogAppendToFile(const std::string & logFile, const std::string & msg);
 	void LogAppendToFile(const std::string & logFile, const char *fmt, ...);
     void LogOverwriteToFile(const std::string & logFile, const std::string & msg);
+
+	// Wait until everything logged so far is written.
+	void Flush();
+
+	// Write everything and end the writer thread. Call it at the end of the game.
+	void Stop();
+	int  GetDroppedCount();
 };
 
 namespace FileUtils
@@ -53,10 +53,51 @@ MacroLocation MacroAct::getMacroLocationFromString(std::string & s)
 	return MacroLocation::Anywhere;
 }
 
+// Lower case, with spaces for underscores, the way MacroAct(name) compares names.
+static std::string lowerName(const std::string & name)
+{
+	std::string lower(name);
+	std::replace(lower.begin(), lower.end(), '_', ' ');
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	return lower;
+}
+
+// Every unit, tech, and upgrade type by its lower case name. A unit type can also
+// be named without its race prefix. If two types have the same name, the first wins.
+static std::map<std::string, MacroAct> makeNameTable()
+{
+	std::map<std::string, MacroAct> table;
+
+	for (const BWAPI::UnitType & unitType : BWAPI::UnitTypes::allUnitTypes())
+	{
+		const std::string typeName = lowerName(unitType.getName());
+		table.insert(std::make_pair(typeName, MacroAct(unitType)));
+
+		const std::string raceName = lowerName(unitType.getRace().getName());
+		if (typeName.length() > raceName.length())
+		{
+			table.insert(std::make_pair(typeName.substr(raceName.length() + 1), MacroAct(unitType)));
+		}
+	}
+
+	for (const BWAPI::TechType & techType : BWAPI::TechTypes::allTechTypes())
+	{
+		table.insert(std::make_pair(lowerName(techType.getName()), MacroAct(techType)));
+	}
+
+	for (const BWAPI::UpgradeType & upgradeType : BWAPI::UpgradeTypes::allUpgradeTypes())
+	{
+		table.insert(std::make_pair(lowerName(upgradeType.getName()), MacroAct(upgradeType)));
+	}
+
+	return table;
+}
+
 MacroAct::MacroAct () 
     : _type(MacroActs::Default) 
-    , _race(BWAPI::Races::None)
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(0)
+	, _amount(0)
 {
 }
 
@@ -64,12 +105,11 @@ MacroAct::MacroAct ()
 // String comparison here is case-insensitive.
 MacroAct::MacroAct(const std::string & name)
     : _type(MacroActs::Default) 
-    , _race(BWAPI::Races::None)
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(0)
+	, _amount(0)
 {
-    std::string inputName(name);
-    std::replace(inputName.begin(), inputName.end(), '_', ' ');
-	std::transform(inputName.begin(), inputName.end(), inputName.begin(), ::tolower);
+    std::string inputName(lowerName(name));
 
 	// Commands like "go gas until 100". 100 is the amount.
 	if (inputName.substr(0, 3) == std::string("go "))
@@ -108,7 +148,7 @@ MacroAct::MacroAct(const std::string & name)
 	// It's meaningless and ignored for anything except a building.
 	// Here we parse out the building and its location.
 	// Since buildings are units, only UnitType below sets _macroLocation.
-	std::regex macroLocationRegex("([a-zA-Z_ ]+[a-zA-Z])\\s+\\@\\s+([a-zA-Z][a-zA-Z ]+)");
+	static const std::regex macroLocationRegex("([a-zA-Z_ ]+[a-zA-Z])\\s+\\@\\s+([a-zA-Z][a-zA-Z ]+)");
 	std::smatch m;
 	if (std::regex_match(inputName, m, macroLocationRegex)) {
 		specifiedMacroLocation = getMacroLocationFromString(m[2].str());
@@ -117,106 +157,74 @@ MacroAct::MacroAct(const std::string & name)
 		inputName = m[1].str();
 	}
 
-    for (const BWAPI::UnitType & unitType : BWAPI::UnitTypes::allUnitTypes())
-    {
-        // check to see if the names match exactly
-        std::string typeName = unitType.getName();
-        std::replace(typeName.begin(), typeName.end(), '_', ' ');
-		std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
-		if (typeName == inputName)
-        {
-            *this = MacroAct(unitType);
-			_macroLocation = specifiedMacroLocation;
-            return;
-        }
-
-        // check to see if the names match without the race prefix
-        std::string raceName = unitType.getRace().getName();
-		std::transform(raceName.begin(), raceName.end(), raceName.begin(), ::tolower);
-		if ((typeName.length() > raceName.length()) && (typeName.compare(raceName.length() + 1, typeName.length(), inputName) == 0))
-        {
-            *this = MacroAct(unitType);
+	// Made once, on first use.
+	static const std::map<std::string, MacroAct> nameTable = makeNameTable();
+
+	auto it = nameTable.find(inputName);
+	if (it != nameTable.end())
+	{
+		*this = it->second;
+		if (isUnit())
+		{
 			_macroLocation = specifiedMacroLocation;
-			return;
-        }
-    }
-
-    for (const BWAPI::TechType & techType : BWAPI::TechTypes::allTechTypes())
-    {
-        std::string typeName = techType.getName();
-        std::replace(typeName.begin(), typeName.end(), '_', ' ');
-		std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
-		if (typeName == inputName)
-        {
-            *this = MacroAct(techType);
-            return;
-        }
-    }
-
-    for (const BWAPI::UpgradeType & upgradeType : BWAPI::UpgradeTypes::allUpgradeTypes())
-    {
-        std::string typeName = upgradeType.getName();
-        std::replace(typeName.begin(), typeName.end(), '_', ' ');
-		std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
-		if (typeName == inputName)
-        {
-            *this = MacroAct(upgradeType);
-            return;
-        }
-    }
+		}
+		return;
+	}
 
     UAB_ASSERT_WARNING(false, "Could not find MacroAct with name: %s", name.c_str());
 }
 
 MacroAct::MacroAct (BWAPI::UnitType t) 
-    : _unitType(t)
-    , _type(MacroActs::Unit) 
-    , _race(t.getRace())
+    : _type(MacroActs::Unit) 
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(short(t.getID()))
+	, _amount(0)
 {
 }
 
 MacroAct::MacroAct(BWAPI::UnitType t, MacroLocation loc)
-	: _unitType(t)
-	, _type(MacroActs::Unit)
-	, _race(t.getRace())
+	: _type(MacroActs::Unit)
 	, _macroLocation(loc)
+	, _id(short(t.getID()))
+	, _amount(0)
 {
 }
 
 MacroAct::MacroAct(BWAPI::TechType t)
-    : _techType(t)
-    , _type(MacroActs::Tech) 
-    , _race(t.getRace())
+    : _type(MacroActs::Tech) 
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(short(t.getID()))
+	, _amount(0)
 {
 }
 
 MacroAct::MacroAct (BWAPI::UpgradeType t) 
-    : _upgradeType(t)
-    , _type(MacroActs::Upgrade) 
-    , _race(t.getRace())
+    : _type(MacroActs::Upgrade) 
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(short(t.getID()))
+	, _amount(0)
 {
 }
 
 MacroAct::MacroAct(MacroCommandType t)
-	: _macroCommandType(t)
-	, _type(MacroActs::Command)
-	, _race(BWAPI::Races::None)
+	: _type(MacroActs::Command)
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(short(t))
+	, _amount(0)
 {
+	UAB_ASSERT(!MacroCommand::hasArgument(t), "missing MacroCommand argument");
 }
 
 MacroAct::MacroAct(MacroCommandType t, int amount)
-	: _macroCommandType(t, amount)
-	, _type(MacroActs::Command)
-	, _race(BWAPI::Races::None)     // irrelevant
+	: _type(MacroActs::Command)
 	, _macroLocation(MacroLocation::Anywhere)
+	, _id(short(t))
+	, _amount(amount)
 {
+	UAB_ASSERT(MacroCommand::hasArgument(t), "extra MacroCommand argument");
 }
 
-const size_t & MacroAct::type() const
+size_t MacroAct::type() const
 {
     return _type;
 }
@@ -228,7 +236,7 @@ bool MacroAct::isUnit() const
 
 bool MacroAct::isWorker() const
 {
-	return _type == MacroActs::Unit && _unitType.isWorker();
+	return _type == MacroActs::Unit && unitType().isWorker();
 }
 
 bool MacroAct::isTech() const
@@ -246,62 +254,75 @@ bool MacroAct::isCommand() const
     return _type == MacroActs::Command; 
 }
 
-const BWAPI::Race & MacroAct::getRace() const
+// A command has no race.
+BWAPI::Race MacroAct::getRace() const
 {
-    return _race;
+	if (isUnit())
+	{
+		return unitType().getRace();
+	}
+	if (isTech())
+	{
+		return techType().getRace();
+	}
+	if (isUpgrade())
+	{
+		return upgradeType().getRace();
+	}
+	return BWAPI::Races::None;
 }
 
 bool MacroAct::isBuilding()	const 
 { 
-    return _type == MacroActs::Unit && _unitType.isBuilding(); 
+    return _type == MacroActs::Unit && unitType().isBuilding(); 
 }
 
 bool MacroAct::isAddon() const
 {
-	return _type == MacroActs::Unit && _unitType.isAddon();
+	return _type == MacroActs::Unit && unitType().isAddon();
 }
 
 bool MacroAct::isMorphedBuilding() const
 {
-	return _type == MacroActs::Unit && UnitUtil::IsMorphedBuildingType(_unitType);
+	return _type == MacroActs::Unit && UnitUtil::IsMorphedBuildingType(unitType());
 }
 
 bool MacroAct::isRefinery()	const
 { 
-	return _type == MacroActs::Unit && _unitType.isRefinery();
+	return _type == MacroActs::Unit && unitType().isRefinery();
 }
 
 // The standard supply unit, ignoring the hatchery (which provides 1 supply) and nexus/CC.
 bool MacroAct::isSupply() const
 {
 	return isUnit() &&
-		(  _unitType == BWAPI::UnitTypes::Terran_Supply_Depot
-		|| _unitType == BWAPI::UnitTypes::Protoss_Pylon
-		|| _unitType == BWAPI::UnitTypes::Zerg_Overlord);
+		(  unitType() == BWAPI::UnitTypes::Terran_Supply_Depot
+		|| unitType() == BWAPI::UnitTypes::Protoss_Pylon
+		|| unitType() == BWAPI::UnitTypes::Zerg_Overlord);
 }
 
-const BWAPI::UnitType & MacroAct::getUnitType() const
+BWAPI::UnitType MacroAct::getUnitType() const
 {
 	UAB_ASSERT(_type == MacroActs::Unit, "getUnitType of non-unit");
-    return _unitType;
+    return unitType();
 }
 
-const BWAPI::TechType & MacroAct::getTechType() const
+BWAPI::TechType MacroAct::getTechType() const
 {
 	UAB_ASSERT(_type == MacroActs::Tech, "getTechType of non-tech");
-	return _techType;
+	return techType();
 }
 
-const BWAPI::UpgradeType & MacroAct::getUpgradeType() const
+BWAPI::UpgradeType MacroAct::getUpgradeType() const
 {
 	UAB_ASSERT(_type == MacroActs::Upgrade, "getUpgradeType of non-upgrade");
-	return _upgradeType;
+	return upgradeType();
 }
 
 const MacroCommand MacroAct::getCommandType() const
 {
 	UAB_ASSERT(_type == MacroActs::Command, "getCommandType of non-command");
-	return _macroCommandType;
+	return MacroCommand::hasArgument(commandType()) ? MacroCommand(commandType(), _amount) : MacroCommand(commandType());
 }
 
 const MacroLocation MacroAct::getMacroLocation() const
@@ -314,22 +335,22 @@ int MacroAct::supplyRequired() const
 {
 	if (isUnit())
 	{
-		if (_unitType.isTwoUnitsInOneEgg())
+		if (unitType().isTwoUnitsInOneEgg())
 		{
 			// Zerglings or scourge.
 			return 2;
 		}
-		if (_unitType == BWAPI::UnitTypes::Zerg_Lurker)
+		if (unitType() == BWAPI::UnitTypes::Zerg_Lurker)
 		{
 			// Difference between hydralisk supply and lurker supply.
 			return 2;
 		}
-		if (_unitType == BWAPI::UnitTypes::Zerg_Guardian || _unitType == BWAPI::UnitTypes::Zerg_Devourer)
+		if (unitType() == BWAPI::UnitTypes::Zerg_Guardian || unitType() == BWAPI::UnitTypes::Zerg_Devourer)
 		{
 			// No difference between mutalisk supply and guardian/devourer supply.
 			return 0;
 		}
-		return _unitType.supplyRequired();
+		return unitType().supplyRequired();
 	}
 	return 0;
 }
@@ -338,8 +359,8 @@ int MacroAct::supplyRequired() const
 int MacroAct::mineralPrice() const
 {
 	if (isCommand()) {
-		if (_macroCommandType.getType() == MacroCommandType::ExtractorTrickDrone ||
-			_macroCommandType.getType() == MacroCommandType::ExtractorTrickZergling) {
+		if (commandType() == MacroCommandType::ExtractorTrickDrone ||
+			commandType() == MacroCommandType::ExtractorTrickZergling) {
 			// 50 for the extractor and 50 for the unit. Never mind that you get some back.
 			return 100;
 		}
@@ -347,19 +368,19 @@ int MacroAct::mineralPrice() const
 	}
 	if (isUnit())
 	{
-		return _unitType.mineralPrice();
+		return unitType().mineralPrice();
 	}
 	if (isTech())
 	{
-		return _techType.mineralPrice();
+		return techType().mineralPrice();
 	}
 	if (isUpgrade())
 	{
-		if (_upgradeType.maxRepeats() > 1 && BWAPI::Broodwar->self()->getUpgradeLevel(_upgradeType) > 0)
+		if (upgradeType().maxRepeats() > 1 && BWAPI::Broodwar->self()->getUpgradeLevel(upgradeType()) > 0)
 		{
-			return _upgradeType.mineralPrice(1 + BWAPI::Broodwar->self()->getUpgradeLevel(_upgradeType));
+			return upgradeType().mineralPrice(1 + BWAPI::Broodwar->self()->getUpgradeLevel(upgradeType()));
 		}
-		return _upgradeType.mineralPrice();
+		return upgradeType().mineralPrice();
 	}
 
 	UAB_ASSERT(false, "bad MacroAct");
@@ -374,19 +395,19 @@ int MacroAct::gasPrice() const
 	}
 	if (isUnit())
 	{
-		return _unitType.gasPrice();
+		return unitType().gasPrice();
 	}
 	if (isTech())
 	{
-		return _techType.gasPrice();
+		return techType().gasPrice();
 	}
 	if (isUpgrade())
 	{
-		if (_upgradeType.maxRepeats() > 1 && BWAPI::Broodwar->self()->getUpgradeLevel(_upgradeType) > 0)
+		if (upgradeType().maxRepeats() > 1 && BWAPI::Broodwar->self()->getUpgradeLevel(upgradeType()) > 0)
 		{
-			return _upgradeType.gasPrice(1 + BWAPI::Broodwar->self()->getUpgradeLevel(_upgradeType));
+			return upgradeType().gasPrice(1 + BWAPI::Broodwar->self()->getUpgradeLevel(upgradeType()));
 		}
-		return _upgradeType.gasPrice();
+		return upgradeType().gasPrice();
 	}
 
 	UAB_ASSERT(false, "bad MacroAct");
@@ -398,26 +419,26 @@ BWAPI::UnitType MacroAct::whatBuilds() const
 	if (isCommand()) {
 		return BWAPI::UnitType::UnitType(BWAPI::UnitTypes::None);
 	}
-	return isUnit() ? _unitType.whatBuilds().first : (isTech() ? _techType.whatResearches() : _upgradeType.whatUpgrades());
+	return isUnit() ? unitType().whatBuilds().first : (isTech() ? techType().whatResearches() : upgradeType().whatUpgrades());
 }
 
 std::string MacroAct::getName() const
 {
 	if (isUnit())
 	{
-		return _unitType.getName();
+		return unitType().getName();
 	}
 	if (isTech())
 	{
-		return _techType.getName();
+		return techType().getName();
 	}
 	if (isUpgrade())
 	{
-		return _upgradeType.getName();
+		return upgradeType().getName();
 	}
 	if (isCommand())
 	{
-		return _macroCommandType.getName();
+		return getCommandType().getName();
 	}
 
 	UAB_ASSERT(false, "bad MacroAct");
@@ -437,12 +458,12 @@ void MacroAct::getCandidateProducers(std::vector<BWAPI::Unit> & candidates) cons
 
 	BWAPI::UnitType producerType = whatBuilds();
 
-	for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+	// The idle units of the producer type, which are completed, not training, landed,
+	// powered, not upgrading, and not researching.
+	for (const auto unit : ProductionManager::Instance().getProducerPool(producerType).idle)
 	{
 		// Reasons that a unit cannot produce the desired type:
 
-		if (producerType != unit->getType()) { continue; }
-
 		// TODO Due to a BWAPI 4.1.2 bug, lair research can't be done in a hive.
 		//      Also spire upgrades can't be done in a greater spire.
 		//      The bug is fixed in the next version, 4.2.0.
@@ -459,13 +480,6 @@ void MacroAct::getCandidateProducers(std::vector<BWAPI::Unit> & candidates) cons
 		//	continue;
 		//}
 
-		if (!unit->isCompleted())  { continue; }
-		if (unit->isTraining())    { continue; }
-		if (unit->isLifted())      { continue; }
-		if (!unit->isPowered())    { continue; }
-		if (unit->isUpgrading())   { continue; }
-		if (unit->isResearching()) { continue; }
-
 		// if the type is an addon, some special cases
 		if (isAddon())
 		{
@@ -524,14 +538,13 @@ bool MacroAct::hasPotentialProducer() const
 {
 	BWAPI::UnitType producerType = whatBuilds();
 
-	for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+	for (const auto unit : ProductionManager::Instance().getProducerPool(producerType).all)
 	{
 		// A producer is good if it is the right type and doesn't suffer from
 		// any condition that makes it unable to produce for a long time.
 		// Producing something else only makes it busy for a short time,
 		// but research takes a long time.
-		if (unit->getType() == producerType &&
-			unit->isPowered() &&     // replacing a pylon is a separate queue item
+		if (unit->isPowered() &&     // replacing a pylon is a separate queue item
 			!unit->isLifted() &&     // lifting/landing a building will be a separate queue item when implemented
 			!unit->isUpgrading() &&
 			!unit->isResearching())
@@ -5,7 +5,7 @@
 
 namespace UAlbertaBot
 {
-enum class MacroLocation
+enum class MacroLocation : unsigned char
 	{ Anywhere     // default location
 	, Macro        // macro hatchery or main base building
 	, Expo         // gas expansion
@@ -23,17 +23,20 @@ namespace MacroActs
     enum {Unit, Tech, Upgrade, Command, Default};
 }
 
+// A MacroAct is a small value, copied freely: The kind of act, the id of its
+// unit/tech/upgrade type or its command type, and the building location or
+// command amount. Everything else is looked up from the type when needed.
 class MacroAct 
 {
-	size_t				_type;
-    BWAPI::Race			_race;
-
-	BWAPI::UnitType		_unitType;
-	BWAPI::TechType		_techType;
-	BWAPI::UpgradeType	_upgradeType;
-	MacroCommand		_macroCommandType;
-
+	unsigned char		_type;				// MacroActs::Unit etc.
 	MacroLocation		_macroLocation;
+	short				_id;				// BWAPI type id, or the MacroCommandType
+	int					_amount;			// command argument, if any
+
+	BWAPI::UnitType		unitType()		const { return BWAPI::UnitType(_id); };
+	BWAPI::TechType		techType()		const { return BWAPI::TechType(_id); };
+	BWAPI::UpgradeType	upgradeType()	const { return BWAPI::UpgradeType(_id); };
+	MacroCommandType	commandType()	const { return MacroCommandType(_id); };
 
 	MacroLocation		getMacroLocationFromString(std::string & s);
 
@@ -59,12 +62,12 @@ public:
 	bool    isRefinery()		const;
 	bool	isSupply()			const;
     
-    const size_t & type() const;
-    const BWAPI::Race & getRace() const;
+    size_t type() const;
+    BWAPI::Race getRace() const;
 
-    const BWAPI::UnitType & getUnitType() const;
-    const BWAPI::TechType & getTechType() const;
-    const BWAPI::UpgradeType & getUpgradeType() const;
+    BWAPI::UnitType getUnitType() const;
+    BWAPI::TechType getTechType() const;
+    BWAPI::UpgradeType getUpgradeType() const;
 	const MacroCommand getCommandType() const;
 	const MacroLocation getMacroLocation() const;
 
@@ -80,5 +83,10 @@ public:
 	bool hasTech() const;
 
 	void produce(BWAPI::Unit producer);
+
+	bool operator==(const MacroAct & rhs) const
+	{
+		return _type == rhs._type && _macroLocation == rhs._macroLocation && _id == rhs._id && _amount == rhs._amount;
+	};
 };
 }
\ No newline at end of file
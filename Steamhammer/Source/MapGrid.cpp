@@ -22,7 +22,12 @@ MapGrid::MapGrid(int mapWidth, int mapHeight, int cellSize)
 	, cellSize(cellSize)
 	, cols((mapWidth + cellSize - 1) / cellSize)
 	, rows((mapHeight + cellSize - 1) / cellSize)
-	, cells(rows * cols)
+	, cellCenters(rows * cols)
+	, timeLastVisited(rows * cols, 0)
+	, timeLastOpponentSeen(rows * cols, 0)
+	, timeLastScan(rows * cols, -ScanDuration)
+	, ourStart(rows * cols + 1, 0)
+	, oppStart(rows * cols + 1, 0)
 	, lastUpdated(0)
 {
 	calculateCellCenters();
@@ -65,13 +70,13 @@ BWAPI::Position MapGrid::getLeastExplored(bool byGround, int partition)
 			}
 
 			BWAPI::Position home(BWAPI::Broodwar->self()->getStartLocation());
-			double dist = home.getDistance(getCellByIndex(r, c).center);
-            int lastVisited = getCellByIndex(r, c).timeLastVisited;
+			double dist = home.getDistance(cellCenter);
+            int lastVisited = timeLastVisited[cellIndex(r, c)];
 			if (lastVisited < minSeen || ((lastVisited == minSeen) && (dist > minSeenDist)))
 			{
 				leastRow = r;
 				leastCol = c;
-				minSeen = getCellByIndex(r, c).timeLastVisited;
+				minSeen = lastVisited;
 				minSeenDist = dist;
 			}
 		}
@@ -86,8 +91,6 @@ void MapGrid::calculateCellCenters()
 	{
 		for (int c=0; c < cols; ++c)
 		{
-			GridCell & cell = getCellByIndex(r,c);
-
 			int centerX = (c * cellSize) + (cellSize / 2);
 			int centerY = (r * cellSize) + (cellSize / 2);
 
@@ -124,25 +127,40 @@ void MapGrid::calculateCellCenters()
 				centerY -= 50;
 			}
 
-			cell.center = BWAPI::Position(centerX, centerY);
-			assert(cell.center.isValid());
+			cellCenters[cellIndex(r, c)] = BWAPI::Position(centerX, centerY);
+			assert(cellCenters[cellIndex(r, c)].isValid());
 		}
 	}
 }
 
-BWAPI::Position MapGrid::getCellCenter(int row, int col)
+// Counting sort of unsortedUnits by unsortedCells, into units and start.
+void MapGrid::sortByCell(std::vector<BWAPI::Unit> & units, std::vector<int> & start)
 {
-	return getCellByIndex(row, col).center;
-}
+	// Count the units in each cell, shifted up by one.
+	std::fill(start.begin(), start.end(), 0);
+	for (const int cell : unsortedCells)
+	{
+		++start[cell + 1];
+	}
 
-// clear the vectors in the grid
-void MapGrid::clearGrid() { 
+	// Turn the counts into the start index of each cell.
+	for (size_t i = 1; i < start.size(); ++i)
+	{
+		start[i] += start[i - 1];
+	}
 
-	for (size_t i(0); i<cells.size(); ++i) 
+	// Place each unit, using start[cell] as the fill pointer of the cell.
+	// Afterward start[cell] is the end of the cell, so shift back down by one.
+	units.resize(unsortedUnits.size());
+	for (size_t i = 0; i < unsortedUnits.size(); ++i)
 	{
-		cells[i].ourUnits.clear();
-		cells[i].oppUnits.clear();
+		units[start[unsortedCells[i]]++] = unsortedUnits[i];
 	}
+	for (size_t i = start.size() - 1; i > 0; --i)
+	{
+		start[i] = start[i - 1];
+	}
+	start[0] = 0;
 }
 
 // Populate the grid with units.
@@ -166,93 +184,133 @@ void MapGrid::update()
 	    {
 		    for (int c=0; c < cols; ++c)
 		    {
-			    GridCell & cell = getCellByIndex(r,c);
+			    const BWAPI::Position center = getCellCenter(r, c);
 			
-			    BWAPI::Broodwar->drawTextMap(cell.center.x, cell.center.y, "Last Seen %d", cell.timeLastVisited);
-			    BWAPI::Broodwar->drawTextMap(cell.center.x, cell.center.y+10, "Row/Col (%d, %d)", r, c);
+			    BWAPI::Broodwar->drawTextMap(center.x, center.y, "Last Seen %d", timeLastVisited[cellIndex(r, c)]);
+			    BWAPI::Broodwar->drawTextMap(center.x, center.y+10, "Row/Col (%d, %d)", r, c);
 		    }
 	    }
     }
 
-	clearGrid();
+	const int now = BWAPI::Broodwar->getFrameCount();
 
-	//BWAPI::Broodwar->printf("MapGrid info: WH(%d, %d)  CS(%d)  RC(%d, %d)  C(%d)", mapWidth, mapHeight, cellSize, rows, cols, cells.size());
+	//BWAPI::Broodwar->printf("MapGrid info: WH(%d, %d)  CS(%d)  RC(%d, %d)  C(%d)", mapWidth, mapHeight, cellSize, rows, cols, rows * cols);
 
+	unsortedUnits.clear();
+	unsortedCells.clear();
 	for (const auto unit : BWAPI::Broodwar->self()->getUnits()) 
 	{
-		if (unit->isCompleted() || unit->getType().isBuilding())
+		if ((unit->isCompleted() || unit->getType().isBuilding()) &&
+			unit->getPosition().isValid())			// not loaded into a bunker or transport
 		{
-			getCell(unit).ourUnits.insert(unit);
-			getCell(unit).timeLastVisited = BWAPI::Broodwar->getFrameCount();
+			const int cell = cellIndex(unit->getPosition());
+			unsortedUnits.push_back(unit);
+			unsortedCells.push_back(cell);
+			timeLastVisited[cell] = now;
 		}
 	}
+	sortByCell(ourUnits, ourStart);
 
+	unsortedUnits.clear();
+	unsortedCells.clear();
 	for (const auto unit : BWAPI::Broodwar->enemy()->getUnits()) 
 	{
 		if (unit->exists() &&
 			(unit->isCompleted() || unit->getType().isBuilding()) &&
 			unit->getHitPoints() > 0 &&
-			unit->getType() != BWAPI::UnitTypes::Unknown) 
+			unit->getType() != BWAPI::UnitTypes::Unknown &&
+			unit->getPosition().isValid()) 
 		{
-			getCell(unit).oppUnits.insert(unit);
-			getCell(unit).timeLastOpponentSeen = BWAPI::Broodwar->getFrameCount();
+			const int cell = cellIndex(unit->getPosition());
+			unsortedUnits.push_back(unit);
+			unsortedCells.push_back(cell);
+			timeLastOpponentSeen[cell] = now;
 		}
 	}
+	sortByCell(oppUnits, oppStart);
 }
 
-void MapGrid::getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits)
+// Find units within the radius. Each unit is in one cell, so there are no duplicates.
+// If units is null, stop at the first one found and say whether there was one.
+bool MapGrid::unitsInRadius(std::vector<BWAPI::Unit> * units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const
 {
 	const int x0(std::max( (center.x - radius) / cellSize, 0));
 	const int x1(std::min( (center.x + radius) / cellSize, cols-1));
 	const int y0(std::max( (center.y - radius) / cellSize, 0));
 	const int y1(std::min( (center.y + radius) / cellSize, rows-1));
 	const int radiusSq(radius * radius);
+	bool found = false;
 	for(int y(y0); y<=y1; ++y)
 	{
 		for(int x(x0); x<=x1; ++x)
 		{
-			int row = y;
-			int col = x;
-
-			const GridCell & cell(getCellByIndex(row,col));
+			const int cell = cellIndex(y, x);
 			if(ourUnits)
 			{
-				for (const auto unit : cell.ourUnits)
+				for (int i = ourStart[cell]; i < ourStart[cell + 1]; ++i)
 				{
+					const BWAPI::Unit unit = this->ourUnits[i];
 					BWAPI::Position d(unit->getPosition() - center);
 					if(d.x * d.x + d.y * d.y <= radiusSq)
 					{
-						if (!units.contains(unit)) 
+						if (!units)
 						{
-							units.insert(unit);
+							return true;
 						}
+						units->push_back(unit);
+						found = true;
 					}
 				}
 			}
 			if(oppUnits)
 			{
-				for (const auto unit : cell.oppUnits) if (unit->getType() != BWAPI::UnitTypes::Unknown && unit->isVisible())
+				for (int i = oppStart[cell]; i < oppStart[cell + 1]; ++i)
 				{
-					BWAPI::Position d(unit->getPosition() - center);
-					if(d.x * d.x + d.y * d.y <= radiusSq)
+					const BWAPI::Unit unit = this->oppUnits[i];
+					if (unit->getType() != BWAPI::UnitTypes::Unknown && unit->isVisible())
 					{
-						if (!units.contains(unit))
-						{ 
-							units.insert(unit); 
+						BWAPI::Position d(unit->getPosition() - center);
+						if(d.x * d.x + d.y * d.y <= radiusSq)
+						{
+							if (!units)
+							{
+								return true;
+							}
+							units->push_back(unit);
+							found = true;
 						}
 					}
 				}
 			}
 		}
 	}
+	return found;
+}
+
+// The set version is for callers that collect from several queries and want no duplicates.
+void MapGrid::getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits)
+{
+	queryBuffer.clear();
+	unitsInRadius(&queryBuffer, center, radius, ourUnits, oppUnits);
+	units.insert(queryBuffer.begin(), queryBuffer.end());
+}
+
+void MapGrid::getUnits(std::vector<BWAPI::Unit> & units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const
+{
+	unitsInRadius(&units, center, radius, ourUnits, oppUnits);
+}
+
+// Is there any unit within the radius?
+bool MapGrid::anyUnits(BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const
+{
+	return unitsInRadius(nullptr, center, radius, ourUnits, oppUnits);
 }
 
 // The bot scanned the given position. Record it so we don't scan the same position
 // again before it wears off.
 void MapGrid::scanAtPosition(const BWAPI::Position & pos)
 {
-	GridCell & cell = getCell(pos);
-	cell.timeLastScan = BWAPI::Broodwar->getFrameCount();
+	timeLastScan[cellIndex(pos)] = BWAPI::Broodwar->getFrameCount();
 }
 
 // Is a comsat scan already active at the given position?
@@ -260,7 +318,5 @@ void MapGrid::scanAtPosition(const BWAPI::Position & pos)
 // is in the same grid cell as the given position.
 bool MapGrid::scanIsActiveAt(const BWAPI::Position & pos)
 {
-	const GridCell & cell = getCell(pos);
-
-	return cell.timeLastScan + GridCell::ScanDuration > BWAPI::Broodwar->getFrameCount();
+	return timeLastScan[cellIndex(pos)] + ScanDuration > BWAPI::Broodwar->getFrameCount();
 }
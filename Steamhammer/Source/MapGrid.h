@@ -7,28 +7,6 @@ namespace UAlbertaBot
 {
 class The;
 
-class GridCell
-{
-public:
-
-	int             timeLastVisited;
-    int             timeLastOpponentSeen;
-	int				timeLastScan;
-	BWAPI::Unitset  ourUnits;
-	BWAPI::Unitset  oppUnits;
-	BWAPI::Position center;
-
-	// Not the ideal place for this constant, but this is where it is used.
-	const static int ScanDuration = 240;    // approximate time that a comsat scan provides vision
-
-	GridCell()
-        : timeLastVisited(0)
-        , timeLastOpponentSeen(0)
-		, timeLastScan(-ScanDuration)
-    {
-    }
-};
-
 class MapGrid 
 {
 	MapGrid();
@@ -41,27 +19,52 @@ class MapGrid
 	int							rows, cols;
 	int							lastUpdated;
 
-	std::vector< GridCell >		cells;
+	// Cell information, one array per item, indexed by cellIndex().
+	std::vector<BWAPI::Position>	cellCenters;
+	std::vector<int>				timeLastVisited;
+	std::vector<int>				timeLastOpponentSeen;
+	std::vector<int>				timeLastScan;
+
+	// The units of each side, sorted by cell and rebuilt each frame.
+	// The units of cell i are at indexes start[i] .. start[i+1]-1.
+	std::vector<BWAPI::Unit>		ourUnits;
+	std::vector<int>				ourStart;
+	std::vector<BWAPI::Unit>		oppUnits;
+	std::vector<int>				oppStart;
+
+	// Reused from call to call to avoid allocation.
+	std::vector<BWAPI::Unit>		unsortedUnits;
+	std::vector<int>				unsortedCells;
+	std::vector<BWAPI::Unit>		queryBuffer;
+
+	int							cellIndex(int row, int col) const	{ return row * cols + col; };
+	int							cellIndex(const BWAPI::Position & pos) const { return cellIndex(pos.y / cellSize, pos.x / cellSize); };
 
 	void						calculateCellCenters();
+	void						sortByCell(std::vector<BWAPI::Unit> & units, std::vector<int> & start);
+
+	BWAPI::Position				getCellCenter(int row, int col) const { return cellCenters[cellIndex(row, col)]; };
 
-	void						clearGrid();
-	BWAPI::Position				getCellCenter(int x, int y);
+	bool						unitsInRadius(std::vector<BWAPI::Unit> * units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const;
 
 public:
 
+	// Not the ideal place for this constant, but this is where it is used.
+	const static int ScanDuration = 240;    // approximate time that a comsat scan provides vision
+
 	// yay for singletons!
 	static MapGrid &	Instance();
 
 	void				update();
+
+	// Units within the radius. The vector version appends without checking for duplicates.
 	void				getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits);
+	void				getUnits(std::vector<BWAPI::Unit> & units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const;
+	bool				anyUnits(BWAPI::Position center, int radius, bool ourUnits, bool oppUnits) const;
+
 	BWAPI::Position		getLeastExplored() { return getLeastExplored(false, 1); };
 	BWAPI::Position		getLeastExplored(bool byGround, int mapPartition);
 
-	GridCell & getCellByIndex(int r, int c)		{ return cells[r*cols + c]; }
-	GridCell & getCell(BWAPI::Position pos)		{ return getCellByIndex(pos.y / cellSize, pos.x / cellSize); }
-	GridCell & getCell(BWAPI::Unit unit)		{ return getCell(unit->getPosition()); }
-
 	// Track comsat scans so we don't scan the same place again too soon.
 	void				scanAtPosition(const BWAPI::Position & pos);
 	bool				scanIsActiveAt(const BWAPI::Position & pos);
@@ -19,6 +19,9 @@ MapTools::MapTools()
 	// Figure out which tiles are walkable and buildable.
 	setBWAPIMapData();
 
+	// Distances through BWTA's regions and chokes. Depends on walkability.
+	_regionGraph.initialize(_walkable);
+
 	_hasIslandBases = false;
 	for (BWTA::BaseLocation * base : BWTA::getBaseLocations())
 	{
@@ -130,6 +133,18 @@ void MapTools::setBWAPIMapData()
 			}
 		}
 	}
+
+	// 5. Summed-area tables for fast "is this whole box buildable?" checks.
+	_unbuildableSums = GridSums(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight());
+	_depotUnbuildableSums = GridSums(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight());
+	for (int x = 0; x < BWAPI::Broodwar->mapWidth(); ++x)
+	{
+		for (int y = 0; y < BWAPI::Broodwar->mapHeight(); ++y)
+		{
+			_unbuildableSums.set(x, y, _buildable[x][y] ? 0 : 1);
+			_depotUnbuildableSums.set(x, y, _depotBuildable[x][y] ? 0 : 1);
+		}
+	}
 }
 
 // Ground distance in tiles, -1 if no path exists.
@@ -161,6 +176,13 @@ int MapTools::getGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosit
 		return (*it).second.at(destination);
 	}
 
+	// If the points are in different regions, the region graph knows the distance.
+	int dist = _regionGraph.getGroundTileDistance(origin, destination);
+	if (dist != RegionGraph::NoAnswer)
+	{
+		return dist;
+	}
+
 	// Make a new map for this destination.
 	_allMaps.insert(std::pair<BWAPI::TilePosition, GridDistances>(destination, GridDistances(destination)));
 	return _allMaps[destination].at(origin);
@@ -183,9 +205,20 @@ int MapTools::getGroundDistance(BWAPI::Position origin, BWAPI::Position destinat
 	return tiles;    // 0 or -1
 }
 
+std::vector<BWAPI::Position> MapTools::getWaypoints(BWAPI::Position from, BWAPI::Position to) const
+{
+	std::vector<BWAPI::Position> waypoints;
+	for (const BWAPI::TilePosition & tile : _regionGraph.getWaypoints(BWAPI::TilePosition(from), BWAPI::TilePosition(to)))
+	{
+		waypoints.push_back(BWAPI::Position(tile) + BWAPI::Position(16, 16));
+	}
+	return waypoints;
+}
+
 const std::vector<BWAPI::TilePosition> & MapTools::getClosestTilesTo(BWAPI::TilePosition pos)
 {
 	// make sure the distance map is calculated with pos as a destination
+	// (same origin and destination are in the same region, so the region graph can't answer)
 	int a = getGroundTileDistance(pos, pos);
 
 	return _allMaps[pos].getSortedTiles();
@@ -203,25 +236,34 @@ bool MapTools::isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const
 		return false;
 	}
 
-	int startX = tile.x;
-	int endX = tile.x + type.tileWidth();
-	int startY = tile.y;
-	int endY = tile.y + type.tileHeight();
+	if (type.isResourceDepot())
+	{
+		return isAllDepotBuildable(tile, type.tileWidth(), type.tileHeight());
+	}
+	return isAllBuildable(tile, type.tileWidth(), type.tileHeight());
+}
 
-	for (int x = startX; x<endX; ++x)
+bool MapTools::isAllBuildable(BWAPI::TilePosition topLeft, int width, int height) const
+{
+	if (topLeft.x < 0 || topLeft.y < 0 ||
+		topLeft.x + width > BWAPI::Broodwar->mapWidth() || topLeft.y + height > BWAPI::Broodwar->mapHeight())
 	{
-		for (int y = startY; y<endY; ++y)
-		{
-			BWAPI::TilePosition tile(x, y);
+		return false;
+	}
 
-			if (!tile.isValid() || !isBuildable(tile) || type.isResourceDepot() && !isDepotBuildable(tile))
-			{
-				return false;
-			}
-		}
+	return !_unbuildableSums.any(topLeft.x, topLeft.y, topLeft.x + width, topLeft.y + height);
+}
+
+// A depot-buildable tile is also buildable, so one check is enough.
+bool MapTools::isAllDepotBuildable(BWAPI::TilePosition topLeft, int width, int height) const
+{
+	if (topLeft.x < 0 || topLeft.y < 0 ||
+		topLeft.x + width > BWAPI::Broodwar->mapWidth() || topLeft.y + height > BWAPI::Broodwar->mapHeight())
+	{
+		return false;
 	}
 
-	return true;
+	return !_depotUnbuildableSums.any(topLeft.x, topLeft.y, topLeft.x + width, topLeft.y + height);
 }
 
 void MapTools::drawHomeDistances()
@@ -231,6 +273,8 @@ void MapTools::drawHomeDistances()
 		return;
 	}
 
+	_regionGraph.draw();
+
 	BWAPI::TilePosition homePosition = BWAPI::Broodwar->self()->getStartLocation();
 	GridDistances d(homePosition, true);
 
@@ -5,6 +5,8 @@
 
 #include "Common.h"
 #include "GridDistances.h"
+#include "GridSums.h"
+#include "RegionGraph.h"
 
 // Keep track of map information, like what tiles are walkable or buildable.
 
@@ -21,6 +23,7 @@ class MapTools
 
 	std::map<BWAPI::TilePosition, GridDistances>
 						_allMaps;			// a cache of already computed distance maps
+	RegionGraph			_regionGraph;		// distances between regions, without a full map for each destination
 	std::vector< std::vector<bool> >
 						_terrainWalkable;	// walkable considering terrain only
 	std::vector< std::vector<bool> >
@@ -29,6 +32,8 @@ class MapTools
 						_buildable;
 	std::vector< std::vector<bool> >
 						_depotBuildable;
+	GridSums			_unbuildableSums;	// 1 for each tile that is not _buildable
+	GridSums			_depotUnbuildableSums;	// 1 for each tile that is not _depotBuildable
 	bool				_hasIslandBases;
 
     void				setBWAPIMapData();					// reads in the map data from bwapi and stores it in our map format
@@ -45,6 +50,11 @@ public:
 	int		getGroundTileDistance(BWAPI::Position from, BWAPI::Position to);
 	int		getGroundDistance(BWAPI::Position from, BWAPI::Position to);
 
+	// Choke tiles to pass through on the way. Empty if there are none or no path is known.
+	std::vector<BWAPI::Position> getWaypoints(BWAPI::Position from, BWAPI::Position to) const;
+
+	const RegionGraph & getRegionGraph() const { return _regionGraph; };
+
 	// Pass only valid tiles to these routines!
 	bool	isTerrainWalkable(BWAPI::TilePosition tile) const { return _terrainWalkable[tile.x][tile.y]; };
 	bool	isWalkable(BWAPI::TilePosition tile) const { return _walkable[tile.x][tile.y]; };
@@ -53,6 +63,10 @@ public:
 
 	bool	isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const;
 
+	// Is every tile in the box buildable? Boxes that stick out of the map are not.
+	bool	isAllBuildable(BWAPI::TilePosition topLeft, int width, int height) const;
+	bool	isAllDepotBuildable(BWAPI::TilePosition topLeft, int width, int height) const;
+
 	const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::TilePosition pos);
 	const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::Position pos);
 
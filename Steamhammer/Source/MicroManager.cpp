@@ -101,7 +101,7 @@ void MicroManager::destroyNeutralTargets(const BWAPI::Unitset & targets)
 			}
 			else if (unit->canMove())
 			{
-				Micro::Move(unit, order.getPosition());
+				Micro::Move(unit, orderWaypoint(unit));
 			}
 		}
 		else
@@ -109,7 +109,7 @@ void MicroManager::destroyNeutralTargets(const BWAPI::Unitset & targets)
 			// No visible targets. Move units toward the order position.
 			if (unit->canMove())
 			{
-				Micro::Move(unit, order.getPosition());
+				Micro::Move(unit, orderWaypoint(unit));
 			}
 		}
 	}
@@ -228,11 +228,7 @@ bool MicroManager::unitNearEnemy(BWAPI::Unit unit)
 {
 	assert(unit);
 
-	BWAPI::Unitset enemyNear;
-
-	MapGrid::Instance().getUnits(enemyNear, unit->getPosition(), 800, false, true);
-
-	return enemyNear.size() > 0;
+	return MapGrid::Instance().anyUnits(unit->getPosition(), 800, false, true);
 }
 
 // returns true if position:
@@ -346,6 +342,39 @@ void MicroManager::useShieldBattery(BWAPI::Unit unit, BWAPI::Unit shieldBattery)
 	}
 }
 
+// Where a unit should move to get to the order position.
+// Ground units follow the shared flow field for the order position, a stretch at a time.
+// Until the field is available, they head for the next choke on the way, if any.
+// Air units go straight there.
+BWAPI::Position MicroManager::orderWaypoint(BWAPI::Unit unit) const
+{
+	if (!unit->isFlying())
+	{
+		const FlowField * field = order.getFlowField();
+		if (field)
+		{
+			BWAPI::Position waypoint = field->getWaypoint(unit->getPosition(), 8);
+			if (waypoint.isValid())
+			{
+				return waypoint;
+			}
+		}
+		else
+		{
+			// Skip a choke the unit is already in.
+			for (const BWAPI::Position & waypoint : MapTools::Instance().getWaypoints(unit->getPosition(), order.getPosition()))
+			{
+				if (unit->getDistance(waypoint) > 3 * 32)
+				{
+					return waypoint;
+				}
+			}
+		}
+	}
+
+	return order.getPosition();
+}
+
 void MicroManager::drawOrderText() 
 {
 	if (Config::Debug::DrawUnitTargetInfo)
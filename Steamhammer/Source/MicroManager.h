@@ -25,6 +25,8 @@ protected:
 
 	void				useShieldBattery(BWAPI::Unit unit, BWAPI::Unit shieldBattery);
 
+	BWAPI::Position		orderWaypoint(BWAPI::Unit unit) const;
+
 	void                drawOrderText();
 
 public:
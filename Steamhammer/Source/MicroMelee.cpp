@@ -95,7 +95,7 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & targets)
 				else if (meleeUnit->getDistance(order.getPosition()) > 96)
 				{
 					// There are no targets. Move to the order position if not already close.
-					Micro::Move(meleeUnit, order.getPosition());
+					Micro::Move(meleeUnit, orderWaypoint(meleeUnit));
 				}
 			}
 		}
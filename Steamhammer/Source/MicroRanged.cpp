@@ -122,7 +122,7 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & targets)
 				// No target found. If we're not near the order position, go there.
 				if (rangedUnit->getDistance(order.getPosition()) > 100)
 				{
-					Micro::AttackMove(rangedUnit, order.getPosition());
+					Micro::AttackMove(rangedUnit, orderWaypoint(rangedUnit));
 				}
 			}
 		}
@@ -111,7 +111,7 @@ void MicroTanks::executeMicro(const BWAPI::Unitset & targets)
                     else
                     {
     					// move to it
-    					Micro::AttackMove(tank, order.getPosition());
+    					Micro::AttackMove(tank, orderWaypoint(tank));
                     }
 				}
 			}
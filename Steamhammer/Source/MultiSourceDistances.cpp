@@ -0,0 +1,131 @@
+#include "MultiSourceDistances.h"
+
+#include <algorithm>
+#include "MapTools.h"
+
+using namespace UAlbertaBot;
+
+// Create an empty grid. It is sized on the first call to setSeeds().
+// Necessary if the owner is created before BWAPI is initialized.
+MultiSourceDistances::MultiSourceDistances()
+	: Grid()
+{
+}
+
+MultiSourceDistances::MultiSourceDistances(int w, int h)
+	: Grid(w, h, -1)
+	, nearest(w, std::vector<short>(h, -1))
+{
+}
+
+// The seeds are kept sorted by unit id, so the order the caller finds them in doesn't matter.
+bool MultiSourceDistances::setSeeds(const std::vector<BWAPI::Unit> & seedUnits)
+{
+	std::vector<BWAPI::Unit> units(seedUnits);
+	std::sort(units.begin(), units.end(), [](BWAPI::Unit a, BWAPI::Unit b)
+	{
+		return a->getID() < b->getID();
+	});
+
+	bool changed = units.size() != seeds.size();
+	for (size_t i = 0; !changed && i < units.size(); ++i)
+	{
+		changed = units[i] != seeds[i] || units[i]->getTilePosition() != seedTiles[i];
+	}
+
+	if (!changed && !nearest.empty())
+	{
+		return false;
+	}
+
+	if (nearest.empty())
+	{
+		*this = MultiSourceDistances(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight());
+	}
+
+	seeds = units;
+	seedTiles.clear();
+	for (const BWAPI::Unit unit : seeds)
+	{
+		seedTiles.push_back(unit->getTilePosition());
+	}
+
+	compute();
+	return true;
+}
+
+// Multi-source BFS. All tiles under each seed start at distance 0 (buildings cover
+// several tiles), and each tile remembers which seed its shortest path came from.
+// Distances are Manhattan ground distances, as in GridDistances.
+void MultiSourceDistances::compute()
+{
+	const size_t LegalActions = 4;
+	const int actionX[LegalActions] = { 1, -1, 0, 0 };
+	const int actionY[LegalActions] = { 0, 0, 1, -1 };
+
+	for (int x = 0; x < width; ++x)
+	{
+		std::fill(grid[x].begin(), grid[x].end(), short(-1));
+		std::fill(nearest[x].begin(), nearest[x].end(), short(-1));
+	}
+
+	std::vector<BWAPI::TilePosition> fringe;
+	fringe.reserve(width * height);
+
+	for (size_t i = 0; i < seeds.size(); ++i)
+	{
+		const BWAPI::UnitType type = seeds[i]->getType();
+		const int w = type.isBuilding() ? type.tileWidth() : 1;
+		const int h = type.isBuilding() ? type.tileHeight() : 1;
+		for (int x = seedTiles[i].x; x < seedTiles[i].x + w; ++x)
+		{
+			for (int y = seedTiles[i].y; y < seedTiles[i].y + h; ++y)
+			{
+				BWAPI::TilePosition tile(x, y);
+				if (tile.isValid() && grid[x][y] == -1)
+				{
+					grid[x][y] = 0;
+					nearest[x][y] = short(i);
+					fringe.push_back(tile);
+				}
+			}
+		}
+	}
+
+	for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+	{
+		const BWAPI::TilePosition & tile = fringe[fringeIndex];
+		const short currentDist = grid[tile.x][tile.y];
+		const short currentSeed = nearest[tile.x][tile.y];
+
+		for (size_t a = 0; a < LegalActions; ++a)
+		{
+			BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+
+			if (nextTile.isValid() &&
+				grid[nextTile.x][nextTile.y] == -1 &&
+				MapTools::Instance().isWalkable(nextTile))
+			{
+				fringe.push_back(nextTile);
+				grid[nextTile.x][nextTile.y] = currentDist + 1;
+				nearest[nextTile.x][nextTile.y] = currentSeed;
+			}
+		}
+	}
+}
+
+BWAPI::Unit MultiSourceDistances::getNearest(const BWAPI::TilePosition & tile) const
+{
+	if (nearest.empty() || !tile.isValid())
+	{
+		return nullptr;
+	}
+
+	const int i = nearest[tile.x][tile.y];
+	return i < 0 ? nullptr : seeds[i];
+}
+
+BWAPI::Unit MultiSourceDistances::getNearest(const BWAPI::Position & pos) const
+{
+	return getNearest(BWAPI::TilePosition(pos));
+}
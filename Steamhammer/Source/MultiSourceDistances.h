@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include "BWAPI.h"
+#include "Grid.h"
+
+// Ground distances from the nearest of a set of seed units, and which seed is nearest.
+// Like GridDistances, but with many starting points. Seeded from all our resource
+// depots, it answers "which depot is closest to this worker?" with one lookup.
+
+// The BFS is rerun only when the seed set changes, so the owner can hand in the
+// current seeds every frame and pay only when a seed appears, disappears, or moves.
+
+namespace UAlbertaBot
+{
+class MultiSourceDistances : public Grid
+{
+	std::vector<BWAPI::Unit> seeds;
+	std::vector<BWAPI::TilePosition> seedTiles;		// parallel to seeds, to notice movement
+	std::vector< std::vector<short> > nearest;		// per tile, index into seeds, or -1
+
+	MultiSourceDistances(int w, int h);
+
+	void compute();
+
+public:
+	MultiSourceDistances();
+
+	// Recompute the distances if the set of seeds differs from last time, in any order.
+	// Return true if the distances were recomputed.
+	bool setSeeds(const std::vector<BWAPI::Unit> & units);
+
+	const std::vector<BWAPI::Unit> & getSeeds() const { return seeds; };
+
+	// The nearest seed by ground, or null if none can be reached from here.
+	// The distance in tiles is at() from the Grid base class.
+	BWAPI::Unit getNearest(const BWAPI::TilePosition & tile) const;
+	BWAPI::Unit getNearest(const BWAPI::Position & pos) const;
+};
+}
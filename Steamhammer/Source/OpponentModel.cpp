@@ -2,6 +2,9 @@
 
 #include "Bases.h"
 #include "Random.h"
+#include "The.h"
+
+#include <chrono>
 
 using namespace UAlbertaBot;
 
@@ -409,23 +412,15 @@ void OpponentModel::considerGasSteal()
 	_recommendGasSteal = stealUCB > plainUCB;
 }
 
-// Find the past game record which best matches the current game and remember it.
-void OpponentModel::setBestMatch()
+// Rank the past games by how well they match this game so far, for predictEnemy().
+// The index only does work when there is a new snapshot, or when it is still decoding
+// the past games of the matchup.
+void OpponentModel::updateBestMatches()
 {
-	int bestScore = -1;
-	GameRecord * bestRecord = nullptr;
-
-	for (GameRecord * record : _pastGameRecords)
+	if (Config::IO::ReadOpponentModel || Config::IO::WriteOpponentModel)
 	{
-		int score = _gameRecord.distance(*record);
-		if (score != -1 && (!bestRecord || score < bestScore))
-		{
-			bestScore = score;
-			bestRecord = record;
-		}
+		_recordIndex.update(_gameRecord);
 	}
-
-	_bestMatch = bestRecord;
 }
 
 // We expect the enemy to follow the given opening plan.
@@ -444,11 +439,16 @@ std::string OpponentModel::getOpeningForEnemyPlan(OpeningPlan enemyPlan)
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 OpponentModel::OpponentModel()
-	: _bestMatch(nullptr)
+	: the(The::Root())
+	, _gameRecord(_arena)
+	, _recordIndex(5)
 	, _singleStrategy(false)
 	, _initialExpectedEnemyPlan(OpeningPlan::Unknown)
 	, _expectedEnemyPlan(OpeningPlan::Unknown)
 	, _recommendGasSteal(false)
+	, _readFinished(false)
+	, _readStarted(false)
+	, _reading(false)
 {
 	std::string name = BWAPI::Broodwar->enemy()->getName();
 
@@ -456,40 +456,145 @@ OpponentModel::OpponentModel()
 	// TODO Obviously not a thorough job.
 	std::replace(name.begin(), name.end(), ' ', '_');
 
-	_filename = "om_" + name + ".txt";
+	_filename = "om_" + name + ".bin";
+	_textFilename = "om_" + name + ".txt";
+
+	// Snapshots of the game are taken only every 30 seconds, so this need not run often.
+	// Running it often enough also spreads out the decoding of the past games.
+	the.scheduler.add("Best match", 32, FrameScheduler::Low, 0.2, [this]() { updateBestMatches(); });
 }
 
-// Read past game records from the opponent model file, and do initial analysis.
-void OpponentModel::read()
+// The reader is normally finished and joined by the end of the game. If not, as with
+// the log writer, don't join it while the DLL is being unloaded. Let it end with the process.
+OpponentModel::~OpponentModel()
 {
-	if (Config::IO::ReadOpponentModel)
+	if (_reader.joinable())
 	{
-		std::ifstream inFile(Config::IO::ReadDir + _filename);
+		_reader.detach();
+	}
+}
 
-		// There may not be a file to read. That's OK.
-		if (inFile.bad())
+// Read past game records from a file in the old text format.
+// This runs on the reader thread.
+void OpponentModel::readTextFile(const std::string & filename)
+{
+	std::ifstream inFile(filename);
+
+	// There may not be a file to read. That's OK.
+	if (inFile.bad())
+	{
+		return;
+	}
+
+	while (inFile.good())
+	{
+		// NOTE The records are in the arena, which keeps them for the whole game.
+		//      An invalid record is dropped, but its memory is not reused.
+		GameRecord * record = _pastArena.make<GameRecord>(_pastArena, inFile);
+		if (record->isValid())
 		{
-			return;
+			_readRecords.push_back(record);
 		}
+	}
+
+	inFile.close();
+}
 
-		while (inFile.good())
+// Read past game records from the opponent model file, only the newest maxRecords.
+// The file may hold more; see write().
+// This runs on the reader thread. It gets the file names and limit as copies, because
+// the game thread may set the config variables again while it runs.
+void OpponentModel::readFiles(const std::string & filename, const std::string & textFilename, int maxRecords)
+{
+	if (_file.open(filename))
+	{
+		for (int i = std::max(0, _file.getRecordCount() - maxRecords); i < _file.getRecordCount(); ++i)
 		{
-			// NOTE We allocate records here and never free them if valid.
-			//      Their lifetime is the whole game.
-			GameRecord * record = new GameRecord(inFile);
+			// NOTE The records are in the arena, which keeps them for the whole game.
+			GameRecord * record = _file.readRecord(_pastArena, i);
 			if (record->isValid())
 			{
-				_pastGameRecords.push_back(record);
-			}
-			else
-			{
-				delete record;
+				_readRecords.push_back(record);
 			}
 		}
+	}
+	else
+	{
+		// No binary file yet. There may be a file in the old format; write() converts it.
+		readTextFile(textFilename);
+		if (int(_readRecords.size()) > maxRecords)
+		{
+			_readRecords.erase(_readRecords.begin(), _readRecords.end() - maxRecords);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_readerMutex);
+	_readFinished = true;
+	_readerDone.notify_all();
+}
 
-		inFile.close();
+// Start reading the past game records in the background, if we read them at all.
+// The IO options must be parsed first. The rest of the config need not be.
+void OpponentModel::startRead()
+{
+	if (_readStarted)
+	{
+		return;
+	}
+	_readStarted = true;
+
+	if (Config::IO::ReadOpponentModel)
+	{
+		_reading = true;
+		_reader = std::thread(&OpponentModel::readFiles, this,
+			Config::IO::ReadDir + _filename,
+			Config::IO::ReadDir + _textFilename,
+			std::max(1, Config::IO::MaxGameRecords));
+	}
+}
+
+// If the reader is finished, or finishes within waitMs milliseconds (forever if waitMs < 0),
+// take in the past game records and return true. Otherwise return false.
+bool OpponentModel::finishRead(int waitMs)
+{
+	if (!_reading)
+	{
+		return true;
 	}
 
+	{
+		std::unique_lock<std::mutex> lock(_readerMutex);
+		if (waitMs < 0)
+		{
+			_readerDone.wait(lock, [this] { return _readFinished; });
+		}
+		else if (!_readerDone.wait_for(lock, std::chrono::milliseconds(waitMs), [this] { return _readFinished; }))
+		{
+			return false;
+		}
+	}
+
+	_reader.join();
+	_reading = false;
+
+	_pastGameRecords.swap(_readRecords);
+	for (const GameRecord * record : _pastGameRecords)
+	{
+		_recordIndex.add(record);
+	}
+	return true;
+}
+
+// Take in the past game records, and do initial analysis.
+void OpponentModel::read()
+{
+	// Normally the reader was started early in onStart() and is done by now.
+	// If it is too slow, make the opening decisions without the past games, as if
+	// this were a new opponent. The records are taken in when they are ready, and
+	// serve for the rest of the game.
+	startRead();
+	finishRead(Config::IO::ReadOpponentModelLimitMs);
+
 	// Make immediate decisions that may take into account the game records.
 	// The initial expected enemy plan is set only here. That's the idea.
 	// The current expected enemy plan may be reset later.
@@ -502,72 +607,77 @@ void OpponentModel::read()
 // Write the game records to the opponent model file.
 void OpponentModel::write()
 {
+	// The file update depends on knowing all the past records.
+	finishRead(-1);
+
 	if (Config::IO::WriteOpponentModel)
 	{
-		std::ofstream outFile(Config::IO::WriteDir + _filename, std::ios::trunc);
+		const std::string filename = Config::IO::WriteDir + _filename;
 
-		// If it fails, there's not much we can do about it.
-		if (outFile.bad())
-		{
-			return;
-		}
+		// Use at most this many records, counting this game. The file may hold more.
+		const int maxRecords = std::max(1, Config::IO::MaxGameRecords);
 
-		// The number of initial game records to skip over without rewriting.
-		// In normal operation, nToSkip is 0 or 1.
-		int nToSkip = 0;
-		if (int(_pastGameRecords.size()) >= Config::IO::MaxGameRecords)
+		// We only now record the expected enemy opening plan. There is no point in tracking it during the game.
+		_gameRecord.setExpectedEnemyPlan(_initialExpectedEnemyPlan);
+
+		std::string thisGame;
+		_gameRecord.writeBinary(thisGame);
+
+		// Usually the file to write holds the same records we read (it is the same file,
+		// or a copy of it). Then we only need to add this game to the end.
+		// The file may hold up to twice the limit. The oldest records over the limit are
+		// not read, and they are dropped only when the file fills up, so that an opponent
+		// with a long history does not cost a rewrite of the whole file every game.
+		const int fileRecords = _file.getRecordCount();
+		if (fileRecords < 2 * maxRecords &&
+			OpponentModelFile::Append(filename, thisGame, fileRecords))
 		{
-			nToSkip = _pastGameRecords.size() - Config::IO::MaxGameRecords + 1;
+			return;
 		}
 
-		// Rewrite any old records that were read in.
+		// Otherwise write the whole file, dropping the oldest records over the limit.
+		// If it fails, there's not much we can do about it.
+		// This is also how a file in the old text format gets converted.
 		// Not needed for local testing or for SSCAIT, necessary for other competitions.
-		for (auto record : _pastGameRecords)
+		std::vector<std::string> records;
+		const size_t nToSkip = _pastGameRecords.size() - std::min(_pastGameRecords.size(), size_t(maxRecords - 1));
+		for (size_t i = nToSkip; i < _pastGameRecords.size(); ++i)
 		{
-			if (nToSkip > 0)
-			{
-				--nToSkip;
-			}
-			else
-			{
-				record->write(outFile);
-			}
+			records.push_back(std::string());
+			_pastGameRecords[i]->writeBinary(records.back());
 		}
+		records.push_back(thisGame);
 
-		// And write the record of this game.
-		_gameRecord.write(outFile);
+		// The file we read may be the file we are replacing, and Windows will not
+		// replace a file that is mapped. The past records are done with by now.
+		_file.close();
 
-		outFile.close();
+		OpponentModelFile::Write(filename, records);
 	}
 }
 
+// At the end of the game, after write(), free the game records and snapshots all at once.
+void OpponentModel::release()
+{
+	finishRead(-1);
+
+	_recordIndex.clear();
+	_pastGameRecords.clear();
+	_gameRecord.clearSnapshots();
+	_file.close();
+	_pastArena.release();
+	_arena.release();
+}
+
 void OpponentModel::update()
 {
 	_planRecognizer.update();
+	finishRead(0);
 	reconsiderEnemyPlan();
 
 	if (Config::IO::ReadOpponentModel || Config::IO::WriteOpponentModel)
 	{
 		_gameRecord.update();
-
-		// TODO the rest is turned off for now, not currently useful
-		return;
-
-		if (BWAPI::Broodwar->getFrameCount() % 32 == 31)
-		{
-			setBestMatch();
-		}
-
-		if (_bestMatch)
-		{
-			//_bestMatch->debugLog();
-			//BWAPI::Broodwar->drawTextScreen(200, 10, "%cmatch %s %s", white, _bestMatch->mapName, _bestMatch->openingName);
-			BWAPI::Broodwar->drawTextScreen(220, 6, "%cmatch", white);
-		}
-		else
-		{
-			BWAPI::Broodwar->drawTextScreen(220, 6, "%cno best match", white);
-		}
 	}
 }
 
@@ -576,16 +686,17 @@ void OpponentModel::predictEnemy(int lookaheadFrames, PlayerSnapshot & snap) con
 {
 	const int t = BWAPI::Broodwar->getFrameCount() + lookaheadFrames;
 
-	// Use the best-match past game record if possible.
+	// Use the best-matching past game record that lasted long enough, if there is one.
 	// Otherwise, take a current snapshot and call it the prediction.
-	if (_bestMatch && _bestMatch->findClosestSnapshot(t, snap))
-	{
-		// All done.
-	}
-	else
+	for (const GameRecordIndex::Match & match : _recordIndex.getBestMatches())
 	{
-		snap.takeEnemy();
+		if (match.record->findClosestSnapshot(t, snap))
+		{
+			return;
+		}
 	}
+
+	snap.takeEnemy();
 }
 
 // The inferred enemy opening plan.
@@ -2,22 +2,45 @@
 
 #include "Common.h"
 #include "GameRecord.h"
+#include "GameRecordIndex.h"
+#include "OpponentModelFile.h"
 #include "OpponentPlan.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace UAlbertaBot
 {
+	class The;
 
 	class OpponentModel
 	{
 	private:
 
+		The & the;
+
 		OpponentPlan _planRecognizer;
 
 		std::string _filename;
+		std::string _textFilename;				// old format, read only to convert it
+		OpponentModelFile _file;				// the past game records point into it
+		Arena _pastArena;						// owns the past game records and their snapshots
+		Arena _arena;							// owns the snapshots of this game
 		GameRecord _gameRecord;
 		std::vector<GameRecord *> _pastGameRecords;
-
-		GameRecord * _bestMatch;
+		GameRecordIndex _recordIndex;
+
+		// The past game records are read on a background thread, started early in onStart()
+		// so that it overlaps the map analysis. Until the game thread sees that the reader
+		// is finished, only the reader touches _file, _pastArena, and _readRecords.
+		std::thread _reader;
+		std::mutex _readerMutex;
+		std::condition_variable _readerDone;
+		bool _readFinished;						// protected by _readerMutex
+		std::vector<GameRecord *> _readRecords;
+		bool _readStarted;						// game thread only
+		bool _reading;							// game thread only: started and not yet taken in
 
 		// Advice for the rest of the bot.
 		bool _singleStrategy;					// enemy seems to always do the same thing, false until proven true
@@ -27,24 +50,31 @@ namespace UAlbertaBot
 		bool _recommendGasSteal;
 		std::string _recommendedOpening;
 
+		void readFiles(const std::string & filename, const std::string & textFilename, int maxRecords);
+		void readTextFile(const std::string & filename);
+		bool finishRead(int waitMs);
+
 		OpeningPlan predictEnemyPlan() const;
 
 		void considerSingleStrategy();
 		void considerOpenings();
 		void reconsiderEnemyPlan();
 		void considerGasSteal();
-		void setBestMatch();
+		void updateBestMatches();
 
 		std::string getOpeningForEnemyPlan(OpeningPlan enemyPlan);
 
 	public:
 		OpponentModel();
+		~OpponentModel();
 
 		void setOpening() { _gameRecord.setOpening(Config::Strategy::StrategyName); };
 		void setWin(bool isWinner) { _gameRecord.setWin(isWinner); };
 
+		void startRead();
 		void read();
 		void write();
+		void release();
 
 		void update();
 
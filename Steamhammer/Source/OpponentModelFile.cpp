@@ -0,0 +1,402 @@
+#include "OpponentModelFile.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace UAlbertaBot;
+
+const char Magic[4] = { 'S', 'H', 'O', 'M' };
+
+const size_t IndexEntrySize = 8;
+
+static unsigned int getUint32(const unsigned char * bytes)
+{
+	return
+		static_cast<unsigned int>(bytes[0]) |
+		static_cast<unsigned int>(bytes[1]) << 8 |
+		static_cast<unsigned int>(bytes[2]) << 16 |
+		static_cast<unsigned int>(bytes[3]) << 24;
+}
+
+static void putUint32(std::string & output, unsigned int n)
+{
+	output += char(n & 0xFF);
+	output += char((n >> 8) & 0xFF);
+	output += char((n >> 16) & 0xFF);
+	output += char((n >> 24) & 0xFF);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+OpponentModelFile::Reader::Reader(const unsigned char * data, size_t size)
+	: pos(data)
+	, end(data + size)
+{
+}
+
+// 7 bits per byte, low bits first. The high bit is set on every byte but the last.
+unsigned int OpponentModelFile::Reader::varint()
+{
+	unsigned int n = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (pos >= end)
+		{
+			throw game_record_read_error();
+		}
+		const unsigned char byte = *pos++;
+		n |= static_cast<unsigned int>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return n;
+		}
+	}
+	throw game_record_read_error();
+}
+
+int OpponentModelFile::Reader::number()
+{
+	const unsigned int n = varint();
+	if (n > 0x7FFFFFFF)
+	{
+		throw game_record_read_error();
+	}
+	return int(n);
+}
+
+// A length, then the bytes.
+std::string OpponentModelFile::Reader::string()
+{
+	const size_t length = varint();
+	if (length > remaining())
+	{
+		throw game_record_read_error();
+	}
+	std::string s(reinterpret_cast<const char *>(pos), length);
+	pos += length;
+	return s;
+}
+
+void OpponentModelFile::PutVarint(std::string & output, unsigned int n)
+{
+	while (n >= 0x80)
+	{
+		output += char((n & 0x7F) | 0x80);
+		n >>= 7;
+	}
+	output += char(n);
+}
+
+void OpponentModelFile::PutNumber(std::string & output, int n)
+{
+	PutVarint(output, n > 0 ? static_cast<unsigned int>(n) : 0);
+}
+
+void OpponentModelFile::PutString(std::string & output, const std::string & s)
+{
+	PutVarint(output, static_cast<unsigned int>(s.size()));
+	output += s;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+bool OpponentModelFile::ReadHeader(const unsigned char * bytes, unsigned int & count, unsigned int & indexOffset)
+{
+	if (!std::equal(Magic, Magic + 4, reinterpret_cast<const char *>(bytes)) ||
+		getUint32(bytes + 4) != FormatVersion)
+	{
+		return false;
+	}
+	count = getUint32(bytes + 8);
+	indexOffset = getUint32(bytes + 12);
+	return true;
+}
+
+void OpponentModelFile::PutHeader(std::string & output, unsigned int count, unsigned int indexOffset)
+{
+	output.append(Magic, 4);
+	putUint32(output, FormatVersion);
+	putUint32(output, count);
+	putUint32(output, indexOffset);
+}
+
+#ifdef WIN32
+
+bool OpponentModelFile::map(const std::string & filename)
+{
+	// Share writing, so that the file can be appended to while it is mapped.
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+	const void * view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const unsigned char *>(view);
+	size = size_t(fileSize.QuadPart);
+	return true;
+}
+
+void OpponentModelFile::unmap()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#else
+
+bool OpponentModelFile::map(const std::string & filename)
+{
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	void * view = MAP_FAILED;
+	if (fstat(fd, &status) == 0 && status.st_size > 0)
+	{
+		view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	::close(fd);          // the mapping keeps the file open
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data = static_cast<const unsigned char *>(view);
+	size = size_t(status.st_size);
+	return true;
+}
+
+void OpponentModelFile::unmap()
+{
+	if (data)
+	{
+		munmap(const_cast<unsigned char *>(data), size);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#endif
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+OpponentModelFile::OpponentModelFile()
+	: data(nullptr)
+	, size(0)
+#ifdef WIN32
+	, fileHandle(nullptr)
+	, mappingHandle(nullptr)
+#endif
+{
+}
+
+OpponentModelFile::~OpponentModelFile()
+{
+	close();
+}
+
+bool OpponentModelFile::open(const std::string & filename)
+{
+	close();
+
+	if (!map(filename))
+	{
+		return false;
+	}
+
+	unsigned int count;
+	unsigned int indexOffset;
+	if (size < HeaderSize ||
+		!ReadHeader(data, count, indexOffset) ||
+		indexOffset < HeaderSize ||
+		indexOffset > size ||
+		count > (size - indexOffset) / IndexEntrySize)
+	{
+		close();
+		return false;
+	}
+
+	index.resize(count);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const unsigned char * entry = data + indexOffset + i * IndexEntrySize;
+		index[i].offset = getUint32(entry);
+		index[i].length = getUint32(entry + 4);
+		if (index[i].offset < HeaderSize ||
+			index[i].offset > size ||
+			index[i].length > size - index[i].offset)
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void OpponentModelFile::close()
+{
+	unmap();
+	index.clear();
+}
+
+GameRecord * OpponentModelFile::readRecord(Arena & arena, int i) const
+{
+	UAB_ASSERT(i >= 0 && i < getRecordCount(), "bad record");
+	return arena.make<GameRecord>(arena, data + index[i].offset, index[i].length);
+}
+
+// Write a new file beside the old one and then swap it in.
+bool OpponentModelFile::Write(const std::string & filename, const std::vector<std::string> & records)
+{
+	std::string contents;
+	std::string indexBytes;
+	PutHeader(contents, 0, 0);		// placeholder
+	for (const std::string & record : records)
+	{
+		putUint32(indexBytes, static_cast<unsigned int>(contents.size()));
+		putUint32(indexBytes, static_cast<unsigned int>(record.size()));
+		contents += record;
+	}
+	std::string header;
+	PutHeader(header, static_cast<unsigned int>(records.size()), static_cast<unsigned int>(contents.size()));
+	contents.replace(0, HeaderSize, header);
+	contents += indexBytes;
+
+	const std::string tempFilename = filename + ".tmp";
+	{
+		std::ofstream output(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!output.write(contents.data(), contents.size()))
+		{
+			return false;
+		}
+	}
+
+	// rename() will not replace an existing file on Windows.
+	std::remove(filename.c_str());
+	return std::rename(tempFilename.c_str(), filename.c_str()) == 0;
+}
+
+bool OpponentModelFile::Append(const std::string & filename, const std::string & record, int expectedCount)
+{
+	std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	unsigned char header[HeaderSize];
+	unsigned int count;
+	unsigned int indexOffset;
+	if (!file.read(reinterpret_cast<char *>(header), HeaderSize) ||
+		!ReadHeader(header, count, indexOffset) ||
+		int(count) != expectedCount)
+	{
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	const size_t fileSize = size_t(file.tellg());
+	if (indexOffset < HeaderSize || indexOffset > fileSize || count > (fileSize - indexOffset) / IndexEntrySize)
+	{
+		return false;
+	}
+
+	std::string indexBytes(count * IndexEntrySize, '\0');
+	if (count > 0)
+	{
+		file.seekg(indexOffset);
+		if (!file.read(&indexBytes[0], indexBytes.size()))
+		{
+			return false;
+		}
+	}
+
+	size_t live = 0;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		live += getUint32(reinterpret_cast<const unsigned char *>(indexBytes.data()) + i * IndexEntrySize + 4);
+	}
+	if (fileSize - HeaderSize - indexBytes.size() > 2 * live)
+	{
+		return false;		// more dead space than records; time to compact
+	}
+
+	// The new record and the new index go after everything else.
+	putUint32(indexBytes, static_cast<unsigned int>(fileSize));
+	putUint32(indexBytes, static_cast<unsigned int>(record.size()));
+	const std::string tail = record + indexBytes;
+	file.seekp(0, std::ios::end);
+	if (!file.write(tail.data(), tail.size()) || !file.flush())
+	{
+		return false;
+	}
+
+	// Only now point the header at them.
+	std::string newHeader;
+	PutHeader(newHeader, count + 1, static_cast<unsigned int>(fileSize + record.size()));
+	file.seekp(0);
+	return bool(file.write(newHeader.data(), newHeader.size()));
+}
+
+bool OpponentModelFile::ConvertTextFile(const std::string & textFilename, const std::string & binaryFilename)
+{
+	std::ifstream input(textFilename);
+	if (!input.is_open())
+	{
+		return false;
+	}
+
+	Arena arena;
+	std::vector<std::string> records;
+	while (input.good())
+	{
+		GameRecord record(arena, input);
+		if (record.isValid())
+		{
+			records.push_back(std::string());
+			record.writeBinary(records.back());
+		}
+	}
+
+	return Write(binaryFilename, records);
+}
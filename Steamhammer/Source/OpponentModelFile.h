@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "GameRecord.h"
+
+// The binary opponent model file, one per opponent.
+
+// Layout. All fixed-size integers are 4 bytes, little-endian.
+//   header: magic "SHOM", format version, record count, index offset
+//   records: one GameRecord each, see GameRecord::writeBinary()
+//   index: for each record in order, its offset and length in bytes
+// Records are appended at the end, followed by a fresh index; the header is
+// rewritten last, so a write that is cut off leaves the old file still readable.
+// Each append leaves the old index behind as dead space. The file may also hold up to
+// twice the configured limit of records; only the newest up to the limit are read.
+// Both go away when the file is compacted.
+
+// Reading maps the file into memory. A GameRecord read from the file decodes its
+// snapshots only when they are needed, straight from the mapped bytes, so the
+// file must stay open as long as the records are in use.
+
+namespace UAlbertaBot
+{
+class OpponentModelFile
+{
+public:
+	static const unsigned int FormatVersion = 1;
+	static const size_t HeaderSize = 16;
+
+	// Decoding, with bounds checks. Bad data throws game_record_read_error.
+	class Reader
+	{
+		const unsigned char * pos;
+		const unsigned char * end;
+
+	public:
+		Reader(const unsigned char * data, size_t size);
+
+		unsigned int	varint();
+		int				number();		// a varint that must fit in an int
+		std::string		string();
+
+		const unsigned char * here() const { return pos; };
+		size_t			remaining() const { return size_t(end - pos); };
+	};
+
+	// Encoding.
+	static void		PutVarint(std::string & output, unsigned int n);
+	static void		PutNumber(std::string & output, int n);		// negative numbers are written as 0
+	static void		PutString(std::string & output, const std::string & s);
+
+private:
+	struct IndexEntry
+	{
+		unsigned int	offset;
+		unsigned int	length;
+	};
+
+	const unsigned char *		data;
+	size_t						size;
+	std::vector<IndexEntry>		index;
+
+#ifdef WIN32
+	void *						fileHandle;
+	void *						mappingHandle;
+#endif
+
+	bool		map(const std::string & filename);
+	void		unmap();
+
+	static bool ReadHeader(const unsigned char * bytes, unsigned int & count, unsigned int & indexOffset);
+	static void PutHeader(std::string & output, unsigned int count, unsigned int indexOffset);
+
+public:
+	OpponentModelFile();
+	~OpponentModelFile();
+
+	// False if there is no readable file. A file with a bad header or index is unreadable.
+	bool		open(const std::string & filename);
+	void		close();
+
+	int			getRecordCount() const { return int(index.size()); };
+
+	// Make record i in the arena. Check isValid() before using it.
+	GameRecord * readRecord(Arena & arena, int i) const;
+
+	// Replace the file with exactly these encoded records, compacting it.
+	static bool Write(const std::string & filename, const std::vector<std::string> & records);
+
+	// Add one encoded record to the end of an existing file. Fail, without changing
+	// the file, if it does not hold exactly expectedCount records (it is not a copy
+	// of the file we read) or if it has become more dead space than records.
+	static bool Append(const std::string & filename, const std::string & record, int expectedCount);
+
+	// Convert an opponent model file in the old text format, version 1.4.
+	static bool ConvertTextFile(const std::string & textFilename, const std::string & binaryFilename);
+};
+}
@@ -15,6 +15,44 @@
 
 using namespace UAlbertaBot;
 
+static void parseIO(const rapidjson::Document & doc)
+{
+	if (doc.HasMember("IO") && doc["IO"].IsObject())
+	{
+		const rapidjson::Value & io = doc["IO"];
+
+		JSONTools::ReadString("ErrorLogFilename", io, Config::IO::ErrorLogFilename);
+		JSONTools::ReadBool("LogAssertToErrorFile", io, Config::IO::LogAssertToErrorFile);
+
+		JSONTools::ReadString("ReadDirectory", io, Config::IO::ReadDir);
+		JSONTools::ReadString("WriteDirectory", io, Config::IO::WriteDir);
+
+		JSONTools::ReadInt("MaxGameRecords", io, Config::IO::MaxGameRecords);
+
+		Config::IO::ReadOpponentModel = ParseUtils::GetBoolByRace("ReadOpponentModel", io);
+		JSONTools::ReadInt("ReadOpponentModelLimitMs", io, Config::IO::ReadOpponentModelLimitMs);
+		Config::IO::WriteOpponentModel = ParseUtils::GetBoolByRace("WriteOpponentModel", io);
+		JSONTools::ReadBool("UseBuildOrderCacheFile", io, Config::IO::UseBuildOrderCacheFile);
+		JSONTools::ReadBool("WriteProfile", io, Config::IO::WriteProfile);
+	}
+}
+
+// Parse only the IO options, ahead of the rest of the configuration file.
+// They do not depend on the map, so the opponent model can be read while the map is analyzed.
+// ParseConfigFile() parses them again, with the same result.
+void ParseUtils::ParseIOOptions(const std::string & filename)
+{
+	rapidjson::Document doc;
+
+	std::string config = FileUtils::ReadFile(filename);
+	if (config.length() == 0 || doc.Parse(config.c_str()).HasParseError())
+	{
+		return;
+	}
+
+	parseIO(doc);
+}
+
 // Parse the JSON configuration file into Config:: variables.
 void ParseUtils::ParseConfigFile(const std::string & filename)
 {
@@ -71,6 +109,13 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
         JSONTools::ReadBool("CompleteMapInformation", bwapi, Config::BWAPIOptions::EnableCompleteMapInformation);
     }
 
+    // Parse the Tournament Options
+    if (doc.HasMember("Tournament") && doc["Tournament"].IsObject())
+    {
+        const rapidjson::Value & tournament = doc["Tournament"];
+        JSONTools::ReadInt("FrameBudgetMs", tournament, Config::Tournament::FrameBudgetMs);
+    }
+
     // Parse the Micro Options
     if (doc.HasMember("Micro") && doc["Micro"].IsObject())
     {
@@ -138,24 +183,11 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
     }
 
 	// Parse the IO options.
-	if (doc.HasMember("IO") && doc["IO"].IsObject())
-	{
-		const rapidjson::Value & io = doc["IO"];
-
-		JSONTools::ReadString("ErrorLogFilename", io, Config::IO::ErrorLogFilename);
-		JSONTools::ReadBool("LogAssertToErrorFile", io, Config::IO::LogAssertToErrorFile);
-
-		JSONTools::ReadString("ReadDirectory", io, Config::IO::ReadDir);
-		JSONTools::ReadString("WriteDirectory", io, Config::IO::WriteDir);
-
-		JSONTools::ReadInt("MaxGameRecords", io, Config::IO::MaxGameRecords);
-
-		Config::IO::ReadOpponentModel = GetBoolByRace("ReadOpponentModel", io);
-		Config::IO::WriteOpponentModel = GetBoolByRace("WriteOpponentModel", io);
-	}
+	parseIO(doc);
 
 	// We do this here because opening selection may depend on the results.
 	// File reading only happens if Config::IO::ReadOpponentModel is true.
+	// Normally it started in the background before the map was analyzed.
 	OpponentModel::Instance().read();
 
     // Parse the Strategy options.
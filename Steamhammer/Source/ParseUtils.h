@@ -8,6 +8,7 @@ namespace UAlbertaBot
 namespace ParseUtils
 {
     void ParseConfigFile(const std::string & filename);
+    void ParseIOOptions(const std::string & filename);
     void ParseTextCommand(const std::string & commandLine);
     BWAPI::Race GetRace(const std::string & raceName);
 	
@@ -2,6 +2,7 @@
 
 #include "Bases.h"
 #include "GameCommander.h"
+#include "Profiler.h"
 #include "StrategyBossZerg.h"
 #include "UnitUtil.h"
 
@@ -17,6 +18,7 @@ ProductionManager::ProductionManager()
   , _extractorTrickState(ExtractorTrick::None)
   , _extractorTrickUnitType(BWAPI::UnitTypes::None)
   , _extractorTrickBuilding(nullptr)
+  , _producerPoolsFrame(-1)
 {
   setBuildOrder(StrategyManager::Instance().getOpeningBookBuildOrder());
 }
@@ -91,6 +93,12 @@ void ProductionManager::update()
     StrategyManager::Instance().freshProductionPlan();
   }
 
+  // Predict when the next items in the queue will start.
+  {
+    ProfileScope profile("Queue prediction");
+    _prediction.update(_queue);
+  }
+
   // Build stuff from the production queue.
   manageBuildOrderQueue();
 }
@@ -420,6 +428,42 @@ void ProductionManager::maybeReorderQueue()
       }
     }
   }
+
+  // We can reorder the queue if: Case 3:
+  // BOSS predicts that the next item will have to wait
+  // and a later item with a different producer can be made now
+  // out of the resources and supply that will be left over when the next item starts.
+  // Then making the later item first does not delay the next item.
+  const QueuePrediction::Item * predictedTop = _prediction.getItem(0);
+  if (predictedTop &&
+    predictedTop->act == top &&
+    predictedTop->startFrame > BWAPI::Broodwar->getFrameCount())
+  {
+    for (int i = _queue.size() - 2; i >= std::max(0, int(_queue.size()) - 5); --i)
+    {
+      const MacroAct & act = _queue[i].macroAct;
+      // Don't reorder a command or anything after it.
+      if (act.isCommand())
+      {
+        break;
+      }
+      BWAPI::Unit producer;
+      if (act.whatBuilds() != top.whatBuilds() &&
+        act.supplyRequired() <= predictedTop->supply &&
+        act.gasPrice() <= std::min(gas, predictedTop->gas) &&
+        act.mineralPrice() <= std::min(minerals, predictedTop->minerals) &&
+        (producer = getProducer(act)) &&
+        canMakeNow(producer, act))
+      {
+        if (Config::Debug::DrawQueueFixInfo)
+        {
+          BWAPI::Broodwar->printf("queue: pull to front predicted %s @ %d", act.getName().c_str(), _queue.size() - i);
+        }
+        _queue.pullToTop(i);
+        return;
+      }
+    }
+  }
 }
 
 // Return null if no producer is found.
@@ -508,16 +552,70 @@ BWAPI::Unit ProductionManager::getFarthestUnitFromPosition(const std::vector<BWA
 
 BWAPI::Unit ProductionManager::getClosestLarvaToPosition(BWAPI::Position closestTo) const
 {
-  std::vector<BWAPI::Unit> larvas;
+  return getClosestUnitToPosition(getProducerPool(BWAPI::UnitTypes::Zerg_Larva).all, closestTo);
+}
+
+// Sort our units by type, one pass over them. Units don't come or go within a frame,
+// so the pools stay good until the next frame however many items we try to produce.
+void ProductionManager::updateProducerPools() const
+{
+  for (ProducerPool & pool : _producerPools)
+  {
+    pool.all.clear();
+    pool.idle.clear();
+  }
+
   for (const auto unit : BWAPI::Broodwar->self()->getUnits())
   {
-    if (unit->getType() == BWAPI::UnitTypes::Zerg_Larva)
+    const size_t id = size_t(unit->getType().getID());
+    if (id >= _producerPools.size())
     {
-      larvas.push_back(unit);
+      _producerPools.resize(id + 1);
     }
+    ProducerPool & pool = _producerPools[id];
+
+    pool.all.push_back(unit);
+    if (unit->isCompleted() &&
+      !unit->isTraining() &&
+      !unit->isLifted() &&
+      unit->isPowered() &&
+      !unit->isUpgrading() &&
+      !unit->isResearching())
+    {
+      pool.idle.push_back(unit);
+    }
+  }
+
+  _producerPoolsFrame = BWAPI::Broodwar->getFrameCount();
+}
+
+// We gave the producer a command this frame. It is no longer idle, and if it is
+// morphing, it is no longer of its type. Look it up by the type it had.
+void ProductionManager::removeProducer(BWAPI::UnitType type, BWAPI::Unit producer, bool morphing)
+{
+  if (_producerPoolsFrame != BWAPI::Broodwar->getFrameCount() || size_t(type.getID()) >= _producerPools.size())
+  {
+    return;
   }
 
-  return getClosestUnitToPosition(larvas, closestTo);
+  ProducerPool & pool = _producerPools[type.getID()];
+  pool.idle.erase(std::remove(pool.idle.begin(), pool.idle.end(), producer), pool.idle.end());
+  if (morphing)
+  {
+    pool.all.erase(std::remove(pool.all.begin(), pool.all.end(), producer), pool.all.end());
+  }
+}
+
+const ProducerPool & ProductionManager::getProducerPool(BWAPI::UnitType type) const
+{
+  if (_producerPoolsFrame != BWAPI::Broodwar->getFrameCount())
+  {
+    updateProducerPools();
+  }
+
+  static const ProducerPool empty;
+  const size_t id = size_t(type.getID());
+  return id < _producerPools.size() ? _producerPools[id] : empty;
 }
 
 // Create a unit or start research.
@@ -605,7 +703,15 @@ void ProductionManager::create(BWAPI::Unit producer, const BuildOrderItem & item
   else
   {
     UAB_ASSERT(false, "Unknown type");
+    return;
+  }
+
+  // A building is made by a worker that BuildingManager chooses later, so the producer is not used up.
+  if (act.isUnit() && act.isBuilding() && !act.isAddon() && !UnitUtil::IsMorphedBuildingType(act.getUnitType()))
+  {
+    return;
   }
+  removeProducer(act.whatBuilds(), producer, act.isUnit() && act.getUnitType().getRace() == BWAPI::Races::Zerg);
 }
 
 bool ProductionManager::canMakeNow(BWAPI::Unit producer, MacroAct t)
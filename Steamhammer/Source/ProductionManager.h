@@ -10,18 +10,27 @@
 #include "BuildOrderQueue.h"
 #include "BuildingManager.h"
 #include "ProductionGoal.h"
+#include "QueuePrediction.h"
 #include "StrategyManager.h"
 
 namespace UAlbertaBot
 {
 enum class ExtractorTrick { None, Start, ExtractorOrdered, UnitOrdered, MakeUnitBypass };
 
+// Our units of one type, gathered once per frame for choosing producers.
+struct ProducerPool
+{
+	std::vector<BWAPI::Unit> all;
+	std::vector<BWAPI::Unit> idle;		// completed, powered, landed, and not training, upgrading, or researching
+};
+
 class ProductionManager
 {
     ProductionManager();
     
     std::unordered_map<BWAPI::Unit, BuildOrderItem> pendingUnit;
     BuildOrderQueue						_queue;
+	QueuePrediction						_prediction;
 	std::forward_list<ProductionGoal>	_goals;
 
 	int					_lastProductionFrame;            // for detecting jams
@@ -34,6 +43,12 @@ class ProductionManager
 	ExtractorTrick		_extractorTrickState;
 	BWAPI::UnitType		_extractorTrickUnitType;         // drone or zergling
 	Building *			_extractorTrickBuilding;         // set depending on the extractor trick state
+
+	mutable std::vector<ProducerPool>	_producerPools;		// by unit type id; made on first use each frame
+	mutable int							_producerPoolsFrame;
+
+	void				updateProducerPools() const;
+	void				removeProducer(BWAPI::UnitType type, BWAPI::Unit producer, bool morphing);
     
 	BWAPI::Unit         getClosestUnitToPosition(const std::vector<BWAPI::Unit> & units, BWAPI::Position closestTo) const;
 	BWAPI::Unit         getFarthestUnitFromPosition(const std::vector<BWAPI::Unit> & units, BWAPI::Position farthest) const;
@@ -61,6 +76,8 @@ public:
 
     static ProductionManager &	Instance();
 
+	const ProducerPool & getProducerPool(BWAPI::UnitType type) const;
+
     void	drawQueueInformation(std::map<BWAPI::UnitType,int> & numUnits,int x,int y,int index);
 	void	setBuildOrder(const BuildOrder & buildOrder);
 	void	update();
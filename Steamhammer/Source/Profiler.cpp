@@ -0,0 +1,279 @@
+#include "Profiler.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include "Common.h"
+
+using namespace UAlbertaBot;
+
+// Count the frames that take longer than these. 55ms is the tournament limit.
+const double FrameThresholdsMs[] = { 42.0, 55.0, 85.0 };
+const size_t NumFrameThresholds = sizeof(FrameThresholdsMs) / sizeof(FrameThresholdsMs[0]);
+
+// Histogram buckets are geometric, 4 per doubling, from 1 microsecond to over 2 minutes.
+const int BucketsPerDoubling = 4;
+const int NumBuckets = 27 * BucketsPerDoubling;
+
+// Don't let the trace grow without limit in a long, slow game.
+const size_t MaxTraceEvents = 200000;
+
+static int bucketOf(double us)
+{
+	if (us < 1.0)
+	{
+		return 0;
+	}
+	return std::min(NumBuckets - 1, int(BucketsPerDoubling * std::log2(us)));
+}
+
+static double bucketUpperBound(int bucket)
+{
+	return std::pow(2.0, double(bucket + 1) / BucketsPerDoubling);
+}
+
+Profiler::Node::Node(const char * n, int p)
+	: name(n)
+	, key(n)
+	, parent(p)
+	, calls(0)
+	, totalUs(0.0)
+	, maxUs(0.0)
+	, histogram(NumBuckets, 0)
+{
+}
+
+Profiler::Profiler()
+	: enabled(false)
+	, frames(0)
+	, framesOver(NumFrameThresholds, 0)
+{
+	nodes.push_back(Node("Frame", -1));
+	clock.start();
+}
+
+Profiler & Profiler::Instance()
+{
+	static Profiler instance;
+	return instance;
+}
+
+// The child node of parent with the given name, created if necessary.
+// Names are nearly always string literals or long-lived strings, so the pointer usually
+// matches the key from last time. Compare strings only if it doesn't.
+int Profiler::child(int parent, const char * name)
+{
+	for (const int c : nodes[parent].children)
+	{
+		if (nodes[c].key == name)
+		{
+			return c;
+		}
+	}
+	for (const int c : nodes[parent].children)
+	{
+		if (nodes[c].name == name)
+		{
+			nodes[c].key = name;
+			return c;
+		}
+	}
+
+	const int c = int(nodes.size());
+	nodes.push_back(Node(name, parent));
+	nodes[parent].children.push_back(c);
+	return c;
+}
+
+void Profiler::beginFrame()
+{
+	enabled = Config::IO::WriteProfile;
+	if (!enabled)
+	{
+		stack.clear();
+		return;
+	}
+
+	// If the last frame was not ended (the bot may return early), drop what is left of it.
+	stack.clear();
+	frameEvents.clear();
+
+	Open open;
+	open.node = 0;
+	open.startUs = clock.getElapsedTimeInMicroSec();
+	stack.push_back(open);
+}
+
+void Profiler::endFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	while (stack.size() > 1)
+	{
+		leave();
+	}
+	if (stack.empty())
+	{
+		return;
+	}
+
+	const double frameMs = 0.001 * (clock.getElapsedTimeInMicroSec() - stack.back().startUs);
+	leave();
+
+	++frames;
+	for (size_t i = 0; i < NumFrameThresholds; ++i)
+	{
+		if (frameMs > FrameThresholdsMs[i])
+		{
+			++framesOver[i];
+		}
+	}
+
+	if (frameMs > FrameThresholdsMs[0] && traceEvents.size() + frameEvents.size() <= MaxTraceEvents)
+	{
+		traceEvents.insert(traceEvents.end(), frameEvents.begin(), frameEvents.end());
+	}
+}
+
+// A scope outside any frame is recorded under the root. Scopes before the first
+// frame, during onStart(), are not recorded, because profiling is not yet on.
+void Profiler::enter(const char * name)
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	Open open;
+	open.node = child(stack.empty() ? 0 : stack.back().node, name);
+	open.startUs = clock.getElapsedTimeInMicroSec();
+	stack.push_back(open);
+}
+
+void Profiler::leave()
+{
+	if (!enabled || stack.empty())
+	{
+		return;
+	}
+
+	const Open open = stack.back();
+	stack.pop_back();
+
+	const double us = clock.getElapsedTimeInMicroSec() - open.startUs;
+
+	Node & node = nodes[open.node];
+	++node.calls;
+	node.totalUs += us;
+	node.maxUs = std::max(node.maxUs, us);
+	++node.histogram[bucketOf(us)];
+
+	Event event;
+	event.node = open.node;
+	event.frame = BWAPI::Broodwar->getFrameCount();
+	event.startUs = open.startUs;
+	event.durationUs = us;
+	frameEvents.push_back(event);
+}
+
+// An upper bound on the p-th fraction of call times, from the histogram.
+double Profiler::percentile(const Node & node, double p) const
+{
+	const double target = p * node.calls;
+	int seen = 0;
+	for (int i = 0; i < NumBuckets; ++i)
+	{
+		seen += node.histogram[i];
+		if (seen > 0 && seen >= target)
+		{
+			return std::min(bucketUpperBound(i), node.maxUs);
+		}
+	}
+	return node.maxUs;
+}
+
+std::string Profiler::path(int node) const
+{
+	std::string result = nodes[node].name;
+	for (int n = nodes[node].parent; n >= 0; n = nodes[n].parent)
+	{
+		result = nodes[n].name + "/" + result;
+	}
+	return result;
+}
+
+void Profiler::write() const
+{
+	writeSummary(Config::IO::WriteDir + "profile.json");
+	writeTrace(Config::IO::WriteDir + "profile_trace.json");
+}
+
+// Frame counts, and per scope: calls, total and mean time, and percentiles.
+void Profiler::writeSummary(const std::string & filename) const
+{
+	std::ofstream out(filename, std::ios::trunc);
+	if (!out.is_open())
+	{
+		return;
+	}
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\n";
+	out << "  \"frames\": " << frames << ",\n";
+	for (size_t i = 0; i < NumFrameThresholds; ++i)
+	{
+		out << "  \"framesOver" << int(FrameThresholdsMs[i]) << "ms\": " << framesOver[i] << ",\n";
+	}
+	out << "  \"scopes\": [\n";
+	bool first = true;
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		const Node & node = nodes[i];
+		if (node.calls == 0)
+		{
+			continue;
+		}
+		if (!first)
+		{
+			out << ",\n";
+		}
+		first = false;
+		out << "    { \"path\": \"" << path(i) << "\""
+			<< ", \"calls\": " << node.calls
+			<< ", \"totalMs\": " << 0.001 * node.totalUs
+			<< ", \"meanMs\": " << 0.001 * node.totalUs / node.calls
+			<< ", \"p50Ms\": " << 0.001 * percentile(node, 0.50)
+			<< ", \"p95Ms\": " << 0.001 * percentile(node, 0.95)
+			<< ", \"p99Ms\": " << 0.001 * percentile(node, 0.99)
+			<< ", \"maxMs\": " << 0.001 * node.maxUs
+			<< " }";
+	}
+	out << "\n  ]\n}\n";
+}
+
+// Chrome trace event format: One complete event per scope run in a slow frame.
+void Profiler::writeTrace(const std::string & filename) const
+{
+	std::ofstream out(filename, std::ios::trunc);
+	if (!out.is_open())
+	{
+		return;
+	}
+
+	out << std::fixed << std::setprecision(1);
+	out << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < traceEvents.size(); ++i)
+	{
+		const Event & event = traceEvents[i];
+		out << "{\"name\":\"" << nodes[event.node].name
+			<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+			<< ",\"ts\":" << event.startUs
+			<< ",\"dur\":" << event.durationUs
+			<< ",\"args\":{\"frame\":" << event.frame << "}}"
+			<< (i + 1 < traceEvents.size() ? ",\n" : "\n");
+	}
+	out << "],\"displayTimeUnit\":\"ms\"}\n";
+}
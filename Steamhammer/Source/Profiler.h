@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../../BOSS/source/Timer.hpp"
+
+// Nested timing of any code, for finding out what makes frames slow.
+
+// Put a ProfileScope at the top of a block to time it. Scopes nest: Time inside a
+// scope is recorded under the path of enclosing scopes, like Frame/Combat/CombatSim.
+// The TimerManager categories are scopes too, so everything nests under a manager.
+
+// For each path we keep a histogram of call times for percentiles. For the game, we
+// count frames over the time thresholds. For each slow frame, we keep a trace of every
+// scope that ran, which can be viewed in chrome://tracing or similar.
+// At the end of the game, write() saves the summary and trace to the write directory.
+
+// Profiling is on only if the WriteProfile option is set. It is switched at the start
+// of a frame, so that scopes always balance. Otherwise each scope costs a flag check.
+
+namespace UAlbertaBot
+{
+class Profiler
+{
+	struct Node
+	{
+		std::string					name;
+		const char *				key;			// the name pointer last seen, to skip string compares
+		int							parent;			// -1 for the root
+		std::vector<int>			children;
+		int							calls;
+		double						totalUs;
+		double						maxUs;
+		std::vector<int>			histogram;		// call counts by time bucket
+
+		Node(const char * n, int p);
+	};
+
+	struct Open
+	{
+		int							node;
+		double						startUs;
+	};
+
+	struct Event
+	{
+		int							node;
+		int							frame;
+		double						startUs;
+		double						durationUs;
+	};
+
+	BOSS::Timer						clock;			// started once, the time base for everything
+	std::vector<Node>				nodes;			// nodes[0] is the root, the whole frame
+	std::vector<Open>				stack;
+	std::vector<Event>				frameEvents;	// for the current frame
+	std::vector<Event>				traceEvents;	// for the slow frames so far
+
+	bool							enabled;		// Config::IO::WriteProfile as of the start of the frame
+	int								frames;
+	std::vector<int>				framesOver;		// parallel to the thresholds
+
+	Profiler();
+
+	int						child(int parent, const char * name);
+	double					percentile(const Node & node, double p) const;
+	std::string				path(int node) const;
+
+	void					writeSummary(const std::string & filename) const;
+	void					writeTrace(const std::string & filename) const;
+
+public:
+	static Profiler &		Instance();
+
+	void					beginFrame();
+	void					endFrame();
+
+	void					enter(const char * name);
+	void					leave();
+
+	void					write() const;
+};
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char * name) { Profiler::Instance().enter(name); };
+	~ProfileScope() { Profiler::Instance().leave(); };
+};
+}
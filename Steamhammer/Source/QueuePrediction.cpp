@@ -0,0 +1,151 @@
+#include "QueuePrediction.h"
+
+#include "BOSSManager.h"
+#include "BuildingManager.h"
+
+using namespace UAlbertaBot;
+
+static bool sameItem(const QueuePrediction::Item & a, const QueuePrediction::Item & b)
+{
+	return a.act == b.act && a.isGasSteal == b.isGasSteal;
+}
+
+QueuePrediction::QueuePrediction()
+	: startFrame(-1)
+	, doneCount(0)
+{
+}
+
+// Simulate items[i] and everything after it, starting from states[i].
+void QueuePrediction::simulateFrom(size_t i)
+{
+	states.resize(i + 1);
+	for (size_t j = i; j < items.size(); ++j)
+	{
+		items[j].startFrame = -1;
+	}
+
+	try
+	{
+		for (; i < items.size(); ++i)
+		{
+			Item & item = items[i];
+			BOSS::GameState state(states[i]);
+			item.supplyBlocked = false;
+
+			// A command happens as soon as it comes up. A gas steal is made in the enemy base,
+			// outside what BOSS knows about. Neither changes the state.
+			if (!item.act.isCommand() && !item.isGasSteal)
+			{
+				const BOSS::ActionType action = BOSSManager::GetActionType(item.act);
+				if (!state.isLegal(action))
+				{
+					return;
+				}
+				const BOSS::UnitData & units = state.getUnitData();
+				item.supplyBlocked =
+					action.supplyRequired() > 0 &&
+					units.getCurrentSupply() + action.supplyRequired() > units.getMaxSupply();
+				state.doAction(action);
+			}
+
+			item.startFrame = int(state.getCurrentFrame());
+			item.minerals = int(state.getMinerals()) / int(BOSS::Constants::RESOURCE_SCALE);		// BOSS counts in thousandths
+			item.gas = int(state.getGas()) / int(BOSS::Constants::RESOURCE_SCALE);
+			item.supply = int(state.getUnitData().getMaxSupply()) - int(state.getUnitData().getCurrentSupply());
+			states.push_back(state);
+		}
+	}
+	catch (const BOSS::BOSSException &)
+	{
+		// BOSS can't handle the item. It and the items after it are not predicted.
+		items[i].startFrame = -1;
+	}
+}
+
+// Call once per frame, or as often as the prediction is wanted.
+void QueuePrediction::update(const BuildOrderQueue & queue)
+{
+	const int now = BWAPI::Broodwar->getFrameCount();
+
+	// The items made since the last update. They were at the front of the old prediction.
+	const size_t done = size_t(queue.getDoneCount() - doneCount);
+	doneCount = queue.getDoneCount();
+
+	std::vector<Item> wanted;
+	for (int i = int(queue.size()) - 1; i >= 0 && wanted.size() < MaxItems; --i)
+	{
+		Item item;
+		item.act = queue[i].macroAct;
+		item.isGasSteal = queue[i].isGasSteal;
+		item.startFrame = -1;
+		item.minerals = 0;
+		item.gas = 0;
+		item.supply = 0;
+		item.supplyBlocked = false;
+		wanted.push_back(item);
+	}
+
+	if (wanted.empty())
+	{
+		clear();
+		return;
+	}
+
+	// Start over from the live state if it's time, or if more was made than we predicted.
+	// If the items left over don't line up with the queue, the queue was reordered before
+	// something was made, and we can't tell what was made. Start over then too.
+	if (startFrame < 0 || now >= startFrame + RefreshFrames || done >= items.size() || done >= states.size() ||
+		(done > 0 && !sameItem(items[done], wanted[0])))
+	{
+		try
+		{
+			BOSS::GameState live(BWAPI::Broodwar, BWAPI::Broodwar->self(), BuildingManager::Instance().buildingsQueued());
+			states.clear();
+			states.push_back(live);
+		}
+		catch (const BOSS::BOSSException &)
+		{
+			clear();
+			return;
+		}
+		items = wanted;
+		startFrame = now;
+		simulateFrom(0);
+		return;
+	}
+
+	items.erase(items.begin(), items.begin() + done);
+	states.erase(states.begin(), states.begin() + done);
+
+	// Keep the prediction for the items that are the same as before, and redo the rest.
+	size_t same = 0;
+	while (same < items.size() && same < wanted.size() && same + 1 < states.size() && sameItem(items[same], wanted[same]))
+	{
+		++same;
+	}
+	if (same == items.size() && same == wanted.size())
+	{
+		return;
+	}
+
+	items.resize(same);
+	items.insert(items.end(), wanted.begin() + same, wanted.end());
+	simulateFrom(same);
+}
+
+void QueuePrediction::clear()
+{
+	items.clear();
+	states.clear();
+	startFrame = -1;
+}
+
+const QueuePrediction::Item * QueuePrediction::getItem(size_t i) const
+{
+	if (i < items.size() && items[i].startFrame >= 0)
+	{
+		return &items[i];
+	}
+	return nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "BuildOrderQueue.h"
+#include "../../BOSS/source/BOSS.h"
+
+// Predict when the items at the top of the production queue will start.
+
+// The queue items are run through BOSS from the live game state, in queue order,
+// as ProductionManager would make them. For each item we predict its start frame,
+// the resources and supply left over when it starts, and whether it waits for supply.
+// An item that BOSS says can't be made stops the prediction, because production
+// would stop there too.
+
+// The simulation state before each item is kept. When the queue changes, only the
+// items from the first change on are simulated again. When items are made, they drop
+// off the front; the queue counts them, so a run of the same item (drone, drone, ...)
+// is not confused. The whole prediction is redone from the live state every so often.
+
+namespace UAlbertaBot
+{
+class QueuePrediction
+{
+public:
+	struct Item
+	{
+		MacroAct	act;
+		bool		isGasSteal;
+		int			startFrame;		// -1 if not predicted
+		int			minerals;		// left over after it starts
+		int			gas;
+		int			supply;
+		bool		supplyBlocked;	// it waits for supply
+	};
+
+private:
+	static const size_t MaxItems = 12;			// look no deeper into the queue
+	static const int RefreshFrames = 24;		// start over from the live state this often
+
+	std::vector<Item>				items;		// items[0] is the top of the queue
+	std::vector<BOSS::GameState>	states;		// states[i] is the state before items[i]
+	int								startFrame;	// when the live state was taken, -1 if none
+	int								doneCount;	// the queue's count of made items at the last update
+
+	void	simulateFrom(size_t i);
+
+public:
+	QueuePrediction();
+
+	void	update(const BuildOrderQueue & queue);
+	void	clear();
+
+	// i counts from the top of the queue. Null if the item is not predicted.
+	const Item * getItem(size_t i) const;
+};
+}
@@ -0,0 +1,467 @@
+#include "RegionGraph.h"
+
+#include "Common.h"
+
+using namespace UAlbertaBot;
+
+int RegionGraph::Node::at(const BWAPI::TilePosition & pos) const
+{
+	int x = pos.x - left;
+	int y = pos.y - top;
+	if (x < 0 || y < 0 || x >= width || y >= height)
+	{
+		return -1;
+	}
+	return dist[x * height + y];
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+int RegionGraph::findRegion(BWTA::Region * region) const
+{
+	for (size_t i = 0; i < regions.size(); ++i)
+	{
+		if (regions[i] == region)
+		{
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+// The tiles along the line across the choke, from one side to the other, that are walkable.
+// The line is 8-connected, so that a path of 4-way steps can't cross it without stepping on it.
+std::vector<BWAPI::TilePosition> RegionGraph::findChokeTiles(BWTA::Chokepoint * choke, const std::vector< std::vector<bool> > & walkable) const
+{
+	std::vector<BWAPI::TilePosition> tiles;
+
+	const BWAPI::TilePosition end1(choke->getSides().first);
+	const BWAPI::TilePosition end2(choke->getSides().second);
+
+	const int dx = abs(end2.x - end1.x);
+	const int dy = -abs(end2.y - end1.y);
+	const int sx = end1.x < end2.x ? 1 : -1;
+	const int sy = end1.y < end2.y ? 1 : -1;
+	int err = dx + dy;
+
+	for (int x = end1.x, y = end1.y; ; )
+	{
+		BWAPI::TilePosition tile(x, y);
+		if (tile.isValid() && walkable[x][y])
+		{
+			tiles.push_back(tile);
+		}
+		if (x == end2.x && y == end2.y)
+		{
+			break;
+		}
+		const int e2 = 2 * err;
+		if (e2 >= dy)
+		{
+			err += dy;
+			x += sx;
+		}
+		if (e2 <= dx)
+		{
+			err += dx;
+			y += sy;
+		}
+	}
+
+	return tiles;
+}
+
+// If no tile along the choke line is walkable at tile resolution (it happens with narrow chokes),
+// look for the closest walkable tile nearby which belongs to one of the two regions.
+BWAPI::TilePosition RegionGraph::findChokeTile(BWTA::Chokepoint * choke, int r1, int r2, const std::vector< std::vector<bool> > & walkable) const
+{
+	const BWAPI::TilePosition center(choke->getCenter());
+	const int maxRadius = 3;
+
+	BWAPI::TilePosition best = BWAPI::TilePositions::None;
+	int bestDist = 999999;
+
+	for (int x = center.x - maxRadius; x <= center.x + maxRadius; ++x)
+	{
+		for (int y = center.y - maxRadius; y <= center.y + maxRadius; ++y)
+		{
+			BWAPI::TilePosition tile(x, y);
+			if (tile.isValid() && walkable[x][y])
+			{
+				int r = regionOf[tileIndex(x, y)];
+				int dist = abs(x - center.x) + abs(y - center.y);
+				if ((r == r1 || r == r2) && dist < bestDist)
+				{
+					best = tile;
+					bestDist = dist;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+// BFS from the node's tile, staying within the bounding box.
+void RegionGraph::computeNodeDistances(Node & node, const std::vector< std::vector<bool> > & walkable) const
+{
+	const size_t LegalActions = 4;
+	const int actionX[LegalActions] = { 1, -1, 0, 0 };
+	const int actionY[LegalActions] = { 0, 0, 1, -1 };
+
+	node.dist = std::vector<short>(node.width * node.height, -1);
+
+	std::vector<BWAPI::TilePosition> fringe;
+	fringe.reserve(node.width * node.height);
+	fringe.push_back(node.tile);
+	node.dist[(node.tile.x - node.left) * node.height + node.tile.y - node.top] = 0;
+
+	for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+	{
+		const BWAPI::TilePosition & tile = fringe[fringeIndex];
+		short currentDist = node.dist[(tile.x - node.left) * node.height + tile.y - node.top];
+
+		for (size_t a = 0; a < LegalActions; ++a)
+		{
+			int x = tile.x + actionX[a];
+			int y = tile.y + actionY[a];
+			if (x < node.left || y < node.top || x >= node.left + node.width || y >= node.top + node.height)
+			{
+				continue;
+			}
+
+			short & d = node.dist[(x - node.left) * node.height + y - node.top];
+			if (d == -1 && walkable[x][y])
+			{
+				d = currentDist + 1;
+				fringe.push_back(BWAPI::TilePosition(x, y));
+			}
+		}
+	}
+}
+
+// Link each pair of nodes whose chokes border the same region, then find all shortest
+// paths (Floyd-Warshall). There are a few hundred nodes at most, so this is cheap enough
+// to do once at the start of the game.
+void RegionGraph::computeNodeGraph()
+{
+	const int n = nodes.size();
+
+	nodeDist = std::vector< std::vector<int> >(n, std::vector<int>(n, -1));
+	nodeNext = std::vector< std::vector<int> >(n, std::vector<int>(n, -1));
+
+	for (int i = 0; i < n; ++i)
+	{
+		nodeDist[i][i] = 0;
+		nodeNext[i][i] = i;
+	}
+
+	for (const std::vector<int> & rn : regionNodes)
+	{
+		for (int a : rn)
+		{
+			for (int b : rn)
+			{
+				if (a != b)
+				{
+					int d = nodes[a].at(nodes[b].tile);
+					if (d >= 0 && (nodeDist[a][b] < 0 || d < nodeDist[a][b]))
+					{
+						nodeDist[a][b] = d;
+						nodeNext[a][b] = b;
+					}
+				}
+			}
+		}
+	}
+
+	for (int k = 0; k < n; ++k)
+	{
+		for (int i = 0; i < n; ++i)
+		{
+			if (nodeDist[i][k] < 0)
+			{
+				continue;
+			}
+			for (int j = 0; j < n; ++j)
+			{
+				if (nodeDist[k][j] < 0)
+				{
+					continue;
+				}
+				int d = nodeDist[i][k] + nodeDist[k][j];
+				if (nodeDist[i][j] < 0 || d < nodeDist[i][j])
+				{
+					nodeDist[i][j] = d;
+					nodeNext[i][j] = nodeNext[i][k];
+				}
+			}
+		}
+	}
+}
+
+// Find the best pair of nodes to route through, and the total distance.
+// Return false if there is no route through the graph.
+bool RegionGraph::bestRoute(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to, int & dist, int & nodeA, int & nodeB) const
+{
+	const std::vector<int> & fromNodes = regionNodes[regionIndex(from)];
+	const std::vector<int> & toNodes = regionNodes[regionIndex(to)];
+
+	dist = -1;
+	nodeA = -1;
+	nodeB = -1;
+
+	std::vector<int> toDist(toNodes.size());
+	for (size_t j = 0; j < toNodes.size(); ++j)
+	{
+		toDist[j] = nodes[toNodes[j]].at(to);
+	}
+
+	for (int a : fromNodes)
+	{
+		int da = nodes[a].at(from);
+		if (da < 0)
+		{
+			continue;
+		}
+		for (size_t j = 0; j < toNodes.size(); ++j)
+		{
+			int b = toNodes[j];
+			int db = toDist[j];
+			int dab = nodeDist[a][b];
+			if (db < 0 || dab < 0)
+			{
+				continue;
+			}
+			int d = da + dab + db;
+			if (dist < 0 || d < dist)
+			{
+				dist = d;
+				nodeA = a;
+				nodeB = b;
+			}
+		}
+	}
+
+	return dist >= 0;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Create an empty graph that answers nothing.
+// Necessary if the owner is created before BWTA has analyzed the map.
+RegionGraph::RegionGraph()
+	: initialized(false)
+	, mapWidth(0)
+	, mapHeight(0)
+{
+}
+
+// BWTA must have analyzed the map. The walkability grid is per build tile, as in MapTools.
+void RegionGraph::initialize(const std::vector< std::vector<bool> > & walkable)
+{
+	mapWidth = BWAPI::Broodwar->mapWidth();
+	mapHeight = BWAPI::Broodwar->mapHeight();
+
+	regions.assign(BWTA::getRegions().begin(), BWTA::getRegions().end());
+	regionNodes = std::vector< std::vector<int> >(regions.size());
+
+	// 1. Which region is each tile in? Also find the bounding box of each region.
+	std::vector<int> regionLeft(regions.size(), mapWidth);
+	std::vector<int> regionTop(regions.size(), mapHeight);
+	std::vector<int> regionRight(regions.size(), -1);
+	std::vector<int> regionBottom(regions.size(), -1);
+
+	regionOf = std::vector<short>(mapWidth * mapHeight, -1);
+	for (int x = 0; x < mapWidth; ++x)
+	{
+		for (int y = 0; y < mapHeight; ++y)
+		{
+			int r = findRegion(BWTA::getRegion(BWAPI::TilePosition(x, y)));
+			regionOf[tileIndex(x, y)] = r;
+			if (r >= 0)
+			{
+				regionLeft[r] = std::min(regionLeft[r], x);
+				regionTop[r] = std::min(regionTop[r], y);
+				regionRight[r] = std::max(regionRight[r], x);
+				regionBottom[r] = std::max(regionBottom[r], y);
+			}
+		}
+	}
+
+	// 2. The nodes across each choke, and their distances around the choke's two regions.
+	for (BWTA::Chokepoint * choke : BWTA::getChokepoints())
+	{
+		int r1 = findRegion(choke->getRegions().first);
+		int r2 = findRegion(choke->getRegions().second);
+		if (r1 < 0 || r2 < 0 || regionRight[r1] < 0 || regionRight[r2] < 0)
+		{
+			continue;
+		}
+
+		std::vector<BWAPI::TilePosition> tiles = findChokeTiles(choke, walkable);
+		if (tiles.empty())
+		{
+			BWAPI::TilePosition tile = findChokeTile(choke, r1, r2, walkable);
+			if (!tile.isValid())
+			{
+				continue;
+			}
+			tiles.push_back(tile);
+		}
+
+		// The choke tiles are on the region boundary and may be outside both regions.
+		// Leave a margin so that the bounding box includes them.
+		const int left = std::max(0, std::min(regionLeft[r1], regionLeft[r2]) - 1);
+		const int top = std::max(0, std::min(regionTop[r1], regionTop[r2]) - 1);
+		const int right = std::min(mapWidth - 1, std::max(regionRight[r1], regionRight[r2]) + 1);
+		const int bottom = std::min(mapHeight - 1, std::max(regionBottom[r1], regionBottom[r2]) + 1);
+
+		Choke c;
+		c.region1 = r1;
+		c.region2 = r2;
+		const int chokeIndex = chokes.size();
+
+		for (const BWAPI::TilePosition & tile : tiles)
+		{
+			if (tile.x < left || tile.y < top || tile.x > right || tile.y > bottom)
+			{
+				continue;
+			}
+
+			Node node;
+			node.tile = tile;
+			node.choke = chokeIndex;
+			node.left = left;
+			node.top = top;
+			node.width = right - left + 1;
+			node.height = bottom - top + 1;
+			computeNodeDistances(node, walkable);
+
+			const int nodeIndex = nodes.size();
+			nodes.push_back(node);
+			c.nodes.push_back(nodeIndex);
+			regionNodes[r1].push_back(nodeIndex);
+			if (r2 != r1)
+			{
+				regionNodes[r2].push_back(nodeIndex);
+			}
+		}
+
+		chokes.push_back(c);
+	}
+
+	// 3. The graph of nodes.
+	computeNodeGraph();
+
+	initialized = true;
+}
+
+int RegionGraph::regionIndex(const BWAPI::TilePosition & tile) const
+{
+	if (!initialized || !tile.isValid())
+	{
+		return -1;
+	}
+	return regionOf[tileIndex(tile.x, tile.y)];
+}
+
+int RegionGraph::getGroundTileDistance(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const
+{
+	const int rFrom = regionIndex(from);
+	const int rTo = regionIndex(to);
+
+	if (rFrom < 0 || rTo < 0 || rFrom == rTo)
+	{
+		return NoAnswer;
+	}
+
+	int dist, nodeA, nodeB;
+	if (bestRoute(from, to, dist, nodeA, nodeB))
+	{
+		return dist;
+	}
+
+	// BWTA's connectivity is at walk tile resolution, finer than ours. If BWTA says the
+	// regions are not connected, then they are not. Otherwise, we're not sure.
+	if (!regions[rFrom]->isReachable(regions[rTo]))
+	{
+		return -1;
+	}
+	return NoAnswer;
+}
+
+// Where the route follows the tiles across one choke, keep only the last of them.
+std::vector<BWAPI::TilePosition> RegionGraph::getWaypoints(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const
+{
+	std::vector<BWAPI::TilePosition> waypoints;
+
+	const int rFrom = regionIndex(from);
+	const int rTo = regionIndex(to);
+
+	int dist, nodeA, nodeB;
+	if (rFrom < 0 || rTo < 0 || rFrom == rTo || !bestRoute(from, to, dist, nodeA, nodeB))
+	{
+		return waypoints;
+	}
+
+	for (int n = nodeA; n >= 0; n = nodeNext[n][nodeB])
+	{
+		const int next = n == nodeB ? -1 : nodeNext[n][nodeB];
+		if (next < 0 || nodes[next].choke != nodes[n].choke)
+		{
+			waypoints.push_back(nodes[n].tile);
+		}
+		if (n == nodeB)
+		{
+			break;
+		}
+	}
+
+	return waypoints;
+}
+
+// Roughly how much memory the distance data takes.
+int RegionGraph::getMemoryBytes() const
+{
+	int bytes = regionOf.size() * sizeof(short);
+	for (const Node & node : nodes)
+	{
+		bytes += node.dist.size() * sizeof(short);
+	}
+	bytes += 2 * nodes.size() * nodes.size() * sizeof(int);
+	return bytes;
+}
+
+// Draw the graph: each node, and a line between the first nodes of each two chokes of the same region.
+void RegionGraph::draw() const
+{
+	for (size_t r = 0; r < regions.size(); ++r)
+	{
+		for (int a : regionNodes[r])
+		{
+			for (int b : regionNodes[r])
+			{
+				if (a < b &&
+					nodes[a].choke != nodes[b].choke &&
+					a == chokes[nodes[a].choke].nodes.front() &&
+					b == chokes[nodes[b].choke].nodes.front() &&
+					nodeDist[a][b] >= 0)
+				{
+					BWAPI::Position pa = BWAPI::Position(nodes[a].tile) + BWAPI::Position(16, 16);
+					BWAPI::Position pb = BWAPI::Position(nodes[b].tile) + BWAPI::Position(16, 16);
+					BWAPI::Broodwar->drawLineMap(pa, pb, BWAPI::Colors::Teal);
+					BWAPI::Broodwar->drawTextMap((pa + pb) / 2, "%c%d", cyan, nodeDist[a][b]);
+				}
+			}
+		}
+	}
+
+	for (const Node & node : nodes)
+	{
+		BWAPI::Position pos(node.tile);
+		BWAPI::Broodwar->drawBoxMap(pos.x, pos.y, pos.x + 32, pos.y + 32, BWAPI::Colors::Teal);
+	}
+
+	BWAPI::Broodwar->drawTextScreen(10, 300, "%cregion graph %d regions %d chokes %d nodes %dK", white, regions.size(), chokes.size(), nodes.size(), getMemoryBytes() / 1024);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <BWTA.h>
+#include "BWAPI.h"
+
+// Hierarchical ground distances over BWTA's regions and chokepoints.
+
+// The walkable tiles across each chokepoint are the nodes of a graph. For each node
+// we store ground distances to every tile within the bounding box of the two regions
+// that its choke joins. Two nodes are linked if their chokes border the same region,
+// and we precompute shortest distances between all pairs of nodes.
+
+// The ground distance between tiles in different regions is then
+//   distance(from, node A) + distance(node A, node B) + distance(node B, to)
+// minimized over the nodes A of the from region and B of the to region.
+// Every path from one region to another crosses the chokes between them, and with
+// 4-way steps it can't cross the line of tiles across a choke without stepping on one.
+// So the answer is the true distance, except where BWTA's regions don't line up with
+// our tiles; then it may be longer, never shorter. Distances are Manhattan tile
+// distances, as in GridDistances.
+
+// For two tiles in the same region, we have no answer. Callers should use GridDistances.
+
+namespace UAlbertaBot
+{
+class RegionGraph
+{
+	// A walkable tile across a choke, and distances from it.
+	struct Node
+	{
+		BWAPI::TilePosition tile;
+		int choke;						// index into chokes
+		int left;						// the bounding box of the choke's two regions, in tiles
+		int top;
+		int width;
+		int height;
+		std::vector<short> dist;		// -1 if not reachable within the bounding box
+
+		int at(const BWAPI::TilePosition & pos) const;
+	};
+
+	struct Choke
+	{
+		int region1;
+		int region2;
+		std::vector<int> nodes;			// indexes into nodes
+	};
+
+	bool initialized;
+	int mapWidth;
+	int mapHeight;
+
+	std::vector<BWTA::Region *> regions;
+	std::vector<short> regionOf;						// per tile, index into regions, or -1
+	std::vector< std::vector<int> > regionNodes;		// region index -> indexes of the nodes of its chokes
+	std::vector<Choke> chokes;
+	std::vector<Node> nodes;
+	std::vector< std::vector<int> > nodeDist;			// shortest distance node -> node, -1 if none
+	std::vector< std::vector<int> > nodeNext;			// next node on the shortest path, for waypoints
+
+	int tileIndex(int x, int y) const { return x * mapHeight + y; };
+
+	int findRegion(BWTA::Region * region) const;
+	std::vector<BWAPI::TilePosition> findChokeTiles(BWTA::Chokepoint * choke, const std::vector< std::vector<bool> > & walkable) const;
+	BWAPI::TilePosition findChokeTile(BWTA::Chokepoint * choke, int r1, int r2, const std::vector< std::vector<bool> > & walkable) const;
+	void computeNodeDistances(Node & node, const std::vector< std::vector<bool> > & walkable) const;
+	void computeNodeGraph();
+
+	bool bestRoute(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to, int & dist, int & nodeA, int & nodeB) const;
+
+public:
+	// Returned when the graph can't answer: the tiles are in the same region or not in any region.
+	static const int NoAnswer = -2;
+
+	RegionGraph();
+
+	void initialize(const std::vector< std::vector<bool> > & walkable);
+
+	int regionIndex(const BWAPI::TilePosition & tile) const;
+
+	// Ground distance in tiles, -1 if not connected, or NoAnswer.
+	int getGroundTileDistance(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const;
+
+	// The choke tiles to pass through, in order, to get from one point to the other.
+	// Empty if the points are in the same region or the graph has no route.
+	std::vector<BWAPI::TilePosition> getWaypoints(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const;
+
+	int getMemoryBytes() const;
+
+	void draw() const;
+};
+}
@@ -398,6 +398,9 @@ BWAPI::Position Squad::calcRegroupPosition()
 
 	int minDist = 100000;
 
+	// The shared flow field to the order position, if it is ready, answers ground distances.
+	const FlowField * field = _hasGround ? _order.getFlowField() : nullptr;
+
 	// Retreat to the location of the squad unit not near the enemy which is
 	// closest to the order position.
 	// NOTE May retreat somewhere silly if the chosen unit was newly produced.
@@ -416,7 +419,8 @@ BWAPI::Position Squad::calcRegroupPosition()
 			{
 				// If the squad has any ground units, don't try to retreat to the position of an air unit
 				// which is flying in a place that a ground unit cannot reach.
-				if (!_hasGround || -1 != MapTools::Instance().getGroundTileDistance(unit->getPosition(), _order.getPosition()))
+				if (!_hasGround ||
+					-1 != (field ? field->getTileDistance(unit->getPosition()) : MapTools::Instance().getGroundTileDistance(unit->getPosition(), _order.getPosition())))
 				{
 					minDist = dist;
 					regroup = unit->getPosition();
@@ -476,11 +480,7 @@ bool Squad::unitNearEnemy(BWAPI::Unit unit)
 {
 	UAB_ASSERT(unit, "missing unit");
 
-	BWAPI::Unitset enemyNear;
-
-	MapGrid::Instance().getUnits(enemyNear, unit->getPosition(), 400, false, true);
-
-	return enemyNear.size() > 0;
+	return MapGrid::Instance().anyUnits(unit->getPosition(), 400, false, true);
 }
 
 // What map partition is the squad on?
@@ -532,6 +532,8 @@ BWAPI::Unit Squad::unitClosestToEnemy()
 
 	UAB_ASSERT(_order.getPosition().isValid(), "bad order position");
 
+	const FlowField * field = _hasGround ? _order.getFlowField() : nullptr;
+
 	for (const auto unit : _units)
 	{
 		// Non-combat units should be ignored for this calculation.
@@ -547,7 +549,15 @@ BWAPI::Unit Squad::unitClosestToEnemy()
 		{
 			// A ground or air-ground squad. Use ground distance.
 			// It is -1 if no ground path exists.
-			dist = MapTools::Instance().getGroundDistance(unit->getPosition(), _order.getPosition());
+			if (field)
+			{
+				dist = field->getTileDistance(unit->getPosition());
+				dist = dist > 0 ? 32 * dist : dist;
+			}
+			else
+			{
+				dist = MapTools::Instance().getGroundDistance(unit->getPosition(), _order.getPosition());
+			}
 		}
 		else
 		{
@@ -572,19 +582,21 @@ const BWAPI::Unitset & Squad::getUnits() const
 
 void Squad::setSquadOrder(const SquadOrder & so)
 {
+	const SquadOrder earlier(_order);
 	_order = so;
+	_order.keepFlowField(earlier);
 
 	// Pass the order on to all micromanagers.
-	_microAirToAir.setOrder(so);
-	_microMelee.setOrder(so);
-	_microRanged.setOrder(so);
-	_microDetectors.setOrder(so);
-	_microHighTemplar.setOrder(so);
-	_microLurkers.setOrder(so);
-	_microMedics.setOrder(so);
-	//_microMutas.setOrder(so);
-	_microTanks.setOrder(so);
-	_microTransports.setOrder(so);
+	_microAirToAir.setOrder(_order);
+	_microMelee.setOrder(_order);
+	_microRanged.setOrder(_order);
+	_microDetectors.setOrder(_order);
+	_microHighTemplar.setOrder(_order);
+	_microLurkers.setOrder(_order);
+	_microMedics.setOrder(_order);
+	//_microMutas.setOrder(_order);
+	_microTanks.setOrder(_order);
+	_microTransports.setOrder(_order);
 }
 
 const SquadOrder & Squad::getSquadOrder() const			
@@ -712,11 +724,8 @@ void Squad::stimIfNeeded()
 			continue;
 		}
 
-		BWAPI::Unitset nearbyEnemies;
-		MapGrid::Instance().getUnits(nearbyEnemies, firebat->getPosition(), 64, false, true);
-
 		// NOTE We don't check whether the enemy is attackable or worth attacking.
-		if (!nearbyEnemies.empty())
+		if (MapGrid::Instance().anyUnits(firebat->getPosition(), 64, false, true))
 		{
 			Micro::Stim(firebat);
 			totalMedicEnergy -= stimEnergyCost;
@@ -737,10 +746,7 @@ void Squad::stimIfNeeded()
 			continue;
 		}
 
-		BWAPI::Unitset nearbyEnemies;
-		MapGrid::Instance().getUnits(nearbyEnemies, marine->getPosition(), 5 * 32, false, true);
-
-		if (!nearbyEnemies.empty())
+		if (MapGrid::Instance().anyUnits(marine->getPosition(), 5 * 32, false, true))
 		{
 			Micro::Stim(marine);
 			totalMedicEnergy -= stimEnergyCost;
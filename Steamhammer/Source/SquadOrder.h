@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "The.h"
 
 namespace UAlbertaBot
 {
@@ -25,6 +26,9 @@ class SquadOrder
 	int                 _radius;
     std::string         _status;
 
+	// Copies of the order share the flow field, and keep it alive while any of them is around.
+	mutable std::shared_ptr<const FlowField> _flowField;
+
 public:
 
 	SquadOrder() 
@@ -61,6 +65,26 @@ public:
         return _type;
     }
 
+	// The shared ground flow field to the order position, or null if it is not available yet.
+	const FlowField * getFlowField() const
+	{
+		if (!_flowField)
+		{
+			_flowField = The::Root().flowFields.get(_position);
+		}
+		return _flowField.get();
+	}
+
+	// An order that replaces an earlier one to the same position takes over its flow field.
+	// Otherwise the field might be freed and computed again each time the order is renewed.
+	void keepFlowField(const SquadOrder & earlier)
+	{
+		if (!_flowField && BWAPI::TilePosition(_position) == BWAPI::TilePosition(earlier._position))
+		{
+			_flowField = earlier._flowField;
+		}
+	}
+
 	const char getCharCode() const
 	{
 		switch (_type)
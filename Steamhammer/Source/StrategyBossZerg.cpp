@@ -7,6 +7,7 @@
 #include "ProductionManager.h"
 #include "Random.h"
 #include "ScoutManager.h"
+#include "The.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
@@ -15,7 +16,8 @@ using namespace UAlbertaBot;
 const int maxDevourers = 9;
 
 StrategyBossZerg::StrategyBossZerg()
-	: _self(BWAPI::Broodwar->self())
+	: the(The::Root())
+	, _self(BWAPI::Broodwar->self())
 	, _enemy(BWAPI::Broodwar->enemy())
 	, _enemyRace(_enemy->getRace())
 	, _nonadaptive(false)
@@ -24,6 +26,8 @@ StrategyBossZerg::StrategyBossZerg()
 	, _latestBuildOrder(BWAPI::Races::Zerg)
 	, _emergencyGroundDefense(false)
 	, _emergencyStartFrame(-1)
+	, _capabilityToken(0)
+	, _newEnemyCapability(false)
 	, _existingSupply(-1)
 	, _pendingSupply(-1)
 	, _lastUpdateFrame(-1)
@@ -34,6 +38,26 @@ StrategyBossZerg::StrategyBossZerg()
 	setUnitMix(BWAPI::UnitTypes::Zerg_Drone, BWAPI::UnitTypes::None);
 	chooseAuxUnit();          // it chooses None initially
 	chooseEconomyRatio();
+
+	// Army sizes don't need to be updated as often as the rest of the game state.
+	the.scheduler.add("Army sizes", 12, FrameScheduler::Normal, 0.2, [this]() { updateArmySizes(); });
+
+	// makeUrgentReaction() answers these. It normally runs only every 32 frames.
+	_capabilityToken = InformationManager::Instance().subscribeEnemyCapability([this](InformationManager::EnemyCapability capability)
+	{
+		if (capability == InformationManager::EnemyAirTech ||
+			capability == InformationManager::EnemyCloakTech ||
+			capability == InformationManager::EnemyOverlordHunters)
+		{
+			_newEnemyCapability = true;
+		}
+	});
+}
+
+// InformationManager was created first, by the constructor, so it is destroyed after us.
+StrategyBossZerg::~StrategyBossZerg()
+{
+	InformationManager::Instance().unsubscribeEnemyCapability(_capabilityToken);
 }
 
 // -- -- -- -- -- -- -- -- -- -- --
@@ -203,12 +227,7 @@ void StrategyBossZerg::updateGameState()
 
 	updateSupply();
 
-	// Army sizes don't need to be updated as often.
-	// -1 means it has not yet been updated for the first time.
-	if (BWAPI::Broodwar->getFrameCount() % 12 == 9)
-	{
-		updateArmySizes();
-	}
+	// Army sizes are updated by a scheduled task. See the constructor.
 
 	drawStrategyBossInformation();
 }
@@ -2040,11 +2059,21 @@ void StrategyBossZerg::vZergTechScores(const PlayerSnapshot & snap)
 }
 
 // Calculate scores used to decide on tech target and unit mix, based on what the opponent has.
+// With a lookahead, base them on what the opponent is predicted to have by then,
+// judging from the past games that best match this one. See OpponentModel::predictEnemy().
 void StrategyBossZerg::calculateTechScores(int lookaheadFrames)
 {
 	resetTechScores();
 
-	PlayerSnapshot snap(_enemy);
+	PlayerSnapshot snap;
+	if (lookaheadFrames > 0)
+	{
+		OpponentModel::Instance().predictEnemy(lookaheadFrames, snap);
+	}
+	else
+	{
+		snap.takeEnemy();
+	}
 
 	if (_enemyRace == BWAPI::Races::Protoss)
 	{
@@ -2481,9 +2510,11 @@ void StrategyBossZerg::chooseStrategy()
 		chooseEconomyRatio();
 	}
 
-	calculateTechScores(0);
+	// Tech takes time to get, so aim it at what the enemy should have a minute from now.
+	// Make units to fight what the enemy has now.
+	calculateTechScores(1 * 60 * 24);
 	chooseTechTarget();
-	// calculateTechScores(1 * 60 * 24);
+	calculateTechScores(0);
 	chooseUnitMix();
 	chooseAuxUnit();        // must be after the unit mix is set
 }
@@ -3157,8 +3188,9 @@ void StrategyBossZerg::handleUrgentProductionIssues(BuildOrderQueue & queue)
 	{
 		// Check for less urgent reactions less often.
 		int frameOffset = BWAPI::Broodwar->getFrameCount() % 32;
-		if (frameOffset == 0)
+		if (frameOffset == 0 || _newEnemyCapability)
 		{
+			_newEnemyCapability = false;
 			makeUrgentReaction(queue);
 			makeOverlords(queue);
 		}
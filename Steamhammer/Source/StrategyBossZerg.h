@@ -6,6 +6,7 @@
 
 namespace UAlbertaBot
 {
+class The;
 
 // Unit choices for main unit mix and tech target.
 // This deliberately omits support units like queens and defilers.
@@ -24,9 +25,12 @@ enum class TechUnit : int
 class StrategyBossZerg
 {
 	StrategyBossZerg::StrategyBossZerg();
+	~StrategyBossZerg();
 
 	const int absoluteMaxSupply = 400;     // 200 game supply max = 400 BWAPI supply
 
+	The & the;
+
 	BWAPI::Player _self;
 	BWAPI::Player _enemy;
 	BWAPI::Race _enemyRace;
@@ -59,6 +63,10 @@ class StrategyBossZerg
 	bool _emergencyGroundDefense;
 	int _emergencyStartFrame;
 
+	// The enemy showed air, cloak, or overlord hunters for the first time. React without waiting.
+	int _capabilityToken;
+	bool _newEnemyCapability;
+
 	int _existingSupply;
 	int _pendingSupply;
 	int _supplyUsed;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FlowField.h"
+#include "FrameScheduler.h"
 #include "MapPartitions.h"
 
 namespace UAlbertaBot
@@ -11,6 +13,8 @@ namespace UAlbertaBot
 		void initialize();
 
 		MapPartitions partitions;
+		FlowFields flowFields;
+		FrameScheduler scheduler;
 
 		static The & Root();
 	};
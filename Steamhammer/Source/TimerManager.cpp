@@ -1,5 +1,7 @@
 #include "TimerManager.h"
 
+#include "Profiler.h"
+
 using namespace UAlbertaBot;
 
 TimerManager::TimerManager() 
@@ -19,18 +21,34 @@ TimerManager::TimerManager()
 	_timerNames.push_back("MapGrid");
 	_timerNames.push_back("Search");
 	_timerNames.push_back("OpponentModel");
+	_timerNames.push_back("Scheduled");
 }
 
+// Each timer is also a profiler scope. The Total timer is the whole frame.
 void TimerManager::startTimer(const TimerManager::Type t)
 {
 	_timers[t].start();
+	if (t == Total)
+	{
+		Profiler::Instance().beginFrame();
+	}
+	else
+	{
+		Profiler::Instance().enter(_timerNames[t].c_str());
+	}
 }
 
 void TimerManager::stopTimer(const TimerManager::Type t)
 {
 	_timers[t].stop();
-	if (t == Total)
+	if (t != Total)
 	{
+		Profiler::Instance().leave();
+	}
+	else
+	{
+		Profiler::Instance().endFrame();
+
 		++_count;
 		double ms = getMilliseconds();
 		_maxMilliseconds = std::max(_maxMilliseconds, ms);
@@ -49,6 +49,9 @@ namespace Assert
         if (Config::IO::LogAssertToErrorFile)
         {
             Logger::LogAppendToFile(Config::IO::ErrorLogFilename, ss.str());
+
+            // We may be about to crash. Get this and everything logged before it onto disk.
+            Logger::Flush();
         }
     }
 }
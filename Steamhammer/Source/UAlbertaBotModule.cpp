@@ -12,6 +12,7 @@
 #include "Common.h"
 #include "OpponentModel.h"
 #include "ParseUtils.h"
+#include "Profiler.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
@@ -26,6 +27,11 @@ void UAlbertaBotModule::onStart()
 {
 	the.initialize();
 
+	// Start reading the opponent model on a background thread. It needs only
+	// the IO options from the config file, so it can overlap the slow map analysis below.
+	ParseUtils::ParseIOOptions(Config::ConfigFile::ConfigFileLocation);
+	OpponentModel::Instance().startRead();
+
     // Initialize BOSS, the Build Order Search System
     BOSS::init();
 
@@ -70,6 +76,17 @@ void UAlbertaBotModule::onEnd(bool isWinner)
 {
 	OpponentModel::Instance().setWin(isWinner);
 	OpponentModel::Instance().write();
+	OpponentModel::Instance().release();
+
+	BOSSManager::Instance().writeBuildOrderCache();
+
+	if (Config::IO::WriteProfile)
+	{
+		Profiler::Instance().write();
+	}
+
+	Logger::Flush();
+	Logger::Stop();
 }
 
 void UAlbertaBotModule::onFrame()
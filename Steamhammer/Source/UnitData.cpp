@@ -1,11 +1,16 @@
 #include "Common.h"
 #include "UnitData.h"
 
+#include "UnitUtil.h"
+
 using namespace UAlbertaBot;
 
 UnitData::UnitData() 
 	: mineralsLost(0)
 	, gasLost(0)
+	, maxCombatSimRange(0)
+	, cellColumns(0)
+	, cellRows(0)
 {
 	int maxTypeID(0);
 	for (const BWAPI::UnitType & t : BWAPI::UnitTypes::allUnitTypes())
@@ -15,6 +20,122 @@ UnitData::UnitData()
 
 	numUnits		= std::vector<int>(maxTypeID + 1, 0);
 	numDeadUnits	= std::vector<int>(maxTypeID + 1, 0);
+
+	unitsByType		= std::vector< std::vector<BWAPI::Unit> >(maxTypeID + 1);
+	unitsByCategory	= std::vector< std::vector<BWAPI::Unit> >(NumCategories);
+
+	// Work out the categories of each type once, so that indexing a unit is cheap.
+	typeCategories	= std::vector<unsigned int>(maxTypeID + 1, 0);
+	for (const BWAPI::UnitType & t : BWAPI::UnitTypes::allUnitTypes())
+	{
+		unsigned int & bits = typeCategories[t.getID()];
+		if (UnitUtil::IsCombatSimUnit(t))
+		{
+			bits |= 1 << CombatSimCategory;
+			maxCombatSimRange = std::max(maxCombatSimRange, UnitUtil::GetMaxAttackRange(t));
+		}
+		if (UnitUtil::IsStaticDefense(t))	{ bits |= 1 << StaticDefenseCategory; }
+		if (t.isDetector())					{ bits |= 1 << DetectorCategory; }
+		if (UnitUtil::TypeCanAttackAir(t))	{ bits |= 1 << AntiAirCategory; }
+		if (t.isFlyer())					{ bits |= 1 << FlyerCategory; }
+	}
+}
+
+void UnitData::addToIndexes(BWAPI::Unit unit, BWAPI::UnitType type)
+{
+	unitsByType[type.getID()].push_back(unit);
+
+	const unsigned int bits = typeCategories[type.getID()];
+	for (int c = 0; c < NumCategories; ++c)
+	{
+		if (bits & (1 << c))
+		{
+			unitsByCategory[c].push_back(unit);
+		}
+	}
+}
+
+// The lists are unordered, so remove by swapping with the last element.
+static void removeFromList(std::vector<BWAPI::Unit> & list, BWAPI::Unit unit)
+{
+	auto it = std::find(list.begin(), list.end(), unit);
+	if (it != list.end())
+	{
+		*it = list.back();
+		list.pop_back();
+	}
+}
+
+void UnitData::removeFromIndexes(BWAPI::Unit unit, BWAPI::UnitType type)
+{
+	removeFromList(unitsByType[type.getID()], unit);
+
+	const unsigned int bits = typeCategories[type.getID()];
+	for (int c = 0; c < NumCategories; ++c)
+	{
+		if (bits & (1 << c))
+		{
+			removeFromList(unitsByCategory[c], unit);
+		}
+	}
+}
+
+// The grid cell of a position, or -1 if the position is not on the map.
+int UnitData::cellIndex(const BWAPI::Position & pos) const
+{
+	if (!pos.isValid())
+	{
+		return -1;
+	}
+	return (pos.x / CellSize) * cellRows + pos.y / CellSize;
+}
+
+// Move the unit to the cell of its new position, if that is a different cell.
+void UnitData::updateCell(BWAPI::Unit unit, const BWAPI::Position & pos)
+{
+	if (cellColumns == 0)
+	{
+		cellColumns = (BWAPI::Broodwar->mapWidth() * 32 + CellSize - 1) / CellSize;
+		cellRows = (BWAPI::Broodwar->mapHeight() * 32 + CellSize - 1) / CellSize;
+		cells.resize(cellColumns * cellRows);
+	}
+
+	const int id = unit->getID();
+	if (id >= int(cellOf.size()))
+	{
+		cellOf.resize(id + 1, -1);
+	}
+
+	const int oldCell = cellOf[id];
+	const int newCell = cellIndex(pos);
+	if (oldCell != newCell)
+	{
+		if (oldCell >= 0)
+		{
+			removeFromList(cells[oldCell], unit);
+		}
+		if (newCell >= 0)
+		{
+			cells[newCell].push_back(unit);
+		}
+		cellOf[id] = newCell;
+	}
+}
+
+// Remove the entry by moving the last entry into its slot.
+void UnitData::eraseSlot(int slot)
+{
+	const BWAPI::Unit unit = unitMap[slot].first;
+	removeFromIndexes(unit, unitMap[slot].second.type);
+	updateCell(unit, BWAPI::Positions::None);
+
+	if (slot != int(unitMap.size()) - 1)
+	{
+		unitMap[slot] = unitMap.back();
+		slotOf[unitMap[slot].first->getID()] = slot;
+	}
+	unitMap.pop_back();
+	slotOf[unit->getID()] = -1;
 }
 
 // An enemy unit which is not visible, but whose lastPosition can be seen, is known
@@ -41,13 +162,27 @@ void UnitData::updateUnit(BWAPI::Unit unit)
 {
 	if (!unit) { return; }
 
-	if (unitMap.find(unit) == unitMap.end())
+	const int id = unit->getID();
+	if (id >= int(slotOf.size()))
+	{
+		slotOf.resize(id + 1, -1);
+	}
+
+	if (slotOf[id] < 0)
     {
 		++numUnits[unit->getType().getID()];
-		unitMap[unit] = UnitInfo();
+		slotOf[id] = int(unitMap.size());
+		unitMap.push_back(std::make_pair(unit, UnitInfo()));
+		addToIndexes(unit, unit->getType());
     }
-    
-	UnitInfo & ui   = unitMap[unit];
+	else if (unitMap[slotOf[id]].second.type != unit->getType())
+	{
+		// It morphed.
+		removeFromIndexes(unit, unitMap[slotOf[id]].second.type);
+		addToIndexes(unit, unit->getType());
+	}
+
+	UnitInfo & ui   = unitMap[slotOf[id]].second;
     ui.unit         = unit;
 	ui.updateFrame	= BWAPI::Broodwar->getFrameCount();
     ui.player       = unit->getPlayer();
@@ -55,9 +190,11 @@ void UnitData::updateUnit(BWAPI::Unit unit)
 	ui.goneFromLastPosition = false;
 	ui.lastHealth   = unit->getHitPoints();
     ui.lastShields  = unit->getShields();
-	ui.unitID       = unit->getID();
+	ui.unitID       = id;
 	ui.type         = unit->getType();
     ui.completed    = unit->isCompleted();
+
+	updateCell(unit, ui.lastPosition);
 }
 
 void UnitData::removeUnit(BWAPI::Unit unit)
@@ -69,7 +206,11 @@ void UnitData::removeUnit(BWAPI::Unit unit)
 	--numUnits[unit->getType().getID()];
 	++numDeadUnits[unit->getType().getID()];
 	
-	unitMap.erase(unit);
+	const int id = unit->getID();
+	if (id < int(slotOf.size()) && slotOf[id] >= 0)
+	{
+		eraseSlot(slotOf[id]);
+	}
 
 	// NOTE This assert fails, so the unit counts cannot be trusted. :-(
 	// UAB_ASSERT(numUnits[unit->getType().getID()] >= 0, "negative units");
@@ -77,16 +218,16 @@ void UnitData::removeUnit(BWAPI::Unit unit)
 
 void UnitData::removeBadUnits()
 {
-	for (auto iter(unitMap.begin()); iter != unitMap.end();)
+	for (int slot = 0; slot < int(unitMap.size());)
 	{
-		if (badUnitInfo(iter->second))
+		if (badUnitInfo(unitMap[slot].second))
 		{
-			numUnits[iter->second.type.getID()]--;
-			iter = unitMap.erase(iter);
+			numUnits[unitMap[slot].second.type.getID()]--;
+			eraseSlot(slot);		// moves another entry into this slot
 		}
 		else
 		{
-			iter++;
+			slot++;
 		}
 	}
 }
@@ -134,7 +275,103 @@ int UnitData::getNumDeadUnits(BWAPI::UnitType t) const
     return numDeadUnits[t.getID()]; 
 }
 
-const std::map<BWAPI::Unit,UnitInfo> & UnitData::getUnits() const 
+const UIMap & UnitData::getUnits() const 
 { 
     return unitMap; 
-}
\ No newline at end of file
+}
+
+const UnitInfo * UnitData::getUnitInfo(BWAPI::Unit unit) const
+{
+	const int id = unit->getID();
+	if (id < int(slotOf.size()) && slotOf[id] >= 0)
+	{
+		return &unitMap[slotOf[id]].second;
+	}
+	return nullptr;
+}
+
+const std::vector<BWAPI::Unit> & UnitData::getUnits(BWAPI::UnitType t) const
+{
+	return unitsByType[t.getID()];
+}
+
+const std::vector<BWAPI::Unit> & UnitData::getUnits(Category c) const
+{
+	return unitsByCategory[c];
+}
+
+// Collect the units in the cells that overlap the given pixel box, inclusive.
+// The caller checks the exact area.
+void UnitData::getUnitsInCells(std::vector<BWAPI::Unit> & units, int left, int top, int right, int bottom, unsigned int categoryMask) const
+{
+	if (cellColumns == 0)
+	{
+		return;
+	}
+
+	const int cellLeft = std::max(0, left / CellSize);
+	const int cellTop = std::max(0, top / CellSize);
+	const int cellRight = std::min(cellColumns - 1, right / CellSize);
+	const int cellBottom = std::min(cellRows - 1, bottom / CellSize);
+
+	for (int x = cellLeft; x <= cellRight; ++x)
+	{
+		for (int y = cellTop; y <= cellBottom; ++y)
+		{
+			for (const BWAPI::Unit unit : cells[x * cellRows + y])
+			{
+				if (!categoryMask || (typeCategories[getUnitInfo(unit)->type.getID()] & categoryMask))
+				{
+					units.push_back(unit);
+				}
+			}
+		}
+	}
+}
+
+void UnitData::collectInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius, unsigned int categoryMask) const
+{
+	std::vector<BWAPI::Unit> candidates;
+	getUnitsInCells(candidates, center.x - radius, center.y - radius, center.x + radius, center.y + radius, categoryMask);
+	for (const BWAPI::Unit unit : candidates)
+	{
+		if (getUnitInfo(unit)->lastPosition.getDistance(center) <= radius)
+		{
+			units.push_back(unit);
+		}
+	}
+}
+
+void UnitData::collectInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight, unsigned int categoryMask) const
+{
+	std::vector<BWAPI::Unit> candidates;
+	getUnitsInCells(candidates, topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, categoryMask);
+	for (const BWAPI::Unit unit : candidates)
+	{
+		const BWAPI::Position & pos = getUnitInfo(unit)->lastPosition;
+		if (pos.x >= topLeft.x && pos.y >= topLeft.y && pos.x <= bottomRight.x && pos.y <= bottomRight.y)
+		{
+			units.push_back(unit);
+		}
+	}
+}
+
+void UnitData::getUnitsInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius) const
+{
+	collectInRadius(units, center, radius, 0);
+}
+
+void UnitData::getUnitsInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius, Category c) const
+{
+	collectInRadius(units, center, radius, 1 << c);
+}
+
+void UnitData::getUnitsInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight) const
+{
+	collectInRectangle(units, topLeft, bottomRight, 0);
+}
+
+void UnitData::getUnitsInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight, Category c) const
+{
+	collectInRectangle(units, topLeft, bottomRight, 1 << c);
+}
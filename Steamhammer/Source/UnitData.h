@@ -65,14 +65,54 @@ struct UnitInfo
 };
 
 typedef std::vector<UnitInfo> UnitInfoVector;
-typedef std::map<BWAPI::Unit,UnitInfo> UIMap;
+
+// The known units, packed into an array for fast iteration. Each element is (unit, info).
+// Elements move when a unit is removed, so don't keep pointers or indexes into it.
+typedef std::vector< std::pair<BWAPI::Unit, UnitInfo> > UIMap;
 
 class UnitData
 {
+public:
+	// Categories of unit types, each with its own list of units.
+	enum Category
+	{
+		CombatSimCategory,		// UnitUtil::IsCombatSimUnit()
+		StaticDefenseCategory,	// UnitUtil::IsStaticDefense()
+		DetectorCategory,
+		AntiAirCategory,		// has an air weapon (including bunkers)
+		FlyerCategory,
+		NumCategories
+	};
+
+private:
     UIMap unitMap;
 
+	std::vector<int>						slotOf;				// per unit ID, index into unitMap, or -1
+	std::vector< std::vector<BWAPI::Unit> >	unitsByType;		// per type ID
+	std::vector< std::vector<BWAPI::Unit> >	unitsByCategory;	// per Category
+	std::vector<unsigned int>				typeCategories;		// per type ID, bit set of its categories
+	int										maxCombatSimRange;	// longest attack range of any combat sim type
+
+	// A uniform grid over the map, each cell listing the units whose lastPosition is in it.
+	// Radius and box queries look only at the cells that overlap the area.
+	static const int CellSize = 8 * 32;		// pixels
+	int										cellColumns;		// 0 until the grid is made
+	int										cellRows;
+	std::vector< std::vector<BWAPI::Unit> >	cells;
+	std::vector<int>						cellOf;				// per unit ID, index into cells, or -1
+
+	int		cellIndex(const BWAPI::Position & pos) const;
+	void	updateCell(BWAPI::Unit unit, const BWAPI::Position & pos);
+	void	getUnitsInCells(std::vector<BWAPI::Unit> & units, int left, int top, int right, int bottom, unsigned int categoryMask) const;
+	void	collectInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius, unsigned int categoryMask) const;
+	void	collectInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight, unsigned int categoryMask) const;
+
     const bool badUnitInfo(const UnitInfo & ui) const;
 
+	void	addToIndexes(BWAPI::Unit unit, BWAPI::UnitType type);
+	void	removeFromIndexes(BWAPI::Unit unit, BWAPI::UnitType type);
+	void	eraseSlot(int slot);
+
     std::vector<int>						numUnits;       // how many now
 	std::vector<int>						numDeadUnits;   // how many lost
 
@@ -93,6 +133,24 @@ public:
     int		getMineralsLost()                           const;
     int		getNumUnits(BWAPI::UnitType t)              const;
     int		getNumDeadUnits(BWAPI::UnitType t)          const;
-    const	std::map<BWAPI::Unit,UnitInfo> & getUnits() const;
+    const	UIMap & getUnits()                          const;
+
+	// Null if the unit is not known.
+	const UnitInfo * getUnitInfo(BWAPI::Unit unit) const;
+
+	// The known units of one type, or of one category. Look up their UnitInfo with getUnitInfo().
+	// Unlike getNumUnits(), these are exact.
+	const std::vector<BWAPI::Unit> & getUnits(BWAPI::UnitType t) const;
+	const std::vector<BWAPI::Unit> & getUnits(Category c) const;
+	bool	hasUnits(BWAPI::UnitType t) const { return !getUnits(t).empty(); };
+
+	// Append the known units whose lastPosition is in the area, optionally of one category only.
+	// Units with unknown positions are never included.
+	void	getUnitsInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius) const;
+	void	getUnitsInRadius(std::vector<BWAPI::Unit> & units, const BWAPI::Position & center, int radius, Category c) const;
+	void	getUnitsInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight) const;
+	void	getUnitsInRectangle(std::vector<BWAPI::Unit> & units, const BWAPI::Position & topLeft, const BWAPI::Position & bottomRight, Category c) const;
+
+	int		getMaxCombatSimRange() const { return maxCombatSimRange; };
 };
 }
\ No newline at end of file
@@ -432,110 +432,162 @@ int UnitUtil::GetWeaponDamageToWorker(BWAPI::Unit attacker)
 	return damage;
 }
 
-// All our units, whether completed or not.
-int UnitUtil::GetAllUnitCount(BWAPI::UnitType type)
+// Does the unit count as one or more of the given type, counting eggs, cocoons, and
+// units whose training has just started? Return the number, usually 0.
+// If uncompletedOnly, a unit of the type itself counts only if it is not completed.
+static int countAs(BWAPI::Unit unit, BWAPI::UnitType type, bool uncompletedOnly)
 {
-    int count = 0;
-    for (const auto unit : BWAPI::Broodwar->self()->getUnits())
-    {
-        if (unit->getType() == type)
-        {
-            ++count;
-        }
-
-        // Units in the egg.
-        else if (unit->getType() == BWAPI::UnitTypes::Zerg_Egg && unit->getBuildType() == type)
-        {
-            count += type.isTwoUnitsInOneEgg() ? 2 : 1;
-        }
-
-		// Lurkers in the egg.
-		else if (unit->getType() == BWAPI::UnitTypes::Zerg_Lurker_Egg && type == BWAPI::UnitTypes::Zerg_Lurker)
-		{
-			++count;
-		}
+	if (!uncompletedOnly && unit->getType() == type)
+	{
+		return 1;
+	}
 
-		// Guardians or devourers in the cocoon.
-		else if (unit->getType() == BWAPI::UnitTypes::Zerg_Cocoon && unit->getBuildType() == type)
-		{
-			++count;
-		}
+	// Units in the egg.
+	if (unit->getType() == BWAPI::UnitTypes::Zerg_Egg && unit->getBuildType() == type)
+	{
+		return type.isTwoUnitsInOneEgg() ? 2 : 1;
+	}
 
-        // case where a building has started constructing a unit but it doesn't yet have a unit associated with it
-        else if (unit->getRemainingTrainTime() > 0)
-        {
-            BWAPI::UnitType trainType = unit->getLastCommand().getUnitType();
-
-			// NOTE Comparing the time like this could lead to miscounts if units start simultaneously.
-			//      But the original UAlbertaBot production system does not start units simultaneously.
-            if (trainType == type && unit->getRemainingTrainTime() == trainType.buildTime())
-            {
-                ++count;
-            }
-        }
-    }
+	// Lurkers in the egg.
+	if (unit->getType() == BWAPI::UnitTypes::Zerg_Lurker_Egg && type == BWAPI::UnitTypes::Zerg_Lurker)
+	{
+		return 1;
+	}
 
-    return count;
-}
+	// Guardians or devourers in the cocoon.
+	if (unit->getType() == BWAPI::UnitTypes::Zerg_Cocoon && unit->getBuildType() == type)
+	{
+		return 1;
+	}
 
-// Only our completed units.
-int UnitUtil::GetCompletedUnitCount(BWAPI::UnitType type)
-{
-	int count = 0;
-	for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+	// case where a building has started constructing a unit but it doesn't yet have a unit associated with it
+	if (unit->getRemainingTrainTime() > 0)
 	{
-		if (unit->getType() == type && unit->isCompleted())
-		{
-			++count;
-		}
+		BWAPI::UnitType trainType = unit->getLastCommand().getUnitType();
+
+		// NOTE Comparing the time like this could lead to miscounts if units start simultaneously.
+		//      But the original UAlbertaBot production system does not start units simultaneously.
+		return trainType == type && unit->getRemainingTrainTime() == trainType.buildTime() ? 1 : 0;
+	}
+
+	// The basic case.
+	if (uncompletedOnly && unit->getType() == type && !unit->isCompleted())
+	{
+		return 1;
 	}
 
-	return count;
+	return 0;
 }
 
-// Only our incomplete units.
-int UnitUtil::GetUncompletedUnitCount(BWAPI::UnitType type)
+// A census of our units by type, taken at most once per frame on demand.
+// Unit counts are asked for many times per frame (the zerg strategy boss alone asks
+// dozens of times), and each count used to loop through all our units.
+// BWAPI unit state does not change within a frame, so one pass answers every count.
+// NOTE Counting by events instead doesn't work: training a unit starts with no event.
+namespace
 {
-	int count = 0;
-	for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+	class UnitCensus
 	{
-		// Units in the egg.
-		if (unit->getType() == BWAPI::UnitTypes::Zerg_Egg && unit->getBuildType() == type)
-		{
-			count += type.isTwoUnitsInOneEgg() ? 2 : 1;
-		}
+		int frame;
+		std::vector<int> all;
+		std::vector<int> completed;
+		std::vector<int> uncompleted;
 
-		// Lurkers in the egg.
-		else if (unit->getType() == BWAPI::UnitTypes::Zerg_Lurker_Egg && type == BWAPI::UnitTypes::Zerg_Lurker)
+		void take()
 		{
-			++count;
+			std::fill(all.begin(), all.end(), 0);
+			std::fill(completed.begin(), completed.end(), 0);
+			std::fill(uncompleted.begin(), uncompleted.end(), 0);
+
+			for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+			{
+				const BWAPI::UnitType type = unit->getType();
+
+				if (unit->isCompleted())
+				{
+					++completed[type.getID()];
+				}
+
+				// The types this unit might count as. Count each type once.
+				BWAPI::UnitType candidates[4] = { type, BWAPI::UnitTypes::None, BWAPI::UnitTypes::None, BWAPI::UnitTypes::None };
+				if (type == BWAPI::UnitTypes::Zerg_Egg || type == BWAPI::UnitTypes::Zerg_Cocoon)
+				{
+					candidates[1] = unit->getBuildType();
+				}
+				else if (type == BWAPI::UnitTypes::Zerg_Lurker_Egg)
+				{
+					candidates[1] = BWAPI::UnitTypes::Zerg_Lurker;
+				}
+				if (unit->getRemainingTrainTime() > 0)
+				{
+					candidates[2] = unit->getLastCommand().getUnitType();
+				}
+
+				for (int i = 0; i < 3; ++i)
+				{
+					const BWAPI::UnitType t = candidates[i];
+					if (t == BWAPI::UnitTypes::None ||
+						(i > 0 && t == candidates[0]) ||
+						(i > 1 && t == candidates[1]))
+					{
+						continue;
+					}
+					all[t.getID()] += countAs(unit, t, false);
+					uncompleted[t.getID()] += countAs(unit, t, true);
+				}
+			}
 		}
 
-		// Guardians or devourers in the cocoon.
-		else if (unit->getType() == BWAPI::UnitTypes::Zerg_Cocoon && unit->getBuildType() == type)
+	public:
+		UnitCensus()
+			: frame(-1)
 		{
-			++count;
 		}
 
-		// case where a building has started constructing a unit but it doesn't yet have a unit associated with it
-		else if (unit->getRemainingTrainTime() > 0)
+		void update()
 		{
-			BWAPI::UnitType trainType = unit->getLastCommand().getUnitType();
+			if (all.empty())
+			{
+				// Sized on first use, not at static initialization time.
+				int maxTypeID = 0;
+				for (const BWAPI::UnitType & t : BWAPI::UnitTypes::allUnitTypes())
+				{
+					maxTypeID = std::max(maxTypeID, t.getID());
+				}
+				all.assign(maxTypeID + 1, 0);
+				completed.assign(maxTypeID + 1, 0);
+				uncompleted.assign(maxTypeID + 1, 0);
+			}
 
-			// NOTE Comparing the time like this could lead to miscounts if units start simultaneously.
-			//      But the original UAlbertaBot production system does not start units simultaneously.
-			if (trainType == type && unit->getRemainingTrainTime() == trainType.buildTime())
+			if (frame != BWAPI::Broodwar->getFrameCount())
 			{
-				++count;
+				frame = BWAPI::Broodwar->getFrameCount();
+				take();
 			}
 		}
 
-		// The basic case.
-		else if (unit->getType() == type && !unit->isCompleted())
-		{
-			++count;
-		}
-	}
+		int getAll(BWAPI::UnitType type)			{ update(); return all[type.getID()]; }
+		int getCompleted(BWAPI::UnitType type)		{ update(); return completed[type.getID()]; }
+		int getUncompleted(BWAPI::UnitType type)	{ update(); return uncompleted[type.getID()]; }
+	};
+
+	UnitCensus census;
+}
 
-	return count;
+// All our units, whether completed or not.
+int UnitUtil::GetAllUnitCount(BWAPI::UnitType type)
+{
+	return census.getAll(type);
+}
+
+// Only our completed units.
+int UnitUtil::GetCompletedUnitCount(BWAPI::UnitType type)
+{
+	return census.getCompleted(type);
+}
+
+// Only our incomplete units.
+int UnitUtil::GetUncompletedUnitCount(BWAPI::UnitType type)
+{
+	return census.getUncompleted(type);
 }
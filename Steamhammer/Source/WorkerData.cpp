@@ -3,14 +3,175 @@
 
 using namespace UAlbertaBot;
 
+// A worker mines a patch for about this many frames, and only one worker can mine
+// a patch at a time. Other workers that arrive wait their turn.
+const int MiningFrames = 80;
+
+// Frames lost on each round trip to acceleration, turning, and handing in the cargo.
+const int TurnaroundFrames = 30;
+
+WorkerData::WorkerRecord::WorkerRecord()
+	: unit(nullptr)
+	, counted(false)
+	, job(Default)
+	, jobUnit(nullptr)
+	, mineral(nullptr)
+	, buildingType(BWAPI::UnitTypes::None)
+	, nextAtJobUnit(-1)
+	, prevAtJobUnit(-1)
+	, nextAtMineral(-1)
+	, prevAtMineral(-1)
+{
+}
+
 WorkerData::WorkerData() 
 {
-    for (const auto unit : BWAPI::Broodwar->getAllUnits())
+	std::fill(jobCounts, jobCounts + Default + 1, 0);
+}
+
+// The record for the unit, created if necessary.
+WorkerData::WorkerRecord & WorkerData::record(BWAPI::Unit unit)
+{
+	const size_t id = unit->getID();
+	if (id >= workerRecords.size())
 	{
-		if ((unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field))
-		{
-            workersOnMineralPatch[unit] = 0;
-		}
+		workerRecords.resize(id + 1);
+	}
+	WorkerRecord & rec = workerRecords[id];
+	rec.unit = unit;
+	return rec;
+}
+
+// The record for the unit, or null if we have never seen it.
+const WorkerData::WorkerRecord * WorkerData::findRecord(BWAPI::Unit unit) const
+{
+	if (!unit || size_t(unit->getID()) >= workerRecords.size())
+	{
+		return nullptr;
+	}
+	const WorkerRecord & rec = workerRecords[unit->getID()];
+	return rec.unit ? &rec : nullptr;
+}
+
+WorkerData::ResourceRecord & WorkerData::resourceRecord(BWAPI::Unit unit)
+{
+	const size_t id = unit->getID();
+	if (id >= resourceRecords.size())
+	{
+		resourceRecords.resize(id + 1);
+	}
+	return resourceRecords[id];
+}
+
+const WorkerData::ResourceRecord * WorkerData::findResourceRecord(BWAPI::Unit unit) const
+{
+	if (!unit || size_t(unit->getID()) >= resourceRecords.size())
+	{
+		return nullptr;
+	}
+	return &resourceRecords[unit->getID()];
+}
+
+void WorkerData::addToWorkers(BWAPI::Unit unit)
+{
+	workers.insert(unit);
+
+	WorkerRecord & rec = record(unit);
+	if (!rec.counted)
+	{
+		rec.counted = true;
+		++jobCounts[rec.job];
+	}
+}
+
+// Change the job, keeping the job counts up to date.
+void WorkerData::setJob(WorkerRecord & rec, WorkerJob job)
+{
+	if (rec.counted)
+	{
+		--jobCounts[rec.job];
+		++jobCounts[job];
+	}
+	rec.job = job;
+}
+
+// Put the worker at the head of the list.
+// next and prev select which pair of links to use: Depot/refinery or mineral patch.
+void WorkerData::link(WorkerRecord & rec, WorkerList & list, int WorkerRecord::* next, int WorkerRecord::* prev)
+{
+	const int id = rec.unit->getID();
+
+	rec.*prev = -1;
+	rec.*next = list.first;
+	if (list.first >= 0)
+	{
+		workerRecords[list.first].*prev = id;
+	}
+	list.first = id;
+	++list.count;
+}
+
+void WorkerData::unlink(WorkerRecord & rec, WorkerList & list, int WorkerRecord::* next, int WorkerRecord::* prev)
+{
+	if (rec.*prev >= 0)
+	{
+		workerRecords[rec.*prev].*next = rec.*next;
+	}
+	else
+	{
+		list.first = rec.*next;
+	}
+	if (rec.*next >= 0)
+	{
+		workerRecords[rec.*next].*prev = rec.*prev;
+	}
+	rec.*next = -1;
+	rec.*prev = -1;
+	--list.count;
+}
+
+void WorkerData::linkToJobUnit(WorkerRecord & rec, BWAPI::Unit jobUnit)
+{
+	rec.jobUnit = jobUnit;
+	if (jobUnit)
+	{
+		link(rec, resourceRecord(jobUnit).atJobUnit, &WorkerRecord::nextAtJobUnit, &WorkerRecord::prevAtJobUnit);
+	}
+}
+
+void WorkerData::unlinkFromJobUnit(WorkerRecord & rec)
+{
+	if (rec.jobUnit)
+	{
+		unlink(rec, resourceRecord(rec.jobUnit).atJobUnit, &WorkerRecord::nextAtJobUnit, &WorkerRecord::prevAtJobUnit);
+	}
+	rec.jobUnit = nullptr;
+}
+
+// A change at a depot's patches means its assignment may be improvable.
+void WorkerData::linkToMineral(WorkerRecord & rec, BWAPI::Unit mineral)
+{
+	rec.mineral = mineral;
+	if (mineral)
+	{
+		link(rec, resourceRecord(mineral).atMineral, &WorkerRecord::nextAtMineral, &WorkerRecord::prevAtMineral);
+	}
+	if (rec.jobUnit)
+	{
+		resourceRecord(rec.jobUnit).needsRebalance = true;
+	}
+}
+
+void WorkerData::unlinkFromMineral(WorkerRecord & rec)
+{
+	if (rec.mineral)
+	{
+		unlink(rec, resourceRecord(rec.mineral).atMineral, &WorkerRecord::nextAtMineral, &WorkerRecord::prevAtMineral);
+	}
+	rec.mineral = nullptr;
+	if (rec.jobUnit)
+	{
+		resourceRecord(rec.jobUnit).needsRebalance = true;
 	}
 }
 
@@ -20,14 +181,21 @@ void WorkerData::workerDestroyed(BWAPI::Unit unit)
 
 	clearPreviousJob(unit);
 	workers.erase(unit);
+
+	WorkerRecord & rec = record(unit);
+	if (rec.counted)
+	{
+		rec.counted = false;
+		--jobCounts[rec.job];
+	}
 }
 
 void WorkerData::addWorker(BWAPI::Unit unit)
 {
 	if (!unit || !unit->exists()) { return; }
 
-	workers.insert(unit);
-	workerJobMap[unit] = Default;
+	addToWorkers(unit);
+	clearPreviousJob(unit);
 }
 
 void WorkerData::addWorker(BWAPI::Unit unit, WorkerJob job, BWAPI::Unit jobUnit)
@@ -36,7 +204,7 @@ void WorkerData::addWorker(BWAPI::Unit unit, WorkerJob job, BWAPI::Unit jobUnit)
 
 	assert(workers.find(unit) == workers.end());
 
-	workers.insert(unit);
+	addToWorkers(unit);
 	setWorkerJob(unit, job, jobUnit);
 }
 
@@ -45,7 +213,7 @@ void WorkerData::addWorker(BWAPI::Unit unit, WorkerJob job, BWAPI::UnitType jobU
 	if (!unit || !unit->exists()) { return; }
 
 	assert(workers.find(unit) == workers.end());
-	workers.insert(unit);
+	addToWorkers(unit);
 	setWorkerJob(unit, job, jobUnitType);
 }
 
@@ -55,7 +223,7 @@ void WorkerData::addDepot(BWAPI::Unit unit)
 
 	assert(depots.find(unit) == depots.end());
 	depots.insert(unit);
-	depotWorkerCount[unit] = 0;
+	initPatches(unit);
 }
 
 void WorkerData::removeDepot(BWAPI::Unit unit)
@@ -63,60 +231,40 @@ void WorkerData::removeDepot(BWAPI::Unit unit)
 	if (!unit) { return; }
 
 	depots.erase(unit);
-	depotWorkerCount.erase(unit);
 
 	// re-balance workers in here
-	for (auto & worker : workers)
+	// Copy the list first, since changing jobs unlinks the workers from it.
+	std::vector<BWAPI::Unit> depotWorkers;
+	getWorkersAt(unit, depotWorkers);
+	for (const auto worker : depotWorkers)
 	{
-		// if a worker was working at this depot
-		if (workerDepotMap[worker] == unit)
-		{
-			setWorkerJob(worker, Idle, nullptr);
-		}
+		setWorkerJob(worker, Idle, nullptr);
 	}
 }
 
-void WorkerData::addToMineralPatch(BWAPI::Unit unit, int num)
-{
-    if (workersOnMineralPatch.find(unit) == workersOnMineralPatch.end())
-    {
-        workersOnMineralPatch[unit] = num;
-    }
-    else
-    {
-        workersOnMineralPatch[unit] += num;
-    }
-}
-
 void WorkerData::setWorkerJob(BWAPI::Unit unit, WorkerJob job, BWAPI::Unit jobUnit)
 {
 	if (!unit || !unit->exists()) { return; }
 
 	clearPreviousJob(unit);
-	workerJobMap[unit] = job;
+	WorkerRecord & rec = record(unit);
+	setJob(rec, job);
 
 	if (job == Minerals)
 	{
-		// increase the number of workers assigned to this nexus
-		depotWorkerCount[jobUnit] += 1;
-
-		// set the mineral the worker is working on
-		workerDepotMap[unit] = jobUnit;
+		// set the depot the worker is working from, and count it there
+		linkToJobUnit(rec, jobUnit);
 
         BWAPI::Unit mineralToMine = getMineralToMine(unit);
-        workerMineralAssignment[unit] = mineralToMine;
-        addToMineralPatch(mineralToMine, 1);
+		linkToMineral(rec, mineralToMine);
 
 		// right click the mineral to start mining
 		Micro::RightClick(unit, mineralToMine);
 	}
 	else if (job == Gas)
 	{
-		// increase the count of workers assigned to this refinery
-		refineryWorkerCount[jobUnit] += 1;
-
-		// set the refinery the worker is working on
-		workerRefineryMap[unit] = jobUnit;
+		// set the refinery the worker is working on, and count it there
+		linkToJobUnit(rec, jobUnit);
 
 		// right click the refinery to start harvesting
 		Micro::RightClick(unit, jobUnit);
@@ -127,7 +275,7 @@ void WorkerData::setWorkerJob(BWAPI::Unit unit, WorkerJob job, BWAPI::Unit jobUn
         assert(unit->getType() == BWAPI::UnitTypes::Terran_SCV);
 
         // set the building the worker is to repair
-        workerRepairMap[unit] = jobUnit;
+        rec.jobUnit = jobUnit;
 
         // start repairing 
         if (!unit->isRepairing())
@@ -150,16 +298,12 @@ void WorkerData::setWorkerJob(BWAPI::Unit unit, WorkerJob job, BWAPI::UnitType j
 	if (!unit) { return; }
 
 	clearPreviousJob(unit);
-	workerJobMap[unit] = job;
+	WorkerRecord & rec = record(unit);
+	setJob(rec, job);
 
 	if (job == Build)
 	{
-		workerBuildingTypeMap[unit] = jobUnitType;
-	}
-
-	if (workerJobMap[unit] != Build)
-	{
-		//BWAPI::Broodwar->printf("Something went horribly wrong");
+		rec.buildingType = jobUnitType;
 	}
 }
 
@@ -168,56 +312,34 @@ void WorkerData::setWorkerJob(BWAPI::Unit unit, WorkerJob job, WorkerMoveData wm
 	if (!unit) { return; }
 
 	clearPreviousJob(unit);
-	workerJobMap[unit] = job;
+	WorkerRecord & rec = record(unit);
+	setJob(rec, job);
 
 	if (job == Move)
 	{
-		workerMoveMap[unit] = wmd;
-	}
-
-	if (workerJobMap[unit] != Move)
-	{
-		//BWAPI::Broodwar->printf("Something went horribly wrong");
+		rec.moveData = wmd;
 	}
 }
 
 void WorkerData::clearPreviousJob(BWAPI::Unit unit)
 {
-	if (!unit) { return; }
+	if (!unit || !findRecord(unit)) { return; }
 
-	WorkerJob previousJob = getWorkerJob(unit);
+	WorkerRecord & rec = record(unit);
 
-	if (previousJob == Minerals)
-	{
-		depotWorkerCount[workerDepotMap[unit]] -= 1;
-
-		workerDepotMap.erase(unit);
-
-        // remove a worker from this unit's assigned mineral patch
-        addToMineralPatch(workerMineralAssignment[unit], -1);
-
-        // erase the association from the map
-        workerMineralAssignment.erase(unit);
-	}
-	else if (previousJob == Gas)
-	{
-		refineryWorkerCount[workerRefineryMap[unit]] -= 1;
-		workerRefineryMap.erase(unit);
-	}
-	else if (previousJob == Build)
-	{
-		workerBuildingTypeMap.erase(unit);
-	}
-	else if (previousJob == Repair)
+	if (rec.job == Minerals)
 	{
-		workerRepairMap.erase(unit);
+		unlinkFromMineral(rec);
+		unlinkFromJobUnit(rec);
 	}
-	else if (previousJob == Move)
+	else if (rec.job == Gas)
 	{
-		workerMoveMap.erase(unit);
+		unlinkFromJobUnit(rec);
 	}
 
-	workerJobMap.erase(unit);
+	rec.jobUnit = nullptr;
+	rec.buildingType = BWAPI::UnitTypes::None;
+	setJob(rec, Default);
 }
 
 int WorkerData::getNumWorkers() const
@@ -227,91 +349,50 @@ int WorkerData::getNumWorkers() const
 
 int WorkerData::getNumMineralWorkers() const
 {
-	size_t num = 0;
-	for (auto & unit : workers)
-	{
-		if (workerJobMap.at(unit) == WorkerData::Minerals)
-		{
-			num++;
-		}
-	}
-	return num;
+	return jobCounts[Minerals];
 }
 
 int WorkerData::getNumGasWorkers() const
 {
-	size_t num = 0;
-	for (auto & unit : workers)
-	{
-		if (workerJobMap.at(unit) == WorkerData::Gas)
-		{
-			num++;
-		}
-	}
-	return num;
+	return jobCounts[Gas];
 }
 
 int WorkerData::getNumReturnCargoWorkers() const
 {
-	size_t num = 0;
-	for (auto & unit : workers)
-	{
-		if (workerJobMap.at(unit) == WorkerData::ReturnCargo)
-		{
-			num++;
-		}
-	}
-	return num;
+	return jobCounts[ReturnCargo];
 }
 
 int WorkerData::getNumCombatWorkers() const
 {
-	size_t num = 0;
-	for (auto & unit : workers)
-	{
-		if (workerJobMap.at(unit) == WorkerData::Combat)
-		{
-			num++;
-		}
-	}
-	return num;
+	return jobCounts[Combat];
 }
 
 int WorkerData::getNumIdleWorkers() const
 {
-	size_t num = 0;
-	for (auto & unit : workers)
-	{
-		if (workerJobMap.at(unit) == WorkerData::Idle)
-		{
-			num++;
-		}
-	}
-	return num;
+	return jobCounts[Idle];
 }
 
 enum WorkerData::WorkerJob WorkerData::getWorkerJob(BWAPI::Unit unit)
 {
-	if (!unit) { return Default; }
-
-	std::map<BWAPI::Unit, enum WorkerJob>::iterator it = workerJobMap.find(unit);
-
-	if (it != workerJobMap.end())
-	{
-		return it->second;
-	}
+	const WorkerRecord * rec = findRecord(unit);
 
-	return Default;
+	return rec ? rec->job : Default;
 }
 
 bool WorkerData::depotIsFull(BWAPI::Unit depot)
 {
 	if (!depot) { return false; }
 
-	int assignedWorkers = getNumAssignedWorkers(depot);
-	int mineralsNearDepot = getMineralsNearDepot(depot);
+	return getNumAssignedWorkers(depot) >= getDepotCapacity(depot);
+}
+
+// The number of mineral workers the depot wants.
+int WorkerData::getDepotCapacity(BWAPI::Unit depot)
+{
+	if (!depot) { return 0; }
 
-	return assignedWorkers >= int (Config::Macro::WorkersPerPatch * mineralsNearDepot + 0.5);
+	initPatches(depot);
+	return int (Config::Macro::WorkersPerPatch * resourceRecord(depot).mineralsNear + 0.5);
 }
 
 BWAPI::Unitset WorkerData::getMineralPatchesNearDepot(BWAPI::Unit depot)
@@ -363,152 +444,333 @@ int WorkerData::getMineralsNearDepot(BWAPI::Unit depot)
 
 BWAPI::Unit WorkerData::getWorkerResource(BWAPI::Unit unit)
 {
-	if (!unit) { return nullptr; }
+	const WorkerRecord * rec = findRecord(unit);
+	if (!rec) { return nullptr; }
 
-	// create the iterator
-	std::map<BWAPI::Unit, BWAPI::Unit>::iterator it;
-	
-	// if the worker is mining, set the iterator to the mineral map
-	if (getWorkerJob(unit) == Minerals)
+	if (rec->job == Minerals)
 	{
-		it = workerMineralAssignment.find(unit);
-		if (it != workerMineralAssignment.end())
-		{
-			return it->second;
-		}	
+		return rec->mineral;
 	}
-	else if (getWorkerJob(unit) == Gas)
+	if (rec->job == Gas)
 	{
-		it = workerRefineryMap.find(unit);
-		if (it != workerRefineryMap.end())
-		{
-			return it->second;
-		}	
+		return rec->jobUnit;
 	}
 
 	return nullptr;
 }
 
+// The patch where one more worker adds the most income.
 BWAPI::Unit WorkerData::getMineralToMine(BWAPI::Unit worker)
 {
 	if (!worker) { return nullptr; }
 
 	// get the depot associated with this unit
 	BWAPI::Unit depot = getWorkerDepot(worker);
-	BWAPI::Unit bestMineral = nullptr;
-	int bestDist = 100000;
-    int bestNumAssigned = 10000;
+	if (!depot)
+	{
+		return nullptr;
+	}
+
+	initPatches(depot);
+	const ResourceRecord & depotRec = resourceRecords[depot->getID()];
+	const int i = bestPatchToAdd(depotRec);
+	return i < 0 ? nullptr : depotRec.patches[i];
+}
 
-	if (depot)
+// Find the depot's mineral patches and the round trip time to each, if we haven't yet.
+// The patches only change when one is mined out; see mineralDestroyed().
+void WorkerData::initPatches(BWAPI::Unit depot)
+{
+	if (resourceRecord(depot).patchesKnown)
 	{
-        BWAPI::Unitset mineralPatches = getMineralPatchesNearDepot(depot);
+		return;
+	}
+
+	const double speed = BWAPI::Broodwar->self()->getRace().getWorker().topSpeed();
 
-		for (const auto mineral : mineralPatches)
+	std::vector<BWAPI::Unit> patches;
+	std::vector<int> tripFrames;
+	for (const auto mineral : getMineralPatchesNearDepot(depot))
+	{
+		resourceRecord(mineral);		// make room for it now, so references into resourceRecords stay valid
+		patches.push_back(mineral);
+		tripFrames.push_back(int(2.0 * mineral->getDistance(depot) / speed) + MiningFrames + TurnaroundFrames);
+	}
+
+	ResourceRecord & depotRec = resourceRecord(depot);
+	depotRec.patchesKnown = true;
+	depotRec.patches = patches;
+	depotRec.patchTripFrames = tripFrames;
+	depotRec.mineralsNear = getMineralsNearDepot(depot);
+	depotRec.needsRebalance = true;
+}
+
+// Expected mining trips per frame from a patch with the given number of workers.
+// Each worker delivers once per round trip, until the patch is busy all the time.
+// The income is concave in the number of workers, so handing out workers one at a time
+// to the patch with the largest gain gives the best total, and one move at a time
+// from the smallest loss to the largest gain restores the best total after a change.
+double WorkerData::patchIncome(int tripFrames, int workers)
+{
+	return std::min(double(workers) / tripFrames, 1.0 / MiningFrames);
+}
+
+// The patch that gains the most from one more worker, or -1 if there are no patches.
+// Ties go to the patch with fewer workers, then to the closer one.
+int WorkerData::bestPatchToAdd(const ResourceRecord & depotRec) const
+{
+	int best = -1;
+	double bestGain = -1.0;
+	int bestCount = 0;
+
+	for (size_t i = 0; i < depotRec.patches.size(); ++i)
+	{
+		const int n = getNumWorkersOnPatch(depotRec.patches[i]);
+		const int trip = depotRec.patchTripFrames[i];
+		const double gain = patchIncome(trip, n + 1) - patchIncome(trip, n);
+
+		if (best < 0 ||
+			gain > bestGain ||
+			gain == bestGain && (n < bestCount || n == bestCount && trip < depotRec.patchTripFrames[best]))
 		{
-				int dist = mineral->getDistance(depot);
-                int numAssigned = workersOnMineralPatch[mineral];
-
-                if (numAssigned < bestNumAssigned ||
-					numAssigned == bestNumAssigned && dist < bestDist)
-                {
-                    bestMineral = mineral;
-                    bestDist = dist;
-                    bestNumAssigned = numAssigned;
-                }
+			best = int(i);
+			bestGain = gain;
+			bestCount = n;
 		}
 	}
 
-	return bestMineral;
+	return best;
 }
 
-BWAPI::Unit WorkerData::getWorkerRepairUnit(BWAPI::Unit unit)
+// The patch with workers that loses the least by losing one, or -1 if none has workers.
+// Ties go to the patch with more workers, then to the farther one.
+int WorkerData::bestPatchToRemove(const ResourceRecord & depotRec) const
 {
-	if (!unit) { return nullptr; }
+	int best = -1;
+	double bestLoss = 0.0;
+	int bestCount = 0;
+
+	for (size_t i = 0; i < depotRec.patches.size(); ++i)
+	{
+		const int n = getNumWorkersOnPatch(depotRec.patches[i]);
+		if (n == 0)
+		{
+			continue;
+		}
+		const int trip = depotRec.patchTripFrames[i];
+		const double loss = patchIncome(trip, n) - patchIncome(trip, n - 1);
+
+		if (best < 0 ||
+			loss < bestLoss ||
+			loss == bestLoss && (n > bestCount || n == bestCount && trip > depotRec.patchTripFrames[best]))
+		{
+			best = int(i);
+			bestLoss = loss;
+			bestCount = n;
+		}
+	}
+
+	return best;
+}
 
-	std::map<BWAPI::Unit, BWAPI::Unit>::iterator it = workerRepairMap.find(unit);
+// A worker on the patch that can be moved without losing a load, or null if none.
+BWAPI::Unit WorkerData::workerToMove(BWAPI::Unit mineral) const
+{
+	const ResourceRecord * res = findResourceRecord(mineral);
+	if (!res) { return nullptr; }
 
-	if (it != workerRepairMap.end())
+	for (int id = res->atMineral.first; id >= 0; id = workerRecords[id].nextAtMineral)
 	{
-		return it->second;
-	}	
+		const BWAPI::Unit worker = workerRecords[id].unit;
+		if (!worker->isCarryingMinerals() &&
+			worker->getOrder() != BWAPI::Orders::MiningMinerals)
+		{
+			return worker;
+		}
+	}
 
 	return nullptr;
 }
 
-BWAPI::Unit WorkerData::getWorkerDepot(BWAPI::Unit unit)
+// Send a mineral worker to a different patch of the same depot.
+void WorkerData::moveToMineral(BWAPI::Unit worker, BWAPI::Unit mineral)
 {
-	if (!unit) { return nullptr; }
+	WorkerRecord & rec = record(worker);
+	unlinkFromMineral(rec);
+	linkToMineral(rec, mineral);
+	Micro::RightClick(worker, mineral);
+}
+
+// Improve the patch assignment at each depot where something changed.
+// Make at most one move per depot per frame, from the patch that loses least
+// to the patch that gains most, and only if the move increases the income.
+void WorkerData::rebalanceMinerals()
+{
+	for (const auto depot : depots)
+	{
+		initPatches(depot);
+		ResourceRecord & depotRec = resourceRecords[depot->getID()];
+		if (!depotRec.needsRebalance)
+		{
+			continue;
+		}
+
+		const int to = bestPatchToAdd(depotRec);
+		const int from = bestPatchToRemove(depotRec);
+		if (to < 0 || from < 0 || to == from)
+		{
+			depotRec.needsRebalance = false;
+			continue;
+		}
+
+		const BWAPI::Unit toMineral = depotRec.patches[to];
+		const BWAPI::Unit fromMineral = depotRec.patches[from];
+		const int nTo = getNumWorkersOnPatch(toMineral);
+		const int nFrom = getNumWorkersOnPatch(fromMineral);
+		const double gain = patchIncome(depotRec.patchTripFrames[to], nTo + 1) - patchIncome(depotRec.patchTripFrames[to], nTo);
+		const double loss = patchIncome(depotRec.patchTripFrames[from], nFrom) - patchIncome(depotRec.patchTripFrames[from], nFrom - 1);
+		if (gain <= loss + 1e-9)
+		{
+			depotRec.needsRebalance = false;
+			continue;
+		}
+
+		// If every worker there is busy with a load, try again next frame.
+		const BWAPI::Unit worker = workerToMove(fromMineral);
+		if (worker)
+		{
+			moveToMineral(worker, toMineral);
+		}
+	}
+}
 
-	std::map<BWAPI::Unit, BWAPI::Unit>::iterator it = workerDepotMap.find(unit);
+// A mineral patch was mined out. Forget it, and move its workers to other patches.
+void WorkerData::mineralDestroyed(BWAPI::Unit mineral)
+{
+	if (!mineral) { return; }
 
-	if (it != workerDepotMap.end())
+	for (const auto depot : depots)
 	{
-		return it->second;
-	}	
+		ResourceRecord & depotRec = resourceRecord(depot);
+		for (size_t i = 0; i < depotRec.patches.size(); ++i)
+		{
+			if (depotRec.patches[i] == mineral)
+			{
+				depotRec.patches.erase(depotRec.patches.begin() + i);
+				depotRec.patchTripFrames.erase(depotRec.patchTripFrames.begin() + i);
+				depotRec.mineralsNear = getMineralsNearDepot(depot);
+				depotRec.needsRebalance = true;
+				break;
+			}
+		}
+	}
 
-	return nullptr;
+	std::vector<BWAPI::Unit> patchWorkers;
+	getWorkersAt(mineral, patchWorkers);
+	for (const auto worker : patchWorkers)
+	{
+		WorkerRecord & rec = record(worker);
+		unlinkFromMineral(rec);
+		BWAPI::Unit newMineral = getMineralToMine(worker);
+		linkToMineral(rec, newMineral);
+		if (newMineral)
+		{
+			Micro::RightClick(worker, newMineral);
+		}
+	}
 }
 
-BWAPI::UnitType	WorkerData::getWorkerBuildingType(BWAPI::Unit unit)
+// The mineral worker at the depot whose loss costs the least income, or null if none.
+// Prefer one that is not carrying a load.
+BWAPI::Unit WorkerData::getLeastProductiveWorker(BWAPI::Unit depot)
 {
-	if (!unit) { return BWAPI::UnitTypes::None; }
+	if (!depot) { return nullptr; }
 
-	std::map<BWAPI::Unit, BWAPI::UnitType>::iterator it = workerBuildingTypeMap.find(unit);
+	initPatches(depot);
+	const ResourceRecord & depotRec = resourceRecords[depot->getID()];
 
-	if (it != workerBuildingTypeMap.end())
+	const int i = bestPatchToRemove(depotRec);
+	if (i < 0)
 	{
-		return it->second;
-	}	
+		// No worker is on one of the depot's patches. Take any worker at the depot.
+		return depotRec.atJobUnit.first < 0 ? nullptr : workerRecords[depotRec.atJobUnit.first].unit;
+	}
 
-	return BWAPI::UnitTypes::None;
+	BWAPI::Unit worker = workerToMove(depotRec.patches[i]);
+	if (!worker)
+	{
+		worker = workerRecords[resourceRecords[depotRec.patches[i]->getID()].atMineral.first].unit;
+	}
+	return worker;
+}
+
+BWAPI::Unit WorkerData::getWorkerRepairUnit(BWAPI::Unit unit)
+{
+	const WorkerRecord * rec = findRecord(unit);
+
+	return rec && rec->job == Repair ? rec->jobUnit : nullptr;
+}
+
+BWAPI::Unit WorkerData::getWorkerDepot(BWAPI::Unit unit)
+{
+	const WorkerRecord * rec = findRecord(unit);
+
+	return rec && rec->job == Minerals ? rec->jobUnit : nullptr;
+}
+
+BWAPI::UnitType	WorkerData::getWorkerBuildingType(BWAPI::Unit unit)
+{
+	const WorkerRecord * rec = findRecord(unit);
+
+	return rec ? rec->buildingType : BWAPI::UnitTypes::None;
 }
 
 WorkerMoveData WorkerData::getWorkerMoveData(BWAPI::Unit unit)
 {
-	std::map<BWAPI::Unit, WorkerMoveData>::iterator it = workerMoveMap.find(unit);
+	const WorkerRecord * rec = findRecord(unit);
 
-	assert(it != workerMoveMap.end());
+	assert(rec && rec->job == Move);
 	
-	return (it->second);
+	return rec->moveData;
 }
 
+// Mineral workers assigned to a depot, or gas workers assigned to a refinery.
 int WorkerData::getNumAssignedWorkers(BWAPI::Unit unit)
 {
 	if (!unit) { return 0; }
 
-	std::map<BWAPI::Unit, int>::iterator it;
-	
-	// if the worker is mining, set the iterator to the mineral map
-	if (unit->getType().isResourceDepot())
+	if (unit->getType().isResourceDepot() || unit->getType().isRefinery())
 	{
-		it = depotWorkerCount.find(unit);
-
-		// if there is an entry, return it
-		if (it != depotWorkerCount.end())
-		{
-			return it->second;
-		}
-	}
-	else if (unit->getType().isRefinery())
-	{
-		it = refineryWorkerCount.find(unit);
-
-		// if there is an entry, return it
-		if (it != refineryWorkerCount.end())
-		{
-			return it->second;
-		}
-		// otherwise, we are only calling this on completed refineries, so set it
-		else
-		{
-			refineryWorkerCount[unit] = 0;
-		}
+		const ResourceRecord * res = findResourceRecord(unit);
+		return res ? res->atJobUnit.count : 0;
 	}
 
-	// when all else fails, return 0
 	return 0;
 }
 
+int WorkerData::getNumWorkersOnPatch(BWAPI::Unit mineral) const
+{
+	const ResourceRecord * res = findResourceRecord(mineral);
+
+	return res ? res->atMineral.count : 0;
+}
+
+// Append the workers assigned to the resource: Mineral workers for a depot,
+// gas workers for a refinery, or the workers mining a mineral patch.
+void WorkerData::getWorkersAt(BWAPI::Unit resource, std::vector<BWAPI::Unit> & units) const
+{
+	const ResourceRecord * res = findResourceRecord(resource);
+	if (!res) { return; }
+
+	const bool isMineral = resource->getType().isMineralField();
+	for (int id = isMineral ? res->atMineral.first : res->atJobUnit.first; id >= 0; )
+	{
+		const WorkerRecord & rec = workerRecords[id];
+		units.push_back(rec.unit);
+		id = isMineral ? rec.nextAtMineral : rec.nextAtJobUnit;
+	}
+}
+
 char WorkerData::getJobCode(BWAPI::Unit unit)
 {
 	if (!unit) { return 'X'; }
@@ -531,9 +793,12 @@ char WorkerData::getJobCode(BWAPI::Unit unit)
 // Add all gas workers to the given set.
 void WorkerData::getGasWorkers(std::set<BWAPI::Unit> & mw)
 {
-	for (auto kv : workerRefineryMap)
+	for (const auto worker : workers)
 	{
-		mw.insert(kv.first);
+		if (getWorkerJob(worker) == Gas)
+		{
+			mw.insert(worker);
+		}
 	}
 }
 
@@ -554,11 +819,8 @@ void WorkerData::drawDepotDebugInfo()
             int x = mineral->getPosition().x;
 		    int y = mineral->getPosition().y;
 
-            if (workersOnMineralPatch.find(mineral) != workersOnMineralPatch.end())
-            {
-                 //if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawBoxMap(x-2, y-1, x+75, y+14, BWAPI::Colors::Black, true);
-                 //if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawTextMap(x, y, "\x04 Workers: %d", workersOnMineralPatch[mineral]);
-            }
+            //if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawBoxMap(x-2, y-1, x+75, y+14, BWAPI::Colors::Black, true);
+            //if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawTextMap(x, y, "\x04 Workers: %d", getNumWorkersOnPatch(mineral));
         }
 	}
 }
\ No newline at end of file
@@ -31,21 +31,76 @@ public:
 
 private:
 
-	BWAPI::Unitset workers;
-	BWAPI::Unitset depots;
+	// Everything we know about one worker. Indexed by unit ID.
+	struct WorkerRecord
+	{
+		BWAPI::Unit			unit;
+		bool				counted;					// in workers, and included in jobCounts
+		enum WorkerJob		job;
+		BWAPI::Unit			jobUnit;					// depot for minerals, refinery for gas, unit to repair
+		BWAPI::Unit			mineral;					// mineral patch for minerals
+		BWAPI::UnitType		buildingType;				// building type for build
+		WorkerMoveData		moveData;					// location for move
+		int					nextAtJobUnit, prevAtJobUnit;	// list of workers at the same depot or refinery
+		int					nextAtMineral, prevAtMineral;	// list of workers on the same mineral patch
+
+		WorkerRecord();
+	};
+
+	// A list of workers, threaded through their WorkerRecords.
+	struct WorkerList
+	{
+		int					count;
+		int					first;						// unit ID of the first worker, or -1
+
+		WorkerList() : count(0), first(-1) {};
+	};
 
-	std::map<BWAPI::Unit, enum WorkerJob>	workerJobMap;           // worker -> job
-	std::map<BWAPI::Unit, BWAPI::Unit>		workerDepotMap;         // worker -> resource depot (hatchery)
-	std::map<BWAPI::Unit, BWAPI::Unit>		workerRefineryMap;      // worker -> refinery
-	std::map<BWAPI::Unit, BWAPI::Unit>		workerRepairMap;        // worker -> unit to repair
-	std::map<BWAPI::Unit, WorkerMoveData>	workerMoveMap;          // worker -> location
-	std::map<BWAPI::Unit, BWAPI::UnitType>	workerBuildingTypeMap;  // worker -> building type
+	// What we know about one depot, refinery, or mineral patch. Indexed by unit ID.
+	// Mineral workers are listed both at their depot and at their patch. They are
+	// separate lists, because a worker fleeing to a mineral patch uses it as its depot.
+	struct ResourceRecord
+	{
+		WorkerList			atJobUnit;					// workers with this as their depot or refinery
+		WorkerList			atMineral;					// workers mining this patch
 
-	std::map<BWAPI::Unit, int>				depotWorkerCount;       // mineral workers per depot
-	std::map<BWAPI::Unit, int>				refineryWorkerCount;    // gas workers per refinery
+		// For a depot: The mineral patches it mines, and the round trip time to each.
+		bool						patchesKnown;
+		std::vector<BWAPI::Unit>	patches;
+		std::vector<int>			patchTripFrames;
+		int							mineralsNear;		// patches that count toward the depot being full
+		bool						needsRebalance;		// the patch assignment may be improvable
 
-    std::map<BWAPI::Unit, int>				workersOnMineralPatch;  // workers per mineral patch
-    std::map<BWAPI::Unit, BWAPI::Unit>		workerMineralAssignment;// worker -> mineral patch
+		ResourceRecord() : patchesKnown(false), mineralsNear(0), needsRebalance(false) {};
+	};
+
+	BWAPI::Unitset workers;
+	BWAPI::Unitset depots;
+
+	std::vector<WorkerRecord>	workerRecords;
+	std::vector<ResourceRecord>	resourceRecords;
+	int							jobCounts[Default + 1];		// counted workers per job
+
+	WorkerRecord &			record(BWAPI::Unit unit);
+	const WorkerRecord *	findRecord(BWAPI::Unit unit) const;
+	ResourceRecord &		resourceRecord(BWAPI::Unit unit);
+	const ResourceRecord *	findResourceRecord(BWAPI::Unit unit) const;
+
+	void addToWorkers(BWAPI::Unit unit);
+	void setJob(WorkerRecord & rec, WorkerJob job);
+	void link(WorkerRecord & rec, WorkerList & list, int WorkerRecord::* next, int WorkerRecord::* prev);
+	void unlink(WorkerRecord & rec, WorkerList & list, int WorkerRecord::* next, int WorkerRecord::* prev);
+	void linkToJobUnit(WorkerRecord & rec, BWAPI::Unit jobUnit);
+	void unlinkFromJobUnit(WorkerRecord & rec);
+	void linkToMineral(WorkerRecord & rec, BWAPI::Unit mineral);
+	void unlinkFromMineral(WorkerRecord & rec);
+
+	void					initPatches(BWAPI::Unit depot);
+	static double			patchIncome(int tripFrames, int workers);
+	int						bestPatchToAdd(const ResourceRecord & depotRec) const;
+	int						bestPatchToRemove(const ResourceRecord & depotRec) const;
+	BWAPI::Unit				workerToMove(BWAPI::Unit mineral) const;
+	void					moveToMineral(BWAPI::Unit worker, BWAPI::Unit mineral);
 
 	void clearPreviousJob(BWAPI::Unit unit);
 
@@ -63,6 +118,9 @@ public:
 	void					setWorkerJob(BWAPI::Unit unit, WorkerJob job, WorkerMoveData wmd);
 	void					setWorkerJob(BWAPI::Unit unit, WorkerJob job, BWAPI::UnitType jobUnitType);
 
+	void					mineralDestroyed(BWAPI::Unit mineral);
+	void					rebalanceMinerals();
+
 	int						getNumWorkers() const;
 	int						getNumMineralWorkers() const;
 	int						getNumGasWorkers() const;
@@ -77,9 +135,13 @@ public:
 	void					getRepairWorkers(std::set<BWAPI::Unit> & mw);
 	
 	bool					depotIsFull(BWAPI::Unit depot);
+	int						getDepotCapacity(BWAPI::Unit depot);
+	BWAPI::Unit				getLeastProductiveWorker(BWAPI::Unit depot);
 	int						getMineralsNearDepot(BWAPI::Unit depot);
 
 	int						getNumAssignedWorkers(BWAPI::Unit unit);
+	int						getNumWorkersOnPatch(BWAPI::Unit mineral) const;
+	void					getWorkersAt(BWAPI::Unit resource, std::vector<BWAPI::Unit> & units) const;
 	BWAPI::Unit				getMineralToMine(BWAPI::Unit worker);
 
 	enum WorkerJob			getWorkerJob(BWAPI::Unit unit);
@@ -90,10 +152,10 @@ public:
 	WorkerMoveData			getWorkerMoveData(BWAPI::Unit unit);
 
     BWAPI::Unitset          getMineralPatchesNearDepot(BWAPI::Unit depot);
-    void                    addToMineralPatch(BWAPI::Unit unit, int num);
 	void					drawDepotDebugInfo();
 
 	const BWAPI::Unitset & getWorkers() const { return workers; }
+	const BWAPI::Unitset & getDepots() const { return depots; }
 
 };
 }
\ No newline at end of file
@@ -23,7 +23,9 @@ void WorkerManager::update()
 {
 	// NOTE Combat workers are placed in a combat squad and get their orders there.
 	//      We ignore them here.
+	updateDepotDistances();
 	updateWorkerStatus();
+	workerData.rebalanceMinerals();
 	handleGasWorkers();
 	handleIdleWorkers();
 	handleReturnCargoWorkers();
@@ -508,11 +510,51 @@ void WorkerManager::setReturnCargoWorker(BWAPI::Unit unit)
 	}
 }
 
+// Can the depot accept cargo? A lair or hive is still a depot while it morphs.
+bool WorkerManager::isUsableDepot(BWAPI::Unit unit) const
+{
+	return
+		unit->exists() &&
+		unit->getType().isResourceDepot() &&
+		(unit->isCompleted() || unit->getType() == BWAPI::UnitTypes::Zerg_Lair || unit->getType() == BWAPI::UnitTypes::Zerg_Hive);
+}
+
+// Hand the current depots to the distance maps. They recompute only if the set changed,
+// which is rare for all depots and occasional for non-full depots.
+void WorkerManager::updateDepotDistances()
+{
+	std::vector<BWAPI::Unit> depots;
+	std::vector<BWAPI::Unit> nonFullDepots;
+
+	for (const auto unit : BWAPI::Broodwar->self()->getUnits())
+	{
+		if (isUsableDepot(unit))
+		{
+			depots.push_back(unit);
+			if (!workerData.depotIsFull(unit))
+			{
+				nonFullDepots.push_back(unit);
+			}
+		}
+	}
+
+	depotDistances.setSeeds(depots);
+	nonFullDepotDistances.setSeeds(nonFullDepots);
+}
+
 // Get the closest resource depot with no other consideration.
 BWAPI::Unit WorkerManager::getAnyClosestDepot(BWAPI::Unit worker)
 {
 	UAB_ASSERT(worker, "Worker was null");
 
+	// Usually the distance map knows. It may be out of date by a frame, so check.
+	BWAPI::Unit nearest = depotDistances.getNearest(worker->getPosition());
+	if (nearest && isUsableDepot(nearest))
+	{
+		return nearest;
+	}
+
+	// Otherwise the worker is somewhere the map doesn't reach. Check all depots.
 	BWAPI::Unit closestDepot = nullptr;
 	int closestDistance = 0;
 
@@ -520,8 +562,7 @@ BWAPI::Unit WorkerManager::getAnyClosestDepot(BWAPI::Unit worker)
 	{
 		UAB_ASSERT(unit, "Unit was null");
 
-		if (unit->getType().isResourceDepot() &&
-			(unit->isCompleted() || unit->getType() == BWAPI::UnitTypes::Zerg_Lair || unit->getType() == BWAPI::UnitTypes::Zerg_Hive))
+		if (isUsableDepot(unit))
 		{
 			int distance = unit->getDistance(worker);
 			if (!closestDepot || distance < closestDistance)
@@ -540,6 +581,13 @@ BWAPI::Unit WorkerManager::getClosestNonFullDepot(BWAPI::Unit worker)
 {
 	UAB_ASSERT(worker, "Worker was null");
 
+	// The depot may have filled up since the distance map was made, so check.
+	BWAPI::Unit nearest = nonFullDepotDistances.getNearest(worker->getPosition());
+	if (nearest && isUsableDepot(nearest) && !workerData.depotIsFull(nearest))
+	{
+		return nearest;
+	}
+
 	BWAPI::Unit closestDepot = nullptr;
 	int closestDistance = 0;
 
@@ -547,9 +595,7 @@ BWAPI::Unit WorkerManager::getClosestNonFullDepot(BWAPI::Unit worker)
 	{
         UAB_ASSERT(unit, "Unit was null");
 
-		if (unit->getType().isResourceDepot() &&
-			(unit->isCompleted() || unit->getType() == BWAPI::UnitTypes::Zerg_Lair || unit->getType() == BWAPI::UnitTypes::Zerg_Hive) &&
-			!workerData.depotIsFull(unit))
+		if (isUsableDepot(unit) && !workerData.depotIsFull(unit))
 		{
 			int distance = unit->getDistance(worker);
 			if (!closestDepot || distance < closestDistance)
@@ -802,25 +848,31 @@ void WorkerManager::onUnitShow(BWAPI::Unit unit)
 }
 
 // Possibly transfer workers to other bases.
+// Mineral workers with no depot, and the surplus at depots with too many, go idle.
+// Idle workers are reassigned to depots that have room.
+// The surplus is taken from the patches where it loses the least income.
 void WorkerManager::rebalanceWorkers()
 {
 	for (const auto worker : workerData.getWorkers())
 	{
         UAB_ASSERT(worker, "Worker was null");
 
-		if (!workerData.getWorkerJob(worker) == WorkerData::Minerals)
-		{
-			continue;
-		}
-
-		BWAPI::Unit depot = workerData.getWorkerDepot(worker);
-
-		if (depot && workerData.depotIsFull(depot))
+		if (workerData.getWorkerJob(worker) == WorkerData::Minerals && !workerData.getWorkerDepot(worker))
 		{
 			workerData.setWorkerJob(worker, WorkerData::Idle, nullptr);
 		}
-		else if (!depot)
+	}
+
+	for (const auto depot : workerData.getDepots())
+	{
+		int surplus = workerData.getNumAssignedWorkers(depot) - workerData.getDepotCapacity(depot);
+		for (; surplus > 0; --surplus)
 		{
+			BWAPI::Unit worker = workerData.getLeastProductiveWorker(depot);
+			if (!worker)
+			{
+				break;
+			}
 			workerData.setWorkerJob(worker, WorkerData::Idle, nullptr);
 		}
 	}
@@ -842,6 +894,7 @@ void WorkerManager::onUnitDestroy(BWAPI::Unit unit)
 
 	if (unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field)
 	{
+		workerData.mineralDestroyed(unit);
 		rebalanceWorkers();
 	}
 }
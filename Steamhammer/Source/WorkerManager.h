@@ -2,6 +2,7 @@
 
 #include <Common.h>
 #include "BuildingManager.h"
+#include "MultiSourceDistances.h"
 #include "WorkerData.h"
 
 namespace UAlbertaBot
@@ -14,6 +15,13 @@ class WorkerManager
     BWAPI::Unit previousClosestWorker;
 	bool		_collectGas;
 
+	// Ground distances to our nearest depot, and to our nearest depot that is not full.
+	MultiSourceDistances depotDistances;
+	MultiSourceDistances nonFullDepotDistances;
+
+	void		updateDepotDistances();
+	bool		isUsableDepot(BWAPI::Unit unit) const;
+
 	void        setMineralWorker(BWAPI::Unit unit);
 	void        setReturnCargoWorker(BWAPI::Unit unit);
 	bool		refineryHasDepot(BWAPI::Unit refinery);
@@ -0,0 +1,583 @@
+// Opponent model statistics.
+// Read the opponent model files that Steamhammer writes, om_<opponent>.bin or
+// om_<opponent>.txt in the old text format, and summarize what they say about
+// each opponent: How our openings did, how well we predicted the enemy's opening
+// plan, and when the enemy got each kind of unit.
+
+// Usage: OpponentModelStats [-j threads] [--csv prefix] [--json file] directory-or-file...
+//   -j threads      read files on this many threads (default: all cores)
+//   --csv prefix    write prefix_openings.csv, prefix_plans.csv, and prefix_timings.csv
+//   --json file     write everything as one JSON file
+// The summary goes to standard output.
+
+#include "GameRecord.h"
+#include "OpponentModelFile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace UAlbertaBot;
+
+// GameRecord and Common.cpp may report a failed assertion. Outside the game there
+// is no log directory, so say it on standard error. This replaces UABAssert.cpp.
+void UAlbertaBot::Assert::ReportFailure(const char * condition, const char * file, int line, const char * msg, ...)
+{
+	va_list args;
+	va_start(args, msg);
+	fprintf(stderr, "assertion failed: %s (%s:%d) ", condition, file, line);
+	vfprintf(stderr, msg, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+namespace
+{
+	// The frames when things happened, in the order of the game record.
+	struct Timing
+	{
+		const char * name;
+		int (GameRecord::*get)() const;
+	};
+
+	const Timing timings[] =
+	{
+		{ "enemy_scouts_our_base",		&GameRecord::getFrameEnemyScoutsOurBase },
+		{ "enemy_combat_units",			&GameRecord::getFrameEnemyGetsCombatUnits },
+		{ "enemy_air_units",			&GameRecord::getFrameEnemyGetsAirUnits },
+		{ "enemy_static_anti_air",		&GameRecord::getFrameEnemyGetsStaticAntiAir },
+		{ "enemy_mobile_anti_air",		&GameRecord::getFrameEnemyGetsMobileAntiAir },
+		{ "enemy_cloaked_units",		&GameRecord::getFrameEnemyGetsCloakedUnits },
+		{ "enemy_static_detection",		&GameRecord::getFrameEnemyGetsStaticDetection },
+		{ "enemy_mobile_detection",		&GameRecord::getFrameEnemyGetsMobileDetection },
+		{ "game_ends",					&GameRecord::getFrameGameEnds },
+	};
+	const size_t nTimings = sizeof(timings) / sizeof(timings[0]);
+
+	struct Tally
+	{
+		int games;
+		int wins;
+
+		Tally() : games(0), wins(0) {};
+	};
+
+	// A 0 frame means that it never happened. Those are counted, not included.
+	struct Distribution
+	{
+		int count;
+		int never;
+		int min;
+		int p25;
+		int median;
+		int p75;
+		int max;
+		double mean;
+	};
+
+	struct OpponentStats
+	{
+		std::string name;
+		std::string filename;
+		bool readable;
+
+		Tally games;
+		std::map<std::string, Tally> openings;
+
+		// Plan recognition: The expected plan is our prediction at the start of the
+		// game, the enemy plan is what the plan recognizer saw.
+		int predicted;				// games with an expected plan
+		int predictedCorrectly;
+		std::map< std::pair<OpeningPlan, OpeningPlan>, int > planPairs;	// (expected, actual) -> games
+
+		std::vector<int> frames[nTimings];
+		Distribution distributions[nTimings];
+
+		OpponentStats() : readable(false), predicted(0), predictedCorrectly(0) {};
+	};
+
+	struct Options
+	{
+		int threads;
+		std::string csvPrefix;
+		std::string jsonFilename;
+		std::vector<std::string> paths;
+
+		Options() : threads(0) {};
+	};
+}
+
+static bool endsWith(const std::string & s, const std::string & suffix)
+{
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// The opponent name from a file name "om_<name>.bin" or "om_<name>.txt"; empty if it is not one.
+static std::string opponentName(const std::string & filename)
+{
+	const size_t slash = filename.find_last_of('/');
+	const std::string base = slash == std::string::npos ? filename : filename.substr(slash + 1);
+
+	if (base.size() > 7 && base.compare(0, 3, "om_") == 0 && (endsWith(base, ".bin") || endsWith(base, ".txt")))
+	{
+		return base.substr(3, base.size() - 7);
+	}
+	return "";
+}
+
+static bool isDirectory(const std::string & path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// Find the opponent model files. For an opponent with both a binary and a text file,
+// the bot reads only the binary file (the text file is left over from before conversion),
+// so take only that one.
+static std::vector<OpponentStats> findFiles(const std::vector<std::string> & paths)
+{
+	std::map<std::string, std::string> files;		// opponent name -> file name
+
+	for (const std::string & path : paths)
+	{
+		std::vector<std::string> candidates;
+		if (isDirectory(path))
+		{
+			DIR * dir = opendir(path.c_str());
+			if (!dir)
+			{
+				fprintf(stderr, "can't read directory %s\n", path.c_str());
+				continue;
+			}
+			while (const dirent * entry = readdir(dir))
+			{
+				candidates.push_back(path + "/" + entry->d_name);
+			}
+			closedir(dir);
+		}
+		else
+		{
+			candidates.push_back(path);
+		}
+
+		for (const std::string & filename : candidates)
+		{
+			const std::string name = opponentName(filename);
+			if (name.empty())
+			{
+				continue;
+			}
+			auto it = files.find(name);
+			if (it == files.end() || endsWith(filename, ".bin"))
+			{
+				files[name] = filename;
+			}
+		}
+	}
+
+	std::vector<OpponentStats> opponents;
+	for (const auto & file : files)
+	{
+		opponents.push_back(OpponentStats());
+		opponents.back().name = file.first;
+		opponents.back().filename = file.second;
+	}
+	return opponents;
+}
+
+static void addRecord(OpponentStats & stats, const GameRecord & record)
+{
+	++stats.games.games;
+	Tally & opening = stats.openings[record.getOpeningName()];
+	++opening.games;
+	if (record.getWin())
+	{
+		++stats.games.wins;
+		++opening.wins;
+	}
+
+	if (record.getExpectedEnemyPlan() != OpeningPlan::Unknown)
+	{
+		++stats.predicted;
+		if (record.getExpectedEnemyPlan() == record.getEnemyPlan())
+		{
+			++stats.predictedCorrectly;
+		}
+	}
+	++stats.planPairs[std::make_pair(record.getExpectedEnemyPlan(), record.getEnemyPlan())];
+
+	for (size_t i = 0; i < nTimings; ++i)
+	{
+		stats.frames[i].push_back((record.*timings[i].get)());
+	}
+}
+
+// Read one opponent's file and tally it. Return the number of records read.
+// The records live only as long as this call. The arena belongs to the calling thread.
+static int readOpponent(OpponentStats & stats, Arena & arena)
+{
+	int nRecords = 0;
+
+	if (endsWith(stats.filename, ".bin"))
+	{
+		OpponentModelFile file;
+		if (!file.open(stats.filename))
+		{
+			return 0;
+		}
+		stats.readable = true;
+		for (int i = 0; i < file.getRecordCount(); ++i)
+		{
+			const GameRecord * record = file.readRecord(arena, i);
+			if (record->isValid())
+			{
+				addRecord(stats, *record);
+				++nRecords;
+			}
+		}
+	}
+	else
+	{
+		std::ifstream input(stats.filename);
+		if (!input)
+		{
+			return 0;
+		}
+		stats.readable = true;
+		while (input.good())
+		{
+			GameRecord * record = arena.make<GameRecord>(arena, input);
+			if (record->isValid())
+			{
+				addRecord(stats, *record);
+				++nRecords;
+			}
+		}
+	}
+
+	arena.release();
+	return nRecords;
+}
+
+// Nearest-rank percentiles of the frames that are not 0.
+static void summarize(OpponentStats & stats)
+{
+	for (size_t i = 0; i < nTimings; ++i)
+	{
+		std::vector<int> & frames = stats.frames[i];
+		Distribution & d = stats.distributions[i];
+
+		std::sort(frames.begin(), frames.end());
+		const auto first = std::upper_bound(frames.begin(), frames.end(), 0);
+		d.never = int(first - frames.begin());
+		frames.erase(frames.begin(), first);
+
+		d.count = int(frames.size());
+		if (frames.empty())
+		{
+			d.min = d.p25 = d.median = d.p75 = d.max = 0;
+			d.mean = 0.0;
+			continue;
+		}
+
+		const size_t last = frames.size() - 1;
+		d.min = frames.front();
+		d.p25 = frames[last / 4];
+		d.median = frames[last / 2];
+		d.p75 = frames[3 * last / 4];
+		d.max = frames.back();
+
+		double sum = 0.0;
+		for (const int frame : frames)
+		{
+			sum += frame;
+		}
+		d.mean = sum / frames.size();
+	}
+}
+
+static double percent(int part, int whole)
+{
+	return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+static void printSummary(const std::vector<OpponentStats> & opponents)
+{
+	for (const OpponentStats & stats : opponents)
+	{
+		if (!stats.readable)
+		{
+			printf("%s: unreadable file %s\n\n", stats.name.c_str(), stats.filename.c_str());
+			continue;
+		}
+
+		printf("%s: %d games, %.1f%% won", stats.name.c_str(), stats.games.games, percent(stats.games.wins, stats.games.games));
+		if (stats.predicted > 0)
+		{
+			printf(", plan predicted %d/%d (%.1f%%)", stats.predictedCorrectly, stats.predicted, percent(stats.predictedCorrectly, stats.predicted));
+		}
+		printf("\n");
+
+		for (const auto & opening : stats.openings)
+		{
+			printf("  %-28s %5d games %6.1f%% won\n",
+				opening.first.c_str(), opening.second.games, percent(opening.second.wins, opening.second.games));
+		}
+
+		for (size_t i = 0; i < nTimings; ++i)
+		{
+			const Distribution & d = stats.distributions[i];
+			if (d.count > 0)
+			{
+				printf("  %-28s %5d games, median %6d, 25%%-75%% %6d-%d\n",
+					timings[i].name, d.count, d.median, d.p25, d.p75);
+			}
+		}
+		printf("\n");
+	}
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Quote a CSV field if it needs it.
+static std::string csvField(const std::string & s)
+{
+	if (s.find_first_of(",\"\n") == std::string::npos)
+	{
+		return s;
+	}
+	std::string quoted = "\"";
+	for (const char c : s)
+	{
+		if (c == '"')
+		{
+			quoted += '"';
+		}
+		quoted += c;
+	}
+	return quoted + '"';
+}
+
+static bool writeCSV(const std::string & prefix, const std::vector<OpponentStats> & opponents)
+{
+	std::ofstream openings(prefix + "_openings.csv");
+	std::ofstream plans(prefix + "_plans.csv");
+	std::ofstream frames(prefix + "_timings.csv");
+
+	openings << "opponent,opening,games,wins\n";
+	plans << "opponent,expected_plan,actual_plan,games\n";
+	frames << "opponent,timing,games,never,min,p25,median,p75,max,mean\n";
+
+	for (const OpponentStats & stats : opponents)
+	{
+		const std::string name = csvField(stats.name);
+
+		for (const auto & opening : stats.openings)
+		{
+			openings << name << ',' << csvField(opening.first) << ',' << opening.second.games << ',' << opening.second.wins << '\n';
+		}
+
+		for (const auto & plan : stats.planPairs)
+		{
+			plans << name << ','
+				<< OpeningPlanString(plan.first.first) << ','
+				<< OpeningPlanString(plan.first.second) << ','
+				<< plan.second << '\n';
+		}
+
+		for (size_t i = 0; i < nTimings; ++i)
+		{
+			const Distribution & d = stats.distributions[i];
+			frames << name << ',' << timings[i].name << ',' << d.count << ',' << d.never << ','
+				<< d.min << ',' << d.p25 << ',' << d.median << ',' << d.p75 << ',' << d.max << ',' << d.mean << '\n';
+		}
+	}
+
+	return openings.good() && plans.good() && frames.good();
+}
+
+static std::string jsonString(const std::string & s)
+{
+	std::string quoted = "\"";
+	for (const unsigned char c : s)
+	{
+		if (c == '"' || c == '\\')
+		{
+			quoted += '\\';
+			quoted += char(c);
+		}
+		else if (c < 0x20)
+		{
+			char escape[8];
+			snprintf(escape, sizeof(escape), "\\u%04x", c);
+			quoted += escape;
+		}
+		else
+		{
+			quoted += char(c);
+		}
+	}
+	return quoted + '"';
+}
+
+static bool writeJSON(const std::string & filename, const std::vector<OpponentStats> & opponents)
+{
+	std::ofstream output(filename);
+
+	output << "{\n  \"opponents\": [";
+	bool firstOpponent = true;
+	for (const OpponentStats & stats : opponents)
+	{
+		output << (firstOpponent ? "\n" : ",\n");
+		firstOpponent = false;
+
+		output << "    {\n"
+			<< "      \"name\": " << jsonString(stats.name) << ",\n"
+			<< "      \"file\": " << jsonString(stats.filename) << ",\n"
+			<< "      \"readable\": " << (stats.readable ? "true" : "false") << ",\n"
+			<< "      \"games\": " << stats.games.games << ",\n"
+			<< "      \"wins\": " << stats.games.wins << ",\n"
+			<< "      \"plans_predicted\": " << stats.predicted << ",\n"
+			<< "      \"plans_predicted_correctly\": " << stats.predictedCorrectly << ",\n";
+
+		output << "      \"openings\": {";
+		bool first = true;
+		for (const auto & opening : stats.openings)
+		{
+			output << (first ? "\n" : ",\n") << "        " << jsonString(opening.first)
+				<< ": { \"games\": " << opening.second.games << ", \"wins\": " << opening.second.wins << " }";
+			first = false;
+		}
+		output << "\n      },\n";
+
+		output << "      \"plans\": [";
+		first = true;
+		for (const auto & plan : stats.planPairs)
+		{
+			output << (first ? "\n" : ",\n")
+				<< "        { \"expected\": " << jsonString(OpeningPlanString(plan.first.first))
+				<< ", \"actual\": " << jsonString(OpeningPlanString(plan.first.second))
+				<< ", \"games\": " << plan.second << " }";
+			first = false;
+		}
+		output << "\n      ],\n";
+
+		output << "      \"timings\": {";
+		for (size_t i = 0; i < nTimings; ++i)
+		{
+			const Distribution & d = stats.distributions[i];
+			output << (i == 0 ? "\n" : ",\n") << "        \"" << timings[i].name << "\": {"
+				<< " \"games\": " << d.count << ", \"never\": " << d.never
+				<< ", \"min\": " << d.min << ", \"p25\": " << d.p25 << ", \"median\": " << d.median
+				<< ", \"p75\": " << d.p75 << ", \"max\": " << d.max << ", \"mean\": " << d.mean << " }";
+		}
+		output << "\n      }\n    }";
+	}
+	output << "\n  ]\n}\n";
+
+	return output.good();
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+static void usage()
+{
+	fprintf(stderr, "usage: OpponentModelStats [-j threads] [--csv prefix] [--json file] directory-or-file...\n");
+}
+
+static bool parseArgs(int argc, char * argv[], Options & options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "-j" && i + 1 < argc)
+		{
+			options.threads = atoi(argv[++i]);
+		}
+		else if (arg == "--csv" && i + 1 < argc)
+		{
+			options.csvPrefix = argv[++i];
+		}
+		else if (arg == "--json" && i + 1 < argc)
+		{
+			options.jsonFilename = argv[++i];
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			return false;
+		}
+		else
+		{
+			options.paths.push_back(arg);
+		}
+	}
+	return !options.paths.empty();
+}
+
+int main(int argc, char * argv[])
+{
+	Options options;
+	if (!parseArgs(argc, argv, options))
+	{
+		usage();
+		return 2;
+	}
+
+	std::vector<OpponentStats> opponents = findFiles(options.paths);
+	if (opponents.empty())
+	{
+		fprintf(stderr, "no opponent model files found\n");
+		return 1;
+	}
+
+	int nThreads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+	nThreads = std::max(1, std::min(nThreads, int(opponents.size())));
+
+	// Each thread takes the next file that nobody has started on.
+	const auto start = std::chrono::steady_clock::now();
+	std::atomic<size_t> nextFile(0);
+	std::atomic<long> nRecords(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nThreads; ++t)
+	{
+		threads.push_back(std::thread([&]()
+		{
+			Arena arena;
+			for (size_t i = nextFile++; i < opponents.size(); i = nextFile++)
+			{
+				nRecords += readOpponent(opponents[i], arena);
+				summarize(opponents[i]);
+			}
+		}));
+	}
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	fprintf(stderr, "read %ld records from %d files in %.3f s on %d threads (%.0f records/s)\n",
+		long(nRecords), int(opponents.size()), seconds, nThreads, seconds > 0.0 ? nRecords / seconds : 0.0);
+
+	printSummary(opponents);
+
+	int status = 0;
+	if (!options.csvPrefix.empty() && !writeCSV(options.csvPrefix, opponents))
+	{
+		fprintf(stderr, "can't write CSV files %s_*.csv\n", options.csvPrefix.c_str());
+		status = 1;
+	}
+	if (!options.jsonFilename.empty() && !writeJSON(options.jsonFilename, opponents))
+	{
+		fprintf(stderr, "can't write %s\n", options.jsonFilename.c_str());
+		status = 1;
+	}
+	return status;
+}